@@ -1,16 +1,61 @@
 #ifndef DCF_CONFIG_H
 #define DCF_CONFIG_H
 #include "dcf_error.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum { DCF_TRANSPORT_GRPC, DCF_TRANSPORT_UDP, DCF_TRANSPORT_TCP, DCF_TRANSPORT_WEBSOCKET } DCFTransportType;
+
+// How socket transports drive their I/O: plain syscalls, an epoll loop or io_uring
+typedef enum { DCF_SOCKET_IO_DIRECT, DCF_SOCKET_IO_EPOLL, DCF_SOCKET_IO_URING } DCFSocketIo;
 
 typedef struct DCFConfig DCFConfig;
 
 DCFConfig* dcf_config_load(const char* path);
 DCFError dcf_config_get_mode(DCFConfig* config, DCFMode* mode_out);
 DCFError dcf_config_get_node_id(DCFConfig* config, char** id_out);
+// Borrowed node id for hot paths, NULL when unset. It is held under a lock that
+// dcf_config_update also takes to replace node_id, so keep it briefly and hand
+// it back with dcf_config_release_node_id.
+const char* dcf_config_acquire_node_id(DCFConfig* config);
+void dcf_config_release_node_id(DCFConfig* config);
+// Changes whenever dcf_config_update replaces node_id, so caches of it can tell they are stale
+uint32_t dcf_config_get_node_id_generation(DCFConfig* config);
 DCFError dcf_config_get_peers(DCFConfig* config, char*** peers_out, size_t* count_out);
 DCFError dcf_config_get_host(DCFConfig* config, char** host_out);
 int dcf_config_get_port(DCFConfig* config);
 int dcf_config_get_rtt_threshold(DCFConfig* config);
+int dcf_config_get_channels_per_peer(DCFConfig* config);
+int dcf_config_get_max_peer_channels(DCFConfig* config);
+int dcf_config_get_server_threads(DCFConfig* config);
+DCFTransportType dcf_config_get_transport(DCFConfig* config);
+int dcf_config_get_socket_rcvbuf(DCFConfig* config);
+int dcf_config_get_socket_sndbuf(DCFConfig* config);
+DCFSocketIo dcf_config_get_io_backend(DCFConfig* config);
+bool dcf_config_get_shared_memory(DCFConfig* config);
+int dcf_config_get_probe_interval_ms(DCFConfig* config);
+int dcf_config_get_probe_max_interval_ms(DCFConfig* config);
+int dcf_config_get_probe_timeout_ms(DCFConfig* config);
+int dcf_config_get_probe_concurrency(DCFConfig* config);
+// Peers probed per probe interval; 0 probes every peer each interval
+int dcf_config_get_probe_neighbors(DCFConfig* config);
+// Phi-accrual failure detection: suspicion level at which a peer leaves routing (0 disables),
+// the floor on heartbeat-gap deviation, and slack added to every expected gap
+double dcf_config_get_phi_threshold(DCFConfig* config);
+int dcf_config_get_phi_min_std_ms(DCFConfig* config);
+int dcf_config_get_phi_acceptable_pause_ms(DCFConfig* config);
+// Disjoint routes each client send goes out over at once; 1 sends a single copy
+int dcf_config_get_multipath_routes(DCFConfig* config);
+// SWIM gossip membership: protocol period (0 disables it and keeps the peer list
+// static), members asked to probe an unresponsive one, periods a suspicion
+// lasts before the member is declared dead, scaled by log10 of the cluster size,
+// and how long a dead member is kept before it is forgotten (0 keeps it)
+int dcf_config_get_gossip_interval_ms(DCFConfig* config);
+int dcf_config_get_gossip_indirect_probes(DCFConfig* config);
+int dcf_config_get_gossip_suspicion_mult(DCFConfig* config);
+int dcf_config_get_gossip_dead_timeout_ms(DCFConfig* config);
+// Most peers the peer table holds at once, configured and discovered together
+int dcf_config_get_max_peers(DCFConfig* config);
 DCFError dcf_config_get_plugin_path(DCFConfig* config, char** path_out);
 DCFError dcf_config_update(DCFConfig* config, const char* key, const char* value);
 void dcf_config_free(DCFConfig* config);
@@ -0,0 +1,13 @@
+#ifndef DCF_ADDRESS_H
+#define DCF_ADDRESS_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <netdb.h>
+
+// Splits "host:port" or "[v6]:port" into NUL-terminated host and port strings
+bool dcf_address_split(const char* address, char* host, size_t host_cap, char* port, size_t port_cap);
+// Resolves "host:port" for the given socket family/type; caller frees with freeaddrinfo
+bool dcf_address_resolve(const char* address, int family, int socktype, struct addrinfo** res_out);
+// True when host (a name or literal, without port) resolves to loopback or an address of a local interface
+bool dcf_address_is_local(const char* host);
+#endif
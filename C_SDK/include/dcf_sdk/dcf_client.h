@@ -10,11 +10,57 @@ typedef enum { CLIENT_MODE, SERVER_MODE, P2P_MODE, AUTO_MODE } DCFMode;
 
 typedef struct DCFClient DCFClient;
 
+typedef struct {
+    const char* data;
+    const char* recipient;
+    size_t len;   // payload bytes, for binary data; 0 sends data as a C string unless binary is set
+    bool binary;  // data is exactly len bytes, so a zero len sends an empty payload
+} DCFBatchEntry;
+
+// Called by dcf_client_poll for every received message; both strings are only
+// valid during the call, and receiving from inside a handler invalidates them
+// for the handlers after it.
+typedef void (*DCFMessageHandler)(void* user_data, const char* message, const char* sender);
+// Binary-safe handler; the payload has the same lifetime as a DCFMessageHandler's strings
+typedef void (*DCFPayloadHandler)(void* user_data, const uint8_t* payload, size_t payload_len, const char* sender);
+
 DCFClient* dcf_client_new(void);
 DCFError dcf_client_initialize(DCFClient* client, const char* config_path);
 DCFError dcf_client_start(DCFClient* client);
+// Routes sends and blocking receives through an in-process transport, such as a
+// test or benchmark loopback, in place of any plugin; call after initialize.
+// The client takes ownership of the transport.
+DCFError dcf_client_set_transport(DCFClient* client, ITransport* transport);
 DCFError dcf_client_stop(DCFClient* client);
 DCFError dcf_client_send_message(DCFClient* client, const char* data, const char* recipient, char** response_out);
+// Binary-safe send_message. The response is the data of the recipient's reply
+// to this message, empty on transports without replies (UDP, TCP, shared
+// memory). It is a borrowed view into the calling thread's deserialization
+// arena, valid until the thread receives again.
+DCFError dcf_client_send_payload(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, const uint8_t** response_out, size_t* response_len_out);
+// send_payload that fails once timeout_ms passes without the recipient's reply;
+// 0 waits as long as the transport does. Plugin transports are not bounded.
+DCFError dcf_client_send_payload_timeout(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, int timeout_ms, const uint8_t** response_out, size_t* response_len_out);
+// Sends every entry without waiting for responses. Entries are packed into one
+// buffer and grouped by route, and each group goes out in one transport
+// operation. results_out[i] holds entry i's outcome; the first failure is returned.
+DCFError dcf_client_send_batch(DCFClient* client, const DCFBatchEntry* entries, size_t count, DCFError* results_out);
 DCFError dcf_client_receive_message(DCFClient* client, char** message_out, char** sender_out);
+// Returns DCF_ERR_TIMEOUT instead of blocking when no message is waiting
+DCFError dcf_client_try_receive_message(DCFClient* client, char** message_out, char** sender_out);
+// Binary-safe receives returning borrowed views, valid until the calling thread receives again
+DCFError dcf_client_receive_payload(DCFClient* client, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out);
+DCFError dcf_client_try_receive_payload(DCFClient* client, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out);
+DCFError dcf_client_register_handler(DCFClient* client, DCFMessageHandler handler, void* user_data);
+DCFError dcf_client_unregister_handler(DCFClient* client, DCFMessageHandler handler, void* user_data);
+DCFError dcf_client_register_payload_handler(DCFClient* client, DCFPayloadHandler handler, void* user_data);
+DCFError dcf_client_unregister_payload_handler(DCFClient* client, DCFPayloadHandler handler, void* user_data);
+// Pollable fd for embedding in an external event loop: when it turns readable,
+// call dcf_client_poll(client, 0, ...) or drain with try_receive.
+int dcf_client_get_fd(DCFClient* client);
+// Dispatches waiting messages to every registered handler, first waiting up to
+// timeout_ms (-1 forever) when none are waiting. Messages are discarded when
+// no handler is registered.
+DCFError dcf_client_poll(DCFClient* client, int timeout_ms, size_t* dispatched_out);
 void dcf_client_free(DCFClient* client);
 #endif
@@ -0,0 +1,28 @@
+#ifndef DCF_COORDINATE_H
+#define DCF_COORDINATE_H
+#include "dcf_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define DCF_COORDINATE_DIMENSIONS 3
+// Bytes dcf_coordinate_encode writes: a 4-byte magic and five floats
+#define DCF_COORDINATE_WIRE_SIZE 24
+
+// Vivaldi network coordinate in microseconds: a Euclidean position plus a
+// height for the access link every path shares. The distance between two
+// coordinates estimates the RTT between their nodes.
+typedef struct {
+    float vec[DCF_COORDINATE_DIMENSIONS];
+    float height;
+    float error;  // confidence as a relative error; 1.5 for a fresh coordinate
+} DCFCoordinate;
+
+void dcf_coordinate_init(DCFCoordinate* coord);
+uint32_t dcf_coordinate_distance_us(const DCFCoordinate* a, const DCFCoordinate* b);
+// Moves local towards or away from remote by one measured RTT, weighted by
+// both error estimates. seed drives the direction when the two coincide.
+void dcf_coordinate_update(DCFCoordinate* local, const DCFCoordinate* remote, uint32_t rtt_us, unsigned int* seed);
+void dcf_coordinate_encode(const DCFCoordinate* coord, uint8_t out[DCF_COORDINATE_WIRE_SIZE]);
+// DCF_ERR_DESERIALIZATION_FAIL unless buf holds exactly an encoded, finite coordinate
+DCFError dcf_coordinate_decode(const uint8_t* buf, size_t len, DCFCoordinate* coord_out);
+#endif
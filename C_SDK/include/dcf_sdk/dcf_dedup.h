@@ -0,0 +1,23 @@
+#ifndef DCF_DEDUP_H
+#define DCF_DEDUP_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Sequence numbers remembered behind each sender's newest one
+#define DCF_DEDUP_WINDOW 1024
+// Senders tracked at once; past that the least recently heard nearby one is forgotten
+#define DCF_DEDUP_SENDERS 256
+
+typedef struct DCFDedup DCFDedup;
+
+// Duplicate filter for messages sent over several paths at once, keyed by
+// (sender, sequence). Each sender gets a sliding bitmap of the last
+// DCF_DEDUP_WINDOW sequence numbers, compared in serial-number order so the
+// 32-bit counter may wrap. A sequence number older than the window reads as
+// the sender having restarted and is let through.
+DCFDedup* dcf_dedup_new(void);
+// True the first time sender's sequence is seen, false for every later copy; thread-safe
+bool dcf_dedup_accept(DCFDedup* dedup, const uint8_t* sender, size_t sender_len, uint32_t sequence);
+void dcf_dedup_free(DCFDedup* dedup);
+#endif
@@ -16,7 +16,10 @@ typedef enum {
     DCF_ERR_GRPC_FAIL,
     DCF_ERR_INVALID_ARG,
     DCF_ERR_CONFIG_UPDATE_FAIL,
-    DCF_ERR_UNKNOWN
+    DCF_ERR_UNKNOWN,
+    // Added after UNKNOWN so existing values keep their numbers
+    DCF_ERR_TIMEOUT,
+    DCF_ERR_BUSY  // too much already in flight; nothing was done, so retrying later is safe
 } DCFError;
 
 const char* dcf_error_str(DCFError err);
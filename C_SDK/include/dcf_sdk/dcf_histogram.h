@@ -0,0 +1,25 @@
+#ifndef DCF_HISTOGRAM_H
+#define DCF_HISTOGRAM_H
+#include "dcf_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-linear latency histogram in the HdrHistogram layout: values up to
+// DCF_HISTOGRAM_MAX_VALUE are kept to three significant digits in fixed
+// memory, so recording is O(1) and never allocates. Larger values are clamped.
+#define DCF_HISTOGRAM_MAX_VALUE ((UINT64_C(1) << 36) - 1)
+
+typedef struct DCFHistogram DCFHistogram;
+
+DCFHistogram* dcf_histogram_new(void);
+void dcf_histogram_record(DCFHistogram* histogram, uint64_t value);
+DCFError dcf_histogram_merge(DCFHistogram* into, const DCFHistogram* from);
+void dcf_histogram_reset(DCFHistogram* histogram);
+uint64_t dcf_histogram_count(const DCFHistogram* histogram);
+uint64_t dcf_histogram_min(const DCFHistogram* histogram);
+uint64_t dcf_histogram_max(const DCFHistogram* histogram);
+double dcf_histogram_mean(const DCFHistogram* histogram);
+// Smallest recorded value, to histogram precision, at or below which percentile% of values lie; 0 when empty
+uint64_t dcf_histogram_percentile(const DCFHistogram* histogram, double percentile);
+void dcf_histogram_free(DCFHistogram* histogram);
+#endif
@@ -0,0 +1,37 @@
+#ifndef DCF_IO_BACKEND_H
+#define DCF_IO_BACKEND_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+typedef enum { DCF_IO_BACKEND_EPOLL, DCF_IO_BACKEND_IO_URING } DCFIoBackendType;
+
+typedef struct DCFIoBackend DCFIoBackend;
+
+// Creates the preferred backend, falling back to epoll when io_uring is not
+// compiled in (DCF_HAVE_IO_URING) or the running kernel refuses it.
+DCFIoBackend* dcf_io_backend_new(DCFIoBackendType preferred);
+DCFIoBackendType dcf_io_backend_get_type(DCFIoBackend* backend);
+// Pollable fd that turns readable when receive has something; the ring fd on io_uring
+int dcf_io_backend_get_fd(DCFIoBackend* backend);
+const char* dcf_io_backend_name(DCFIoBackendType type);
+// Starts receiving on fd: a multishot recv into registered buffers on io_uring, an epoll watch otherwise
+DCFError dcf_io_backend_watch(DCFIoBackend* backend, int fd);
+// Sends every message with a single submission (sendmmsg on the epoll backend)
+// and returns once all of them completed, as msgs stay the caller's: completions
+// are reaped per batch rather than lazily. results_out, which may be NULL, gets
+// each message's outcome and sent_out how many were sent. io_uring completes
+// messages independently, so any of them may fail; sendmmsg stops at the first
+// failure, so what it sent is a prefix and the rest fail unsent. Safe to call
+// from any thread, also while another thread waits in receive.
+DCFError dcf_io_backend_send_batch(DCFIoBackend* backend, int fd, struct msghdr* msgs, size_t count, DCFError* results_out, size_t* sent_out);
+// Waits up to timeout_ms (-1 blocks) for the next chunk read from a watched fd:
+// one datagram on UDP sockets, whatever arrived on stream sockets. The data is
+// owned by the backend and valid until the next call, so one thread receives.
+// A stream peer closing yields data NULL and length 0; an empty datagram yields
+// a non-NULL buffer and length 0.
+DCFError dcf_io_backend_receive(DCFIoBackend* backend, int timeout_ms, int* fd_out, const uint8_t** data_out, size_t* len_out);
+void dcf_io_backend_free(DCFIoBackend* backend);
+#endif
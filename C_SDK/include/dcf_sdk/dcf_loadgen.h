@@ -0,0 +1,34 @@
+#ifndef DCF_LOADGEN_H
+#define DCF_LOADGEN_H
+#include "dcf_client.h"
+#include "dcf_histogram.h"
+#include "dcf_error.h"
+
+typedef struct {
+    int concurrency;            // sender threads, default 1
+    size_t message_size;        // payload bytes, default 64
+    double rate;                // target messages/s across all threads; 0 sends back to back (closed loop)
+    double duration_s;          // default 10
+    int timeout_ms;             // per-send deadline, counted as an error when missed; default 1000
+    const char* const* peers;   // recipients, used round robin
+    size_t peer_count;
+} DCFLoadOptions;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t errors;
+    double elapsed_s;
+    double throughput;          // completed messages/s
+    DCFHistogram* latency_ns;   // completed sends; owned by the caller, free with dcf_histogram_free
+    DCFHistogram* error_latency_ns;  // failed and timed-out sends, until they failed; likewise owned
+} DCFLoadReport;
+
+// Drives dcf_client_send_payload from options->concurrency threads and records
+// each send's wall-clock latency on CLOCK_MONOTONIC. Every send is timed until
+// its own reply, so threads sharing the client never take each other's. With a target rate the
+// load is open loop: sends are scheduled at fixed intervals and latency is
+// measured from the scheduled time, so a stalled send also charges the ones
+// queued behind it instead of hiding them. Failed sends are timed too, into
+// their own histogram, so timeouts don't vanish from the report.
+DCFError dcf_loadgen_run(DCFClient* client, const DCFLoadOptions* options, DCFLoadReport* report_out);
+#endif
@@ -0,0 +1,64 @@
+#ifndef DCF_MEMBERSHIP_H
+#define DCF_MEMBERSHIP_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest member address the wire format carries
+#define DCF_MEMBER_ADDRESS_MAX 255
+
+typedef enum { DCF_MEMBER_ALIVE, DCF_MEMBER_SUSPECT, DCF_MEMBER_DEAD } DCFMemberState;
+
+// Callbacks run after the membership lock is released, so they may block or
+// call back into the membership. One caller runs them at a time, in the order
+// the events happened. The bytes passed to send are only valid during the call.
+typedef struct {
+    void (*send)(void* user_data, const char* address, const uint8_t* data, size_t len);
+    // A member was discovered or changed state
+    void (*changed)(void* user_data, const char* address, DCFMemberState state);
+    // A dead member was forgotten; optional
+    void (*removed)(void* user_data, const char* address);
+    void* user_data;
+} DCFMembershipCallbacks;
+
+typedef struct {
+    uint32_t period_ms;         // one direct probe per period
+    uint32_t ack_timeout_ms;    // after which the probe goes indirect
+    uint32_t indirect_probes;   // members asked to probe an unresponsive one
+    uint32_t suspicion_mult;    // suspicion lasts this many periods, scaled by log10 of the cluster size
+    uint32_t retransmit_mult;   // each update is piggybacked this many times log2 of the cluster size
+    uint32_t dead_timeout_ms;   // a dead member is forgotten this long after its death; 0 keeps it
+} DCFMembershipOptions;
+
+typedef struct DCFMembership DCFMembership;
+
+// SWIM membership (Das, Gupta and Motivala): each period a node pings one
+// member, chosen round-robin over a shuffled list, and asks indirect_probes
+// others to ping it when no ack comes back in time. A member nobody reaches
+// is suspected, and declared dead once its suspicion times out. State changes
+// spread by piggybacking on pings and acks, each ordered by the member's
+// incarnation number, which a member bumps to refute suspicion of itself.
+// Dead members are kept for dead_timeout_ms so that stale gossip can't revive
+// them, then forgotten; one that is still gossiped about as alive afterwards
+// is readded and declared dead again.
+// Every node sends a constant number of messages per period however large
+// the cluster grows. The state machine is driven by tick and handle with the
+// caller's clock, and does no I/O of its own.
+DCFMembership* dcf_membership_new(const char* self, const DCFMembershipOptions* options, const DCFMembershipCallbacks* callbacks);
+// Adds a member to contact, such as a seed from the config; joining spreads from there
+DCFError dcf_membership_join(DCFMembership* membership, const char* address);
+// True when data looks like a membership message rather than an application payload
+bool dcf_membership_is_message(const uint8_t* data, size_t len);
+// Folds in a received membership message, answering it if needed
+DCFError dcf_membership_handle(DCFMembership* membership, const uint8_t* data, size_t len, uint64_t now_us);
+// Starts probes, escalates them and expires suspicions that are due; returns
+// when it next needs to run
+uint64_t dcf_membership_tick(DCFMembership* membership, uint64_t now_us);
+// Members other than self, in any state
+size_t dcf_membership_count(DCFMembership* membership);
+// DCF_ERR_ROUTE_NOT_FOUND for an unknown address
+DCFError dcf_membership_get_state(DCFMembership* membership, const char* address, DCFMemberState* state_out, uint32_t* incarnation_out);
+uint32_t dcf_membership_incarnation(DCFMembership* membership);
+void dcf_membership_free(DCFMembership* membership);
+#endif
@@ -0,0 +1,48 @@
+#ifndef DCF_MESSAGE_VIEW_H
+#define DCF_MESSAGE_VIEW_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes borrowed from the buffer a view was parsed from; not NUL-terminated
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+} DCFSlice;
+
+// DCFMessage fields, as bits of the wanted/present masks (bit = field number)
+#define DCF_VIEW_SENDER (1u << 1)
+#define DCF_VIEW_RECIPIENT (1u << 2)
+#define DCF_VIEW_DATA (1u << 3)
+#define DCF_VIEW_TIMESTAMP (1u << 4)
+#define DCF_VIEW_SYNC (1u << 5)
+#define DCF_VIEW_SEQUENCE (1u << 6)
+#define DCF_VIEW_REDUNDANCY_PATH (1u << 7)
+#define DCF_VIEW_GROUP_ID (1u << 8)
+// What forwarding decisions need
+#define DCF_VIEW_HEADER (DCF_VIEW_RECIPIENT | DCF_VIEW_SEQUENCE | DCF_VIEW_GROUP_ID)
+#define DCF_VIEW_ALL 0x1feu
+
+// A packed DCFMessage decoded in place: slices point into the parsed buffer,
+// which must outlive the view. Fields that are absent or not wanted are empty
+// slices and zero scalars.
+typedef struct {
+    DCFSlice sender;
+    DCFSlice recipient;
+    DCFSlice data;
+    int64_t timestamp;
+    bool sync;
+    uint32_t sequence;
+    DCFSlice redundancy_path;
+    DCFSlice group_id;
+    uint32_t present;  // DCF_VIEW_* bits of the wanted fields found on the wire
+} DCFMessageView;
+
+// Walks the protobuf wire format once without allocating, decoding only the
+// fields in wanted and skipping the rest. Accepts and rejects the same input
+// as dcf_message__unpack; repeated fields resolve to the last occurrence.
+DCFError dcf_message_view_parse(const uint8_t* buf, size_t len, uint32_t wanted, DCFMessageView* view_out);
+// True when the slice holds exactly the C string s
+bool dcf_slice_equals(DCFSlice slice, const char* s);
+#endif
@@ -5,11 +5,50 @@
 
 typedef struct DCFNetworking DCFNetworking;
 
+// Completion callback for dcf_networking_send_async; runs on the transport's
+// completion thread and the response buffer is only valid during the call.
+// On gRPC the response is the peer's packed DCFMessage reply; socket and
+// shared-memory sends have none.
+typedef void (*DCFSendCallback)(void* user_data, DCFError err, const uint8_t* response, size_t response_len);
+
+// Handed the data field of every received message in a reserved group (see
+// DCF_GROUP_RESERVED_PREFIX) other than health probes. Those messages never
+// reach the application, whether the handler returns true or not.
+typedef bool (*DCFControlHandler)(void* user_data, const uint8_t* data, size_t len);
+
 DCFNetworking* dcf_networking_new(void);
 DCFError dcf_networking_initialize(DCFNetworking* networking, DCFConfig* config);
 DCFError dcf_networking_start(DCFNetworking* networking, DCFMode mode);
 DCFError dcf_networking_stop(DCFNetworking* networking);
+DCFError dcf_networking_warm_up(DCFNetworking* networking, const char* const* peers, size_t count);
+// Installs the handler for protocol traffic such as gossip; set it before receiving
+DCFError dcf_networking_set_control_handler(DCFNetworking* networking, DCFControlHandler handler, void* user_data);
+// Payload this node's acks to health probes carry back to senders; only gRPC acknowledges
+DCFError dcf_networking_set_ack_data(DCFNetworking* networking, const uint8_t* data, size_t len);
 DCFError dcf_networking_send(DCFNetworking* networking, const uint8_t* data, size_t len, const char* recipient);
+// Sends and waits for the recipient's reply to this message, at most timeout_ms
+// when positive. On gRPC *response_out is the peer's packed DCFMessage reply,
+// which the caller frees; socket and shared-memory sends have none and set it to NULL.
+DCFError dcf_networking_request(DCFNetworking* networking, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, uint8_t** response_out, size_t* response_len_out);
+// Sends count packed messages to one recipient with as few transport operations
+// as possible: sendmmsg on UDP, writev on TCP, pipelined calls on gRPC.
+// results_out[i] holds message i's outcome; the first failure is returned.
+DCFError dcf_networking_send_batch(DCFNetworking* networking, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, DCFError* results_out);
+// Never blocks on gRPC's in-flight limit: DCF_ERR_BUSY means nothing was sent
+// and cb will not run. On failure cb is not called.
+DCFError dcf_networking_send_async(DCFNetworking* networking, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, DCFSendCallback cb, void* user_data);
 DCFError dcf_networking_receive(DCFNetworking* networking, char** message_out, char** sender_out);
+// Non-blocking receive; DCF_ERR_TIMEOUT means every source is drained
+DCFError dcf_networking_try_receive(DCFNetworking* networking, char** message_out, char** sender_out);
+// try_receive without copies: the strings are borrowed from the calling thread's
+// deserialization arena and stay valid until it deserializes again
+DCFError dcf_networking_try_receive_view(DCFNetworking* networking, const char** message_out, const char** sender_out);
+// Binary-safe receives: the payload is a borrowed byte view with the same
+// lifetime as try_receive_view's strings
+DCFError dcf_networking_receive_payload(DCFNetworking* networking, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out);
+DCFError dcf_networking_try_receive_payload(DCFNetworking* networking, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out);
+// Level-triggered fd that turns readable when try_receive may succeed. It only
+// rearms after try_receive has returned DCF_ERR_TIMEOUT, so drain before polling.
+int dcf_networking_get_fd(DCFNetworking* networking);
 void dcf_networking_free(DCFNetworking* networking);
 #endif
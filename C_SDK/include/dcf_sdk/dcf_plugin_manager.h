@@ -15,5 +15,8 @@ typedef struct DCFPluginManager DCFPluginManager;
 DCFPluginManager* dcf_plugin_manager_new(void);
 DCFError dcf_plugin_manager_load(DCFPluginManager* manager, DCFConfig* config);
 ITransport* dcf_plugin_manager_get_transport(DCFPluginManager* manager);
+// Installs an in-process transport instead of a loaded plugin; the manager
+// takes ownership and destroys it (and any previous transport) when replaced or freed
+DCFError dcf_plugin_manager_set_transport(DCFPluginManager* manager, ITransport* transport);
 void dcf_plugin_manager_free(DCFPluginManager* manager);
 #endif
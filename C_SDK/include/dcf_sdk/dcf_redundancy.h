@@ -3,16 +3,93 @@
 #include "dcf_config.h"
 #include "dcf_networking.h"
 #include "dcf_error.h"
+#include "dcf_coordinate.h"
+#include <stdint.h>
 
 typedef struct DCFRedundancy DCFRedundancy;
 
+// Dense handle for a peer, configured or discovered, 0..dcf_redundancy_peer_count() - 1.
+// Ids of removed peers are reused for peers added later. The _id variants take
+// one instead of an address and skip the peer table lookup.
+typedef uint32_t DCFPeerId;
+#define DCF_PEER_NONE UINT32_MAX
+
+// srtt_us values for a peer with no measurement yet and for one that failed
+#define DCF_RTT_UNKNOWN (UINT32_MAX - 1)
+#define DCF_RTT_UNREACHABLE UINT32_MAX
+
+// Link statistics from health checks, timed on CLOCK_MONOTONIC
+typedef struct {
+    uint32_t srtt_us;       // smoothed RTT (RFC 6298), which routing and grouping use
+    uint32_t rttvar_us;     // smoothed mean deviation, i.e. jitter
+    uint32_t min_rtt_us;    // DCF_RTT_UNKNOWN until measured
+    float loss_rate;        // moving average of failed probes, 0..1
+    uint32_t probes;
+    uint32_t probe_interval_ms; // current background probe interval, which grows while the link is stable
+    const char* group;      // "local", "remote", "unreachable" or NULL; borrowed
+    uint32_t estimated_rtt_us;  // from network coordinates; DCF_RTT_UNKNOWN until the peer has sent one
+    double phi;             // current failure suspicion; 0 until enough heartbeats arrived or if probes get no reply
+    bool suspected;         // phi crossed phi_threshold and the peer is out of routing
+} DCFPeerStats;
+
 DCFRedundancy* dcf_redundancy_new(void);
 DCFError dcf_redundancy_initialize(DCFRedundancy* redundancy, DCFConfig* config, DCFNetworking* networking);
+// Also starts the background prober, which keeps up to probe_concurrency probes
+// in flight, each with a probe_timeout_ms deadline, and probes stable peers less often.
+// With gossip_interval_ms set it starts SWIM gossip membership too: the configured
+// peers are seeds, members it discovers join the peer table, and members it declares
+// dead are no longer probed. node_id must then be the address peers reach us at.
 DCFError dcf_redundancy_start(DCFRedundancy* redundancy, DCFMode mode);
 DCFError dcf_redundancy_stop(DCFRedundancy* redundancy);
+// First hop on the lowest-RTT path to recipient, which may be recipient itself;
+// recipients absent from the routing graph are addressed directly. A hop whose
+// phi has crossed phi_threshold is taken out of routing here and skipped.
 DCFError dcf_redundancy_get_optimal_route(DCFRedundancy* redundancy, const char* recipient, char** route_out);
+DCFError dcf_redundancy_get_optimal_route_id(DCFRedundancy* redundancy, DCFPeerId recipient, DCFPeerId* hop_out);
+// Up to k routes to recipient that share no node between this node and recipient,
+// best first, for sending one message over all of them at once. Each is a malloc'd
+// "hop,...,recipient" path whose first hop is where the copy goes. Suspected hops
+// are left out; a recipient absent from the routing graph gets the one direct route.
+DCFError dcf_redundancy_get_disjoint_routes(DCFRedundancy* redundancy, const char* recipient, size_t k, char** routes_out, size_t* count_out);
+// Folds a neighbor's measured srtt_us to each of peers into the routing graph;
+// DCF_RTT_UNKNOWN or DCF_RTT_UNREACHABLE drops that link
+DCFError dcf_redundancy_report_links(DCFRedundancy* redundancy, const char* neighbor, const char* const* peers, const uint32_t* srtt_us, size_t count);
+// Probes peer and folds the result into its statistics, waiting at most
+// probe_timeout_ms. rtt_out is this probe's RTT in ms, or -1 when the transport
+// delivered it without a reply to time (UDP, TCP, shared memory).
 DCFError dcf_redundancy_health_check(DCFRedundancy* redundancy, const char* peer, int* rtt_out);
+DCFError dcf_redundancy_health_check_id(DCFRedundancy* redundancy, DCFPeerId peer, int* rtt_out);
+DCFError dcf_redundancy_get_peer_stats(DCFRedundancy* redundancy, const char* peer, DCFPeerStats* stats_out);
+DCFError dcf_redundancy_get_peer_stats_id(DCFRedundancy* redundancy, DCFPeerId peer, DCFPeerStats* stats_out);
 DCFError dcf_redundancy_simulate_failure(DCFRedundancy* redundancy, const char* peer);
+DCFError dcf_redundancy_simulate_failure_id(DCFRedundancy* redundancy, DCFPeerId peer);
+// Evidence peer is alive from the data path, such as a message it sent or
+// acknowledged. Probe replies count on their own. Feeds the phi-accrual
+// detector, and brings a suspected peer back into routing.
+DCFError dcf_redundancy_heartbeat(DCFRedundancy* redundancy, const char* peer);
+DCFError dcf_redundancy_heartbeat_id(DCFRedundancy* redundancy, DCFPeerId peer);
+// Adds peer to the peer table, or finds it if present; DCF_ERR_INVALID_STATE once
+// the table holds max_peers, or holds every configured peer when gossip is off.
+DCFError dcf_redundancy_add_peer(DCFRedundancy* redundancy, const char* peer, DCFPeerId* id_out);
+// Takes a discovered peer out of the peer table and frees its id for reuse, once
+// any probe of it completes; DCF_ERR_INVALID_ARG for a configured peer
+DCFError dcf_redundancy_remove_peer(DCFRedundancy* redundancy, const char* peer);
+// DCF_ERR_ROUTE_NOT_FOUND when peer is not in the peer table
+DCFError dcf_redundancy_find_peer(DCFRedundancy* redundancy, const char* peer, DCFPeerId* id_out);
+// One past the highest id in use; ids of removed peers below it are vacant
+size_t dcf_redundancy_peer_count(DCFRedundancy* redundancy);
+// Borrowed address of peer, NULL when out of range or vacant. A removed peer's
+// address stays valid for 10 s.
+const char* dcf_redundancy_peer_address(DCFRedundancy* redundancy, DCFPeerId peer);
+// Estimated RTT between two peers from their network coordinates, in O(1) and
+// without probing; a NULL address (DCF_PEER_NONE for the _id variant) is this node.
+// DCF_ERR_ROUTE_NOT_FOUND until both have a coordinate.
+DCFError dcf_redundancy_estimate_rtt(DCFRedundancy* redundancy, const char* a, const char* b, uint32_t* rtt_us_out);
+DCFError dcf_redundancy_estimate_rtt_id(DCFRedundancy* redundancy, DCFPeerId a, DCFPeerId b, uint32_t* rtt_us_out);
+DCFError dcf_redundancy_get_coordinate(DCFRedundancy* redundancy, DCFCoordinate* coord_out);
+// Reprobes every peer: scheduled on the background prober when it runs, otherwise
+// one parallel sweep that returns once every probe completed or timed out. When
+// probe_neighbors limits probing, regroups on coordinate estimates instead.
 DCFError dcf_redundancy_group_peers(DCFRedundancy* redundancy);
 void dcf_redundancy_free(DCFRedundancy* redundancy);
 #endif
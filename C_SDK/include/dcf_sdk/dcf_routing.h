@@ -0,0 +1,45 @@
+#ifndef DCF_ROUTING_H
+#define DCF_ROUTING_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Weight that removes a link
+#define DCF_ROUTE_NO_LINK UINT32_MAX
+
+typedef struct DCFRoutingTable DCFRoutingTable;
+
+// Dense node handle; the table's own node is DCF_ROUTE_SELF
+typedef uint32_t DCFRouteNode;
+#define DCF_ROUTE_SELF 0
+#define DCF_ROUTE_NODE_NONE UINT32_MAX
+
+// Shortest-path routing from one node over directed links weighted by RTT in
+// microseconds. The shortest-path tree and each node's next hop are kept
+// current as links change, recomputing only the part of the tree a change
+// affects, so lookups are a hash probe under a shared lock.
+DCFRoutingTable* dcf_routing_new(const char* self);
+// Adds, reweights or (with DCF_ROUTE_NO_LINK) removes the link from -> to; unknown nodes are added
+DCFError dcf_routing_set_link(DCFRoutingTable* table, const char* from, const char* to, uint32_t weight_us);
+// Handle for node, added unreachable if new; DCF_ROUTE_NODE_NONE when out of memory.
+// Handles stay valid for the table's lifetime, so hot paths can skip the name lookup.
+DCFRouteNode dcf_routing_node(DCFRoutingTable* table, const char* node);
+DCFError dcf_routing_set_link_nodes(DCFRoutingTable* table, DCFRouteNode from, DCFRouteNode to, uint32_t weight_us);
+DCFError dcf_routing_next_hop_node(DCFRoutingTable* table, DCFRouteNode destination, DCFRouteNode* hop_out);
+// A caller-defined value per node, such as its index in the caller's own
+// tables, so a next hop maps back without a name lookup
+DCFError dcf_routing_set_tag(DCFRoutingTable* table, DCFRouteNode node, uint32_t tag);
+// Tag of destination's first hop, DCF_ROUTE_NODE_NONE when the hop has none
+DCFError dcf_routing_next_hop_tag(DCFRoutingTable* table, DCFRouteNode destination, uint32_t* tag_out);
+// First hop towards destination, which is destination itself when the direct link is shortest.
+// DCF_ERR_ROUTE_NOT_FOUND when the node is unknown or unreachable.
+DCFError dcf_routing_next_hop(DCFRoutingTable* table, const char* destination, char** hop_out);
+// Up to k routes to destination sharing no node besides the two ends, shortest
+// first, each written to routes_out as a malloc'd "hop,...,destination" path.
+// Found greedily, one search per route, so meant for the occasional redundant send.
+DCFError dcf_routing_disjoint_routes(DCFRoutingTable* table, const char* destination, size_t k, char** routes_out, size_t* count_out);
+DCFError dcf_routing_get_distance(DCFRoutingTable* table, const char* destination, uint64_t* distance_us_out);
+bool dcf_routing_has_node(DCFRoutingTable* table, const char* node);
+void dcf_routing_free(DCFRoutingTable* table);
+#endif
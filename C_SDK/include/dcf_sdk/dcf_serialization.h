@@ -1,8 +1,53 @@
 #ifndef DCF_SERIALIZATION_H
 #define DCF_SERIALIZATION_H
 #include "dcf_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// The *_message functions take the payload as a C string; the *_payload
+// variants take raw bytes, which may contain NULs.
 
 DCFError dcf_serialize_message(const char* data, const char* sender, const char* recipient, uint8_t** serialized_out, size_t* len_out);
+DCFError dcf_serialize_payload(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, uint8_t** serialized_out, size_t* len_out);
+// Packs into the caller's buffer straight from the given strings. *len_out is
+// always the packed size; DCF_ERR_INVALID_ARG means it exceeds cap.
+DCFError dcf_serialize_message_into(const char* data, const char* sender, const char* recipient, uint8_t* buf, size_t cap, size_t* len_out);
+DCFError dcf_serialize_payload_into(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, uint8_t* buf, size_t cap, size_t* len_out);
+// Packs into a buffer owned by the calling thread, valid until its next scratch
+// call; it only reallocates when a message outgrows it.
+DCFError dcf_serialize_message_scratch(const char* data, const char* sender, const char* recipient, const uint8_t** serialized_out, size_t* len_out);
+DCFError dcf_serialize_payload_scratch(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, const uint8_t** serialized_out, size_t* len_out);
+// Packs count messages back to back into one buffer; message i is lens_out[i]
+// bytes long and follows messages 0..i-1. The caller frees the buffer. Payload
+// i is data_lens[i] bytes, or a C string when data_lens is NULL.
+DCFError dcf_serialize_batch(const char* sender, const char* const* data, const size_t* data_lens, const char* const* recipients, size_t count, uint8_t** buffer_out, size_t* lens_out);
+// The per-destination fields of a message encoded once, so repeated sends to one
+// destination only encode payload, timestamp and sequence. sender and recipient
+// are required; redundancy_path and group_id may be NULL.
+typedef struct DCFEnvelope DCFEnvelope;
+DCFEnvelope* dcf_envelope_new(const char* sender, const char* recipient, const char* redundancy_path, const char* group_id);
+size_t dcf_envelope_packed_size(const DCFEnvelope* env, size_t payload_len, int64_t timestamp, uint32_t sequence);
+// Packs like dcf_serialize_payload_into, with the given timestamp and sequence
+DCFError dcf_envelope_pack(const DCFEnvelope* env, const uint8_t* payload, size_t payload_len, int64_t timestamp, uint32_t sequence, uint8_t* buf, size_t cap, size_t* len_out);
+// Packs into the calling thread's scratch buffer, like dcf_serialize_payload_scratch
+DCFError dcf_envelope_pack_scratch(const DCFEnvelope* env, const uint8_t* payload, size_t payload_len, int64_t timestamp, uint32_t sequence, const uint8_t** serialized_out, size_t* len_out);
+void dcf_envelope_free(DCFEnvelope* env);
+// Copies packed message data into the calling thread's scratch buffer with its
+// redundancy_path replaced by path, without decoding the rest. data may be the
+// scratch buffer itself, as filled by the last *_scratch call.
+DCFError dcf_serialize_rerouted_scratch(const uint8_t* data, size_t len, const uint8_t* path, size_t path_len, const uint8_t** serialized_out, size_t* len_out);
+// group_id values starting with "dcf:" are reserved for the SDK's own traffic,
+// which it acknowledges or consumes and never delivers to the application
+#define DCF_GROUP_RESERVED_PREFIX "dcf:"
+#define DCF_GROUP_HEALTH "dcf:health"
+// SWIM membership traffic, whose data is a dcf_membership message
+#define DCF_GROUP_GOSSIP "dcf:gossip"
+// A health probe: a DCFMessage to peer in group DCF_GROUP_HEALTH
 DCFError dcf_serialize_health_request(const char* peer, uint8_t** serialized_out, size_t* len_out);
 DCFError dcf_deserialize_message(const uint8_t* data, size_t len, char** message_out, char** sender_out);
+// Unpacks into the calling thread's arena without heap allocation once the arena
+// fits the traffic. The strings stay valid until the thread deserializes again.
+DCFError dcf_deserialize_message_view(const uint8_t* data, size_t len, const char** message_out, const char** sender_out);
+// Byte view of the payload, borrowed from the same arena as the string views
+DCFError dcf_deserialize_payload_view(const uint8_t* data, size_t len, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out);
 #endif
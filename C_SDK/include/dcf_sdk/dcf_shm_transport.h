@@ -0,0 +1,31 @@
+#ifndef DCF_SHM_TRANSPORT_H
+#define DCF_SHM_TRANSPORT_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Each listening node owns one inbound ring in the POSIX shared memory segment
+// "/dcf-shm-<port>"; local senders map it and enqueue without a syscall.
+#define DCF_SHM_SLOTS 1024
+#define DCF_SHM_SLOT_SIZE 8192
+#define DCF_SHM_MAX_MESSAGE (DCF_SHM_SLOT_SIZE - 16)
+
+typedef struct DCFShmTransport DCFShmTransport;
+
+DCFShmTransport* dcf_shm_transport_new(void);
+// Creates the inbound ring for port; a port <= 0 makes a send-only transport
+DCFError dcf_shm_transport_initialize(DCFShmTransport* shm, int port);
+// True when recipient ("host:port") is a local node with a ring this transport can reach
+bool dcf_shm_transport_reaches(DCFShmTransport* shm, const char* recipient);
+// Enqueues into the recipient's ring. DCF_ERR_ROUTE_NOT_FOUND means the peer has
+// no ring and the caller should use the network; DCF_ERR_TIMEOUT means it stayed full.
+DCFError dcf_shm_transport_send(DCFShmTransport* shm, const uint8_t* data, size_t len, const char* recipient);
+// Waits up to timeout_ms (0 polls, -1 blocks) for the next message. The data stays
+// in the ring slot, valid until the next receive call.
+DCFError dcf_shm_transport_receive(DCFShmTransport* shm, int timeout_ms, const uint8_t** data_out, size_t* len_out);
+// Socket that turns readable when a message arrives after a receive with
+// timeout_ms == 0 found the ring empty; -1 without an inbound ring
+int dcf_shm_transport_get_fd(DCFShmTransport* shm);
+void dcf_shm_transport_free(DCFShmTransport* shm);
+#endif
@@ -0,0 +1,37 @@
+#ifndef DCF_TCP_TRANSPORT_H
+#define DCF_TCP_TRANSPORT_H
+#include "dcf_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Frames are a 4-byte big-endian length followed by a packed DCFMessage
+#define DCF_TCP_FRAME_HEADER 4
+#define DCF_TCP_MAX_FRAME (16 * 1024 * 1024)
+// Frames coalesced into a single writev
+#define DCF_TCP_WRITE_BATCH 32
+// How long a send may take to connect and write when the caller gives no deadline
+#define DCF_TCP_SEND_TIMEOUT_MS 5000
+
+typedef struct DCFTcpTransport DCFTcpTransport;
+
+DCFTcpTransport* dcf_tcp_transport_new(void);
+// Listens on host:port; rcvbuf/sndbuf set SO_RCVBUF/SO_SNDBUF in bytes, 0 keeps the OS default
+DCFError dcf_tcp_transport_initialize(DCFTcpTransport* tcp, const char* host, int port, int rcvbuf, int sndbuf);
+// Sends may come from several threads; each one's frames are written contiguously,
+// and only senders to the same peer wait on each other
+DCFError dcf_tcp_transport_send(DCFTcpTransport* tcp, const uint8_t* data, size_t len, const char* recipient);
+// Like send, but gives up if connecting and writing take longer than timeout_ms
+// (<= 0 uses DCF_TCP_SEND_TIMEOUT_MS). A write cut short closes the connection.
+DCFError dcf_tcp_transport_send_timeout(DCFTcpTransport* tcp, const uint8_t* data, size_t len, const char* recipient, int timeout_ms);
+// Queues every frame for the recipient's connection and flushes them with as few writev calls as possible
+DCFError dcf_tcp_transport_send_batch(DCFTcpTransport* tcp, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient);
+// Returns the next complete frame from any connection. The frame points into the
+// connection's receive buffer and stays valid until the next receive call.
+DCFError dcf_tcp_transport_receive(DCFTcpTransport* tcp, const uint8_t** frame_out, size_t* len_out);
+// Like receive, but returns DCF_ERR_TIMEOUT instead of waiting when no frame is complete
+DCFError dcf_tcp_transport_try_receive(DCFTcpTransport* tcp, const uint8_t** frame_out, size_t* len_out);
+// The transport's epoll fd, readable when a connection or the listener has input
+int dcf_tcp_transport_get_fd(DCFTcpTransport* tcp);
+void dcf_tcp_transport_free(DCFTcpTransport* tcp);
+#endif
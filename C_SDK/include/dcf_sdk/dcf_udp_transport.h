@@ -0,0 +1,33 @@
+#ifndef DCF_UDP_TRANSPORT_H
+#define DCF_UDP_TRANSPORT_H
+#include "dcf_error.h"
+#include "dcf_io_backend.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Datagrams received per recvmmsg call and sent per sendmmsg call
+#define DCF_UDP_BATCH 32
+#define DCF_UDP_MAX_DATAGRAM 65507
+
+typedef struct DCFUdpTransport DCFUdpTransport;
+
+DCFUdpTransport* dcf_udp_transport_new(void);
+// Binds host:port; rcvbuf/sndbuf set SO_RCVBUF/SO_SNDBUF in bytes, 0 keeps the OS default
+DCFError dcf_udp_transport_initialize(DCFUdpTransport* udp, const char* host, int port, int rcvbuf, int sndbuf);
+// Routes sends and receives through an io backend instead of direct sendmmsg/recvmmsg.
+// Call after initialize; the backend actually selected is returned by get_io_backend.
+DCFError dcf_udp_transport_set_io_backend(DCFUdpTransport* udp, DCFIoBackendType type);
+DCFIoBackendType dcf_udp_transport_get_io_backend(DCFUdpTransport* udp);
+DCFError dcf_udp_transport_send(DCFUdpTransport* udp, const uint8_t* data, size_t len, const char* recipient);
+// results_out (may be NULL) and sent_out as for dcf_io_backend_send_batch
+DCFError dcf_udp_transport_send_batch(DCFUdpTransport* udp, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, DCFError* results_out, size_t* sent_out);
+// Returns the next datagram, refilling the batch with one recvmmsg when it runs dry.
+// The buffer is owned by the transport and valid until the next receive call.
+DCFError dcf_udp_transport_receive(DCFUdpTransport* udp, const uint8_t** data_out, size_t* len_out);
+// Like receive, but returns DCF_ERR_TIMEOUT instead of waiting when nothing is queued
+DCFError dcf_udp_transport_try_receive(DCFUdpTransport* udp, const uint8_t** data_out, size_t* len_out);
+// Pollable fd for receive: the socket, or the io backend's fd when one is set
+int dcf_udp_transport_get_fd(DCFUdpTransport* udp);
+void dcf_udp_transport_free(DCFUdpTransport* udp);
+#endif
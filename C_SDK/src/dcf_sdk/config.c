@@ -1,7 +1,9 @@
 #include "dcf_config.h"
 #include <cjson/cJSON.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 
 struct DCFConfig {
@@ -13,8 +15,49 @@ struct DCFConfig {
     int port;
     int rtt_threshold;
     char* plugin_path;
+    int channels_per_peer;
+    int max_peer_channels;
+    int server_threads;
+    DCFTransportType transport;
+    int socket_rcvbuf;
+    int socket_sndbuf;
+    DCFSocketIo io_backend;
+    bool shared_memory;
+    int probe_interval_ms;
+    int probe_max_interval_ms;
+    int probe_timeout_ms;
+    int probe_concurrency;
+    int probe_neighbors;
+    double phi_threshold;
+    int phi_min_std_ms;
+    int phi_acceptable_pause_ms;
+    int multipath_routes;
+    int gossip_interval_ms;
+    int gossip_indirect_probes;
+    int gossip_suspicion_mult;
+    int gossip_dead_timeout_ms;
+    int max_peers;
+    uint32_t node_id_generation;  // bumped whenever node_id changes
+    pthread_mutex_t node_id_mutex;  // guards node_id against readers that borrow it
 };
 
+static bool dcf_config_parse_transport(const char* value, DCFTransportType* transport_out) {
+    if (strcasecmp(value, "grpc") == 0) *transport_out = DCF_TRANSPORT_GRPC;
+    else if (strcasecmp(value, "udp") == 0) *transport_out = DCF_TRANSPORT_UDP;
+    else if (strcasecmp(value, "tcp") == 0) *transport_out = DCF_TRANSPORT_TCP;
+    else if (strcasecmp(value, "websocket") == 0) *transport_out = DCF_TRANSPORT_WEBSOCKET;
+    else return false;
+    return true;
+}
+
+static bool dcf_config_parse_io_backend(const char* value, DCFSocketIo* io_out) {
+    if (strcasecmp(value, "direct") == 0) *io_out = DCF_SOCKET_IO_DIRECT;
+    else if (strcasecmp(value, "epoll") == 0) *io_out = DCF_SOCKET_IO_EPOLL;
+    else if (strcasecmp(value, "io_uring") == 0) *io_out = DCF_SOCKET_IO_URING;
+    else return false;
+    return true;
+}
+
 DCFConfig* dcf_config_load(const char* path) {
     if (!path) return NULL;
     FILE* fp = fopen(path, "r");
@@ -31,6 +74,24 @@ DCFConfig* dcf_config_load(const char* path) {
     if (!json) return NULL;
     DCFConfig* config = calloc(1, sizeof(DCFConfig));
     if (!config) { cJSON_Delete(json); return NULL; }
+    pthread_mutex_init(&config->node_id_mutex, NULL);
+    config->channels_per_peer = 1;
+    config->max_peer_channels = 256;
+    config->shared_memory = false;
+    config->probe_interval_ms = 1000;
+    config->probe_max_interval_ms = 30000;
+    config->probe_timeout_ms = 500;
+    config->probe_concurrency = 32;
+    config->probe_neighbors = 0;
+    config->phi_threshold = 8.0;
+    config->phi_min_std_ms = 50;
+    config->phi_acceptable_pause_ms = 0;
+    config->multipath_routes = 1;
+    config->gossip_interval_ms = 0;
+    config->gossip_indirect_probes = 3;
+    config->gossip_suspicion_mult = 4;
+    config->gossip_dead_timeout_ms = 30000;
+    config->max_peers = 1024;
     cJSON* mode = cJSON_GetObjectItem(json, "mode");
     if (cJSON_IsString(mode)) {
         if (strcmp(mode->valuestring, "client") == 0) config->mode = CLIENT_MODE;
@@ -58,6 +119,50 @@ DCFConfig* dcf_config_load(const char* path) {
     if (cJSON_IsNumber(rtt)) config->rtt_threshold = rtt->valueint;
     cJSON* plugins = cJSON_GetObjectItem(json, "plugins");
     if (cJSON_IsString(plugins)) config->plugin_path = strdup(plugins->valuestring);
+    cJSON* channels = cJSON_GetObjectItem(json, "channels_per_peer");
+    if (cJSON_IsNumber(channels) && channels->valueint > 0) config->channels_per_peer = channels->valueint;
+    cJSON* max_channels = cJSON_GetObjectItem(json, "max_peer_channels");
+    if (cJSON_IsNumber(max_channels) && max_channels->valueint > 0) config->max_peer_channels = max_channels->valueint;
+    cJSON* server_threads = cJSON_GetObjectItem(json, "server_threads");
+    if (cJSON_IsNumber(server_threads) && server_threads->valueint >= 0) config->server_threads = server_threads->valueint;
+    cJSON* transport = cJSON_GetObjectItem(json, "transport");
+    if (cJSON_IsString(transport)) dcf_config_parse_transport(transport->valuestring, &config->transport);
+    cJSON* rcvbuf = cJSON_GetObjectItem(json, "socket_rcvbuf");
+    if (cJSON_IsNumber(rcvbuf) && rcvbuf->valueint >= 0) config->socket_rcvbuf = rcvbuf->valueint;
+    cJSON* sndbuf = cJSON_GetObjectItem(json, "socket_sndbuf");
+    if (cJSON_IsNumber(sndbuf) && sndbuf->valueint >= 0) config->socket_sndbuf = sndbuf->valueint;
+    cJSON* io_backend = cJSON_GetObjectItem(json, "io_backend");
+    if (cJSON_IsString(io_backend)) dcf_config_parse_io_backend(io_backend->valuestring, &config->io_backend);
+    cJSON* shared_memory = cJSON_GetObjectItem(json, "shared_memory");
+    if (cJSON_IsBool(shared_memory)) config->shared_memory = cJSON_IsTrue(shared_memory);
+    cJSON* probe_interval = cJSON_GetObjectItem(json, "probe_interval_ms");
+    if (cJSON_IsNumber(probe_interval) && probe_interval->valueint >= 0) config->probe_interval_ms = probe_interval->valueint;
+    cJSON* probe_max_interval = cJSON_GetObjectItem(json, "probe_max_interval_ms");
+    if (cJSON_IsNumber(probe_max_interval) && probe_max_interval->valueint > 0) config->probe_max_interval_ms = probe_max_interval->valueint;
+    cJSON* probe_timeout = cJSON_GetObjectItem(json, "probe_timeout_ms");
+    if (cJSON_IsNumber(probe_timeout) && probe_timeout->valueint > 0) config->probe_timeout_ms = probe_timeout->valueint;
+    cJSON* probe_concurrency = cJSON_GetObjectItem(json, "probe_concurrency");
+    if (cJSON_IsNumber(probe_concurrency) && probe_concurrency->valueint > 0) config->probe_concurrency = probe_concurrency->valueint;
+    cJSON* probe_neighbors = cJSON_GetObjectItem(json, "probe_neighbors");
+    if (cJSON_IsNumber(probe_neighbors) && probe_neighbors->valueint >= 0) config->probe_neighbors = probe_neighbors->valueint;
+    cJSON* phi_threshold = cJSON_GetObjectItem(json, "phi_threshold");
+    if (cJSON_IsNumber(phi_threshold) && phi_threshold->valuedouble >= 0) config->phi_threshold = phi_threshold->valuedouble;
+    cJSON* phi_min_std = cJSON_GetObjectItem(json, "phi_min_std_ms");
+    if (cJSON_IsNumber(phi_min_std) && phi_min_std->valueint > 0) config->phi_min_std_ms = phi_min_std->valueint;
+    cJSON* phi_pause = cJSON_GetObjectItem(json, "phi_acceptable_pause_ms");
+    if (cJSON_IsNumber(phi_pause) && phi_pause->valueint >= 0) config->phi_acceptable_pause_ms = phi_pause->valueint;
+    cJSON* multipath_routes = cJSON_GetObjectItem(json, "multipath_routes");
+    if (cJSON_IsNumber(multipath_routes) && multipath_routes->valueint > 0) config->multipath_routes = multipath_routes->valueint;
+    cJSON* gossip_interval = cJSON_GetObjectItem(json, "gossip_interval_ms");
+    if (cJSON_IsNumber(gossip_interval) && gossip_interval->valueint >= 0) config->gossip_interval_ms = gossip_interval->valueint;
+    cJSON* gossip_indirect = cJSON_GetObjectItem(json, "gossip_indirect_probes");
+    if (cJSON_IsNumber(gossip_indirect) && gossip_indirect->valueint >= 0) config->gossip_indirect_probes = gossip_indirect->valueint;
+    cJSON* gossip_suspicion = cJSON_GetObjectItem(json, "gossip_suspicion_mult");
+    if (cJSON_IsNumber(gossip_suspicion) && gossip_suspicion->valueint > 0) config->gossip_suspicion_mult = gossip_suspicion->valueint;
+    cJSON* gossip_dead_timeout = cJSON_GetObjectItem(json, "gossip_dead_timeout_ms");
+    if (cJSON_IsNumber(gossip_dead_timeout) && gossip_dead_timeout->valueint >= 0) config->gossip_dead_timeout_ms = gossip_dead_timeout->valueint;
+    cJSON* max_peers = cJSON_GetObjectItem(json, "max_peers");
+    if (cJSON_IsNumber(max_peers) && max_peers->valueint > 0) config->max_peers = max_peers->valueint;
     cJSON_Delete(json);
     return config;
 }
@@ -71,8 +176,13 @@ DCFError dcf_config_update(DCFConfig* config, const char* key, const char* value
         else if (strcmp(value, "auto") == 0) config->mode = AUTO_MODE;
         else return DCF_ERR_INVALID_ARG;
     } else if (strcmp(key, "node_id") == 0) {
+        char* node_id = strdup(value);
+        if (!node_id) return DCF_ERR_MALLOC_FAIL;
+        pthread_mutex_lock(&config->node_id_mutex);
         free(config->node_id);
-        config->node_id = strdup(value);
+        config->node_id = node_id;
+        __atomic_add_fetch(&config->node_id_generation, 1, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&config->node_id_mutex);
     } else if (strcmp(key, "host") == 0) {
         free(config->host);
         config->host = strdup(value);
@@ -80,6 +190,73 @@ DCFError dcf_config_update(DCFConfig* config, const char* key, const char* value
         config->port = atoi(value);
     } else if (strcmp(key, "rtt_threshold") == 0) {
         config->rtt_threshold = atoi(value);
+    } else if (strcmp(key, "channels_per_peer") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->channels_per_peer = atoi(value);
+    } else if (strcmp(key, "max_peer_channels") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->max_peer_channels = atoi(value);
+    } else if (strcmp(key, "server_threads") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->server_threads = atoi(value);
+    } else if (strcmp(key, "transport") == 0) {
+        DCFTransportType transport;
+        if (!dcf_config_parse_transport(value, &transport)) return DCF_ERR_INVALID_ARG;
+        // Recognised but not implemented by DCFNetworking
+        if (transport == DCF_TRANSPORT_WEBSOCKET) return DCF_ERR_CONFIG_INVALID;
+        config->transport = transport;
+    } else if (strcmp(key, "socket_rcvbuf") == 0) {
+        config->socket_rcvbuf = atoi(value);
+    } else if (strcmp(key, "socket_sndbuf") == 0) {
+        config->socket_sndbuf = atoi(value);
+    } else if (strcmp(key, "io_backend") == 0) {
+        if (!dcf_config_parse_io_backend(value, &config->io_backend)) return DCF_ERR_INVALID_ARG;
+    } else if (strcmp(key, "shared_memory") == 0) {
+        if (strcmp(value, "true") == 0) config->shared_memory = true;
+        else if (strcmp(value, "false") == 0) config->shared_memory = false;
+        else return DCF_ERR_INVALID_ARG;
+    } else if (strcmp(key, "probe_interval_ms") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->probe_interval_ms = atoi(value);
+    } else if (strcmp(key, "probe_max_interval_ms") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->probe_max_interval_ms = atoi(value);
+    } else if (strcmp(key, "probe_timeout_ms") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->probe_timeout_ms = atoi(value);
+    } else if (strcmp(key, "probe_concurrency") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->probe_concurrency = atoi(value);
+    } else if (strcmp(key, "probe_neighbors") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->probe_neighbors = atoi(value);
+    } else if (strcmp(key, "phi_threshold") == 0) {
+        if (atof(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->phi_threshold = atof(value);
+    } else if (strcmp(key, "phi_min_std_ms") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->phi_min_std_ms = atoi(value);
+    } else if (strcmp(key, "phi_acceptable_pause_ms") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->phi_acceptable_pause_ms = atoi(value);
+    } else if (strcmp(key, "multipath_routes") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->multipath_routes = atoi(value);
+    } else if (strcmp(key, "gossip_interval_ms") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->gossip_interval_ms = atoi(value);
+    } else if (strcmp(key, "gossip_indirect_probes") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->gossip_indirect_probes = atoi(value);
+    } else if (strcmp(key, "gossip_suspicion_mult") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->gossip_suspicion_mult = atoi(value);
+    } else if (strcmp(key, "gossip_dead_timeout_ms") == 0) {
+        if (atoi(value) < 0) return DCF_ERR_INVALID_ARG;
+        config->gossip_dead_timeout_ms = atoi(value);
+    } else if (strcmp(key, "max_peers") == 0) {
+        if (atoi(value) <= 0) return DCF_ERR_INVALID_ARG;
+        config->max_peers = atoi(value);
     } else if (strcmp(key, "plugin_path") == 0) {
         free(config->plugin_path);
         config->plugin_path = strdup(value);
@@ -89,6 +266,130 @@ DCFError dcf_config_update(DCFConfig* config, const char* key, const char* value
     return DCF_SUCCESS;
 }
 
+int dcf_config_get_channels_per_peer(DCFConfig* config) {
+    if (!config) return 1;
+    return config->channels_per_peer;
+}
+
+int dcf_config_get_max_peer_channels(DCFConfig* config) {
+    if (!config) return 256;
+    return config->max_peer_channels;
+}
+
+int dcf_config_get_server_threads(DCFConfig* config) {
+    if (!config) return 0;
+    return config->server_threads;
+}
+
+DCFTransportType dcf_config_get_transport(DCFConfig* config) {
+    if (!config) return DCF_TRANSPORT_GRPC;
+    return config->transport;
+}
+
+int dcf_config_get_socket_rcvbuf(DCFConfig* config) {
+    if (!config) return 0;
+    return config->socket_rcvbuf;
+}
+
+int dcf_config_get_socket_sndbuf(DCFConfig* config) {
+    if (!config) return 0;
+    return config->socket_sndbuf;
+}
+
+DCFSocketIo dcf_config_get_io_backend(DCFConfig* config) {
+    if (!config) return DCF_SOCKET_IO_DIRECT;
+    return config->io_backend;
+}
+
+bool dcf_config_get_shared_memory(DCFConfig* config) {
+    if (!config) return false;
+    return config->shared_memory;
+}
+
+int dcf_config_get_probe_interval_ms(DCFConfig* config) {
+    if (!config) return 1000;
+    return config->probe_interval_ms;
+}
+
+int dcf_config_get_probe_max_interval_ms(DCFConfig* config) {
+    if (!config) return 30000;
+    return config->probe_max_interval_ms;
+}
+
+int dcf_config_get_probe_timeout_ms(DCFConfig* config) {
+    if (!config) return 500;
+    return config->probe_timeout_ms;
+}
+
+int dcf_config_get_probe_concurrency(DCFConfig* config) {
+    if (!config) return 32;
+    return config->probe_concurrency;
+}
+
+int dcf_config_get_probe_neighbors(DCFConfig* config) {
+    if (!config) return 0;
+    return config->probe_neighbors;
+}
+
+double dcf_config_get_phi_threshold(DCFConfig* config) {
+    if (!config) return 8.0;
+    return config->phi_threshold;
+}
+
+int dcf_config_get_phi_min_std_ms(DCFConfig* config) {
+    if (!config) return 50;
+    return config->phi_min_std_ms;
+}
+
+int dcf_config_get_phi_acceptable_pause_ms(DCFConfig* config) {
+    if (!config) return 0;
+    return config->phi_acceptable_pause_ms;
+}
+
+int dcf_config_get_multipath_routes(DCFConfig* config) {
+    if (!config) return 1;
+    return config->multipath_routes;
+}
+
+int dcf_config_get_gossip_interval_ms(DCFConfig* config) {
+    if (!config) return 0;
+    return config->gossip_interval_ms;
+}
+
+int dcf_config_get_gossip_indirect_probes(DCFConfig* config) {
+    if (!config) return 3;
+    return config->gossip_indirect_probes;
+}
+
+int dcf_config_get_gossip_suspicion_mult(DCFConfig* config) {
+    if (!config) return 4;
+    return config->gossip_suspicion_mult;
+}
+
+int dcf_config_get_gossip_dead_timeout_ms(DCFConfig* config) {
+    if (!config) return 30000;
+    return config->gossip_dead_timeout_ms;
+}
+
+int dcf_config_get_max_peers(DCFConfig* config) {
+    if (!config) return 1024;
+    return config->max_peers;
+}
+
+const char* dcf_config_acquire_node_id(DCFConfig* config) {
+    if (!config) return NULL;
+    pthread_mutex_lock(&config->node_id_mutex);
+    return config->node_id;
+}
+
+void dcf_config_release_node_id(DCFConfig* config) {
+    if (config) pthread_mutex_unlock(&config->node_id_mutex);
+}
+
+uint32_t dcf_config_get_node_id_generation(DCFConfig* config) {
+    return config ? __atomic_load_n(&config->node_id_generation, __ATOMIC_ACQUIRE) : 0;
+}
+
 void dcf_config_free(DCFConfig* config) {
     if (!config) return;
     free(config->node_id);
@@ -96,5 +397,6 @@ void dcf_config_free(DCFConfig* config) {
     free(config->plugin_path);
     for (size_t i = 0; i < config->peer_count; i++) free(config->peers[i]);
     free(config->peers);
+    pthread_mutex_destroy(&config->node_id_mutex);
     free(config);
 }
@@ -0,0 +1,77 @@
+#include "dcf_address.h"
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <string.h>
+
+bool dcf_address_split(const char* address, char* host, size_t host_cap, char* port, size_t port_cap) {
+    if (!address || !host || !port) return false;
+    const char* colon = strrchr(address, ':');
+    if (!colon || colon == address) return false;
+    const char* host_start = address;
+    size_t host_len = colon - address;
+    if (address[0] == '[' && colon[-1] == ']') {
+        host_start++;
+        host_len -= 2;
+    }
+    if (host_len >= host_cap || strlen(colon + 1) >= port_cap) return false;
+    memcpy(host, host_start, host_len);
+    host[host_len] = '\0';
+    strcpy(port, colon + 1);
+    return true;
+}
+
+bool dcf_address_resolve(const char* address, int family, int socktype, struct addrinfo** res_out) {
+    char host[256], port[16];
+    if (!res_out || !dcf_address_split(address, host, sizeof(host), port, sizeof(port))) return false;
+    struct addrinfo hints = {0};
+    hints.ai_family = family;
+    hints.ai_socktype = socktype;
+    hints.ai_flags = AI_NUMERICSERV;
+    return getaddrinfo(host, port, &hints, res_out) == 0;
+}
+
+static bool dcf_address_same_ip(const struct sockaddr* a, const struct sockaddr* b) {
+    if (!a || !b || a->sa_family != b->sa_family) return false;
+    if (a->sa_family == AF_INET) {
+        return ((const struct sockaddr_in*)a)->sin_addr.s_addr == ((const struct sockaddr_in*)b)->sin_addr.s_addr;
+    }
+    if (a->sa_family == AF_INET6) {
+        return memcmp(&((const struct sockaddr_in6*)a)->sin6_addr, &((const struct sockaddr_in6*)b)->sin6_addr, sizeof(struct in6_addr)) == 0;
+    }
+    return false;
+}
+
+static bool dcf_address_is_loopback(const struct sockaddr* addr) {
+    if (addr->sa_family == AF_INET) {
+        return (ntohl(((const struct sockaddr_in*)addr)->sin_addr.s_addr) >> 24) == 127;
+    }
+    if (addr->sa_family == AF_INET6) {
+        const struct in6_addr* v6 = &((const struct sockaddr_in6*)addr)->sin6_addr;
+        return IN6_IS_ADDR_LOOPBACK(v6) || (IN6_IS_ADDR_V4MAPPED(v6) && v6->s6_addr[12] == 127);
+    }
+    return false;
+}
+
+bool dcf_address_is_local(const char* host) {
+    if (!host) return false;
+    struct addrinfo hints = {0}, *res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) return false;
+    struct ifaddrs* ifs = NULL;
+    bool local = false;
+    for (struct addrinfo* ai = res; ai && !local; ai = ai->ai_next) {
+        if (dcf_address_is_loopback(ai->ai_addr)) {
+            local = true;
+            break;
+        }
+        if (!ifs && getifaddrs(&ifs) != 0) break;
+        for (struct ifaddrs* ifa = ifs; ifa && !local; ifa = ifa->ifa_next) {
+            local = dcf_address_same_ip(ai->ai_addr, ifa->ifa_addr);
+        }
+    }
+    if (ifs) freeifaddrs(ifs);
+    freeaddrinfo(res);
+    return local;
+}
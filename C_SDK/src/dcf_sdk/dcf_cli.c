@@ -24,7 +24,7 @@ int main(int argc, char** argv) {
         printf("  list-peers - List peers\n");
         printf("  heal [peer] - Heal network for peer\n");
         printf("  version - Display version\n");
-        printf("  benchmark [peer] - Benchmark peer\n");
+        printf("  benchmark [peer,...] [concurrency=N] [size=BYTES] [rate=MSGS_PER_S] [duration=S] [timeout=MS] - Load test peers\n");
         printf("  group-peers - Regroup peers\n");
         printf("  simulate-failure [peer] - Simulate failure\n");
         printf("  log-level [level] - Set log level (0=debug, 1=info, 2=error)\n");
@@ -1,9 +1,41 @@
 #include "dcf_client.h"
 #include "dcf_serialization.h"
+#include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
 #include <uuid/uuid.h>
 
+// Messages dispatched per dcf_client_poll call, so one busy source can't starve the caller's loop
+#define DCF_CLIENT_POLL_BUDGET 1024
+// Destinations whose pre-encoded envelope is kept; a colliding destination replaces the slot
+#define DCF_ENVELOPE_SLOTS 64
+// Most disjoint routes one multipath send goes out over, whatever multipath_routes says
+#define DCF_MULTIPATH_MAX 8
+// How long a multipath send waits on its copies when the caller sets no timeout
+#define DCF_MULTIPATH_TIMEOUT_MS 5000
+
+// A cached envelope; senders packing around it hold references, so a slot can
+// be replaced under them, and whoever drops the last one frees it
+typedef struct {
+    DCFEnvelope* envelope;
+    uint32_t refs;
+} DCFSharedEnvelope;
+
+typedef struct {
+    char* recipient;
+    DCFSharedEnvelope* shared;
+} DCFEnvelopeSlot;
+
+// Exactly one of fn and payload_fn is set
+typedef struct {
+    DCFMessageHandler fn;
+    DCFPayloadHandler payload_fn;
+    void* user_data;
+} DCFHandler;
+
 struct DCFClient {
     DCFConfig* config;
     DCFNetworking* networking;
@@ -12,6 +44,13 @@ struct DCFClient {
     bool running;
     int log_level;  // Default: 1 (info)
     DCFMode current_mode;  // For AUTO mode adjustments
+    DCFHandler* handlers;
+    size_t handler_count;
+    size_t handler_cap;
+    pthread_mutex_t envelope_mutex;
+    DCFEnvelopeSlot envelopes[DCF_ENVELOPE_SLOTS];
+    uint32_t envelope_generation;  // node id generation the envelopes were built for
+    uint32_t sequence;             // last sequence number sent, advanced atomically
 };
 
 DCFClient* dcf_client_new(void) {
@@ -19,6 +58,7 @@ DCFClient* dcf_client_new(void) {
     if (!client) return NULL;
     client->log_level = 1;  // Default: info
     client->current_mode = AUTO_MODE;  // Default to AUTO
+    pthread_mutex_init(&client->envelope_mutex, NULL);
     return client;
 }
 
@@ -32,8 +72,13 @@ DCFError dcf_client_initialize(DCFClient* client, const char* config_path) {
     if (err != DCF_SUCCESS) return err;
     client->plugin_mgr = dcf_plugin_manager_new();
     if (!client->plugin_mgr) return DCF_ERR_MALLOC_FAIL;
-    err = dcf_plugin_manager_load(client->plugin_mgr, client->config);
-    if (err != DCF_SUCCESS) return err;
+    // Plugins are optional; only a configured one that fails to load is an error
+    char* plugin_path = NULL;
+    if (dcf_config_get_plugin_path(client->config, &plugin_path) == DCF_SUCCESS && plugin_path) {
+        free(plugin_path);
+        err = dcf_plugin_manager_load(client->plugin_mgr, client->config);
+        if (err != DCF_SUCCESS) return err;
+    }
     client->redundancy = dcf_redundancy_new();
     if (!client->redundancy) return DCF_ERR_MALLOC_FAIL;
     err = dcf_redundancy_initialize(client->redundancy, client->config, client->networking);
@@ -51,11 +96,25 @@ DCFError dcf_client_start(DCFClient* client) {
     client->running = true;
     DCFError err = dcf_networking_start(client->networking, client->current_mode);
     if (err != DCF_SUCCESS) return err;
+    char** peers;
+    size_t peer_count;
+    // Open peer connections up front so the first message doesn't pay connection setup
+    if (dcf_config_get_peers(client->config, &peers, &peer_count) == DCF_SUCCESS) {
+        dcf_networking_warm_up(client->networking, (const char* const*)peers, peer_count);
+        for (size_t i = 0; i < peer_count; i++) free(peers[i]);
+        free(peers);
+    }
     err = dcf_redundancy_start(client->redundancy, client->current_mode);
     if (err != DCF_SUCCESS) return err;
     return DCF_SUCCESS;
 }
 
+DCFError dcf_client_set_transport(DCFClient* client, ITransport* transport) {
+    if (!client || !transport) return DCF_ERR_NULL_PTR;
+    if (!client->plugin_mgr) return DCF_ERR_INVALID_STATE;
+    return dcf_plugin_manager_set_transport(client->plugin_mgr, transport);
+}
+
 DCFError dcf_client_stop(DCFClient* client) {
     if (!client) return DCF_ERR_NULL_PTR;
     if (!client->running) return DCF_ERR_INVALID_STATE;
@@ -67,63 +126,548 @@ DCFError dcf_client_stop(DCFClient* client) {
     return DCF_SUCCESS;
 }
 
-DCFError dcf_client_send_message(DCFClient* client, const char* data, const char* recipient, char** response_out) {
-    if (!client || !data || !recipient || !response_out) return DCF_ERR_NULL_PTR;
-    if (!client->running) return DCF_ERR_INVALID_STATE;
-    char* node_id;
-    DCFError err = dcf_config_get_node_id(client->config, &node_id);
+static void dcf_client_release_envelope(DCFSharedEnvelope* shared) {
+    if (!shared || __atomic_sub_fetch(&shared->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+    dcf_envelope_free(shared->envelope);
+    free(shared);
+}
+
+static void dcf_client_flush_envelopes(DCFClient* client) {
+    for (size_t i = 0; i < DCF_ENVELOPE_SLOTS; i++) {
+        free(client->envelopes[i].recipient);
+        dcf_client_release_envelope(client->envelopes[i].shared);
+        client->envelopes[i].recipient = NULL;
+        client->envelopes[i].shared = NULL;
+    }
+}
+
+static uint32_t dcf_client_hash(const char* s) {
+    uint32_t hash = 2166136261u;
+    while (*s) hash = (hash ^ (uint8_t)*s++) * 16777619u;
+    return hash;
+}
+
+// Packs into this thread's scratch buffer around recipient's cached envelope,
+// built on first use and rebuilt after the node id changes. envelope_mutex
+// covers only the slot lookup; the pack works on a reference to the envelope.
+static DCFError dcf_client_pack(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, const uint8_t** serialized_out, size_t* len_out) {
+    uint32_t sequence = __atomic_add_fetch(&client->sequence, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&client->envelope_mutex);
+    uint32_t generation = dcf_config_get_node_id_generation(client->config);
+    if (generation != client->envelope_generation) {
+        dcf_client_flush_envelopes(client);
+        client->envelope_generation = generation;
+    }
+    DCFEnvelopeSlot* slot = &client->envelopes[dcf_client_hash(recipient) % DCF_ENVELOPE_SLOTS];
+    if (!slot->recipient || strcmp(slot->recipient, recipient) != 0) {
+        const char* node_id = dcf_config_acquire_node_id(client->config);
+        bool named = node_id != NULL;
+        char* key = strdup(recipient);
+        DCFSharedEnvelope* shared = malloc(sizeof(DCFSharedEnvelope));
+        DCFEnvelope* envelope = named ? dcf_envelope_new(node_id, recipient, NULL, NULL) : NULL;
+        dcf_config_release_node_id(client->config);
+        if (!key || !shared || !envelope) {
+            pthread_mutex_unlock(&client->envelope_mutex);
+            free(key);
+            free(shared);
+            dcf_envelope_free(envelope);
+            return named ? DCF_ERR_MALLOC_FAIL : DCF_ERR_CONFIG_INVALID;
+        }
+        shared->envelope = envelope;
+        shared->refs = 1;
+        free(slot->recipient);
+        dcf_client_release_envelope(slot->shared);
+        slot->recipient = key;
+        slot->shared = shared;
+    }
+    DCFSharedEnvelope* shared = slot->shared;
+    __atomic_add_fetch(&shared->refs, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&client->envelope_mutex);
+    DCFError err = dcf_envelope_pack_scratch(shared->envelope, payload, payload_len, time(NULL), sequence, serialized_out, len_out);
+    dcf_client_release_envelope(shared);
+    return err;
+}
+
+// Shared by the copies of one multipath send and the thread waiting on them;
+// whoever drops the last reference frees it
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    DCFRedundancy* redundancy;
+    size_t refs;        // copies in flight plus the sender
+    size_t pending;     // copies not yet completed
+    bool delivered;
+    DCFError err;       // a failed copy's error, returned when none got through
+    uint8_t* reply;     // the first delivered copy's packed reply, if it had one
+    size_t reply_len;
+} DCFMultipathSend;
+
+typedef struct {
+    DCFMultipathSend* send;
+    char* hop;
+} DCFMultipathCopy;
+
+// Called with send->mutex held, which it releases
+static void dcf_client_multipath_release(DCFMultipathSend* send) {
+    bool last = --send->refs == 0;
+    pthread_mutex_unlock(&send->mutex);
+    if (!last) return;
+    pthread_mutex_destroy(&send->mutex);
+    pthread_cond_destroy(&send->cond);
+    free(send->reply);
+    free(send);
+}
+
+static void dcf_client_multipath_done(void* user_data, DCFError err, const uint8_t* response, size_t response_len) {
+    DCFMultipathCopy* copy = user_data;
+    DCFMultipathSend* send = copy->send;
+    // Only a reply shows the hop is alive; a socket send completes as soon as the kernel takes it
+    if (err == DCF_SUCCESS && response) dcf_redundancy_heartbeat(send->redundancy, copy->hop);
+    free(copy->hop);
+    free(copy);
+    pthread_mutex_lock(&send->mutex);
+    send->pending--;
+    if (err == DCF_SUCCESS && !send->delivered && response) {
+        send->reply = malloc(response_len ? response_len : 1);
+        if (send->reply) {
+            memcpy(send->reply, response, response_len);
+            send->reply_len = response_len;
+        }
+    }
+    if (err == DCF_SUCCESS) send->delivered = true;
+    else send->err = err;
+    pthread_cond_broadcast(&send->cond);
+    dcf_client_multipath_release(send);
+}
+
+// Sends one copy per disjoint route, all sharing a sequence number and each
+// naming its path in redundancy_path. Hops relay a copy along its path and the
+// recipient keeps only the first to arrive. Returns once a copy is delivered to
+// its first hop, with that hop's packed reply in *reply_out (NULL without one)
+// for the caller to free, or with an error once all failed or timed out.
+static DCFError dcf_client_send_multipath(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, size_t k, int timeout_ms, uint8_t** reply_out, size_t* reply_len_out) {
+    char* routes[DCF_MULTIPATH_MAX];
+    DCFEnvelope* envelopes[DCF_MULTIPATH_MAX] = { NULL };
+    size_t count;
+    DCFError err = dcf_redundancy_get_disjoint_routes(client->redundancy, recipient, k < DCF_MULTIPATH_MAX ? k : DCF_MULTIPATH_MAX, routes, &count);
     if (err != DCF_SUCCESS) return err;
-    uint8_t* serialized;
+    DCFMultipathSend* send = calloc(1, sizeof(DCFMultipathSend));
+    const char* node_id = dcf_config_acquire_node_id(client->config);
+    bool named = node_id != NULL;
+    for (size_t i = 0; i < count && named; i++) envelopes[i] = dcf_envelope_new(node_id, recipient, routes[i], NULL);
+    dcf_config_release_node_id(client->config);
+    err = named ? DCF_SUCCESS : DCF_ERR_CONFIG_INVALID;
+    for (size_t i = 0; i < count && err == DCF_SUCCESS; i++) {
+        if (!envelopes[i]) err = DCF_ERR_MALLOC_FAIL;
+    }
+    if (!send && err == DCF_SUCCESS) err = DCF_ERR_MALLOC_FAIL;
+    if (err != DCF_SUCCESS) {
+        for (size_t i = 0; i < count; i++) {
+            free(routes[i]);
+            dcf_envelope_free(envelopes[i]);
+        }
+        free(send);
+        return err;
+    }
+    pthread_mutex_init(&send->mutex, NULL);
+    pthread_cond_init(&send->cond, NULL);
+    send->redundancy = client->redundancy;
+    send->refs = 1;
+    send->err = DCF_ERR_NETWORK_FAIL;
+    if (timeout_ms <= 0) timeout_ms = DCF_MULTIPATH_TIMEOUT_MS;
+    uint32_t sequence = __atomic_add_fetch(&client->sequence, 1, __ATOMIC_RELAXED);
+    int64_t timestamp = time(NULL);
+    for (size_t i = 0; i < count; i++) {
+        // The route now names only its first hop, which is where this copy goes
+        routes[i][strcspn(routes[i], ",")] = '\0';
+        const uint8_t* serialized;
+        size_t serialized_len;
+        DCFMultipathCopy* copy = malloc(sizeof(DCFMultipathCopy));
+        err = copy ? dcf_envelope_pack_scratch(envelopes[i], payload, payload_len, timestamp, sequence, &serialized, &serialized_len) : DCF_ERR_MALLOC_FAIL;
+        dcf_envelope_free(envelopes[i]);
+        if (err == DCF_SUCCESS) {
+            copy->send = send;
+            copy->hop = routes[i];
+            pthread_mutex_lock(&send->mutex);
+            send->refs++;
+            send->pending++;
+            pthread_mutex_unlock(&send->mutex);
+            // Transports copy the buffer before returning, so the scratch can be reused.
+            // Socket and shared-memory sends complete inside the call.
+            err = dcf_networking_send_async(client->networking, serialized, serialized_len, routes[i], timeout_ms, dcf_client_multipath_done, copy);
+            if (err == DCF_SUCCESS) continue;
+            pthread_mutex_lock(&send->mutex);
+            send->refs--;
+            send->pending--;
+            pthread_mutex_unlock(&send->mutex);
+        }
+        pthread_mutex_lock(&send->mutex);
+        send->err = err;
+        pthread_mutex_unlock(&send->mutex);
+        free(copy);
+        free(routes[i]);
+    }
+    pthread_mutex_lock(&send->mutex);
+    while (!send->delivered && send->pending > 0) pthread_cond_wait(&send->cond, &send->mutex);
+    err = send->delivered ? DCF_SUCCESS : send->err;
+    *reply_out = send->reply;
+    *reply_len_out = send->reply_len;
+    send->reply = NULL;
+    dcf_client_multipath_release(send);
+    return err;
+}
+
+// The response to a send is the data of the recipient's own reply to it; transports
+// without replies complete with an empty one
+static DCFError dcf_client_reply_view(const uint8_t* reply, size_t reply_len, const uint8_t** response_out, size_t* response_len_out) {
+    if (!reply) {
+        *response_out = (const uint8_t*)"";
+        *response_len_out = 0;
+        return DCF_SUCCESS;
+    }
+    const char* sender;
+    return dcf_deserialize_payload_view(reply, reply_len, response_out, response_len_out, &sender);
+}
+
+DCFError dcf_client_send_payload(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, const uint8_t** response_out, size_t* response_len_out) {
+    return dcf_client_send_payload_timeout(client, payload, payload_len, recipient, 0, response_out, response_len_out);
+}
+
+DCFError dcf_client_send_payload_timeout(DCFClient* client, const uint8_t* payload, size_t payload_len, const char* recipient, int timeout_ms, const uint8_t** response_out, size_t* response_len_out) {
+    if (!client || (!payload && payload_len) || !recipient || !response_out || !response_len_out) return DCF_ERR_NULL_PTR;
+    if (!client->running) return DCF_ERR_INVALID_STATE;
+    const char* sender;
+    ITransport* transport = dcf_plugin_manager_get_transport(client->plugin_mgr);
+    bool routed = client->current_mode == P2P_MODE || client->current_mode == AUTO_MODE;
+    int paths = dcf_config_get_multipath_routes(client->config);
+    // Multipath needs async sends, which in-process transports don't have
+    if (paths > 1 && routed && !transport) {
+        uint8_t* reply;
+        size_t reply_len;
+        DCFError err = dcf_client_send_multipath(client, payload, payload_len, recipient, (size_t)paths, timeout_ms, &reply, &reply_len);
+        if (err == DCF_SUCCESS) err = dcf_client_reply_view(reply, reply_len, response_out, response_len_out);
+        free(reply);
+        return err;
+    }
+    // Packed into this thread's scratch buffer, so a steady stream of sends doesn't allocate
+    const uint8_t* serialized;
     size_t serialized_len;
-    err = dcf_serialize_message(data, node_id, recipient, &serialized, &serialized_len);
-    free(node_id);
+    DCFError err = dcf_client_pack(client, payload, payload_len, recipient, &serialized, &serialized_len);
     if (err != DCF_SUCCESS) return err;
     char* target = (char*)recipient;
-    if (client->current_mode == P2P_MODE || client->current_mode == AUTO_MODE) {
+    if (routed) {
         err = dcf_redundancy_get_optimal_route(client->redundancy, recipient, &target);
-        if (err != DCF_SUCCESS) { free(serialized); return err; }
+        if (err != DCF_SUCCESS) return err;
+    }
+    if (target != recipient && strcmp(target, recipient) != 0) {
+        // Hops relay a message along its redundancy_path, so an indirect route travels with it
+        free(target);
+        char* path;
+        size_t count;
+        err = dcf_redundancy_get_disjoint_routes(client->redundancy, recipient, 1, &path, &count);
+        if (err == DCF_SUCCESS && count == 0) err = DCF_ERR_ROUTE_NOT_FOUND;
+        if (err != DCF_SUCCESS) return err;
+        err = dcf_serialize_rerouted_scratch(serialized, serialized_len, (const uint8_t*)path, strlen(path), &serialized, &serialized_len);
+        path[strcspn(path, ",")] = '\0';
+        target = path;
+        if (err != DCF_SUCCESS) {
+            free(target);
+            return err;
+        }
     }
-    ITransport* transport = dcf_plugin_manager_get_transport(client->plugin_mgr);
     if (transport) {
         if (!transport->send(transport, serialized, serialized_len, target)) {
-            free(serialized);
             if (target != recipient) free(target);
             return DCF_ERR_NETWORK_FAIL;
         }
         size_t response_len;
         uint8_t* response_data = transport->receive(transport, &response_len);
         if (response_data) {
-            char* sender;
-            err = dcf_deserialize_message(response_data, response_len, response_out, &sender);
+            err = dcf_deserialize_payload_view(response_data, response_len, response_out, response_len_out, &sender);
             free(response_data);
-            free(sender);
         } else {
             err = DCF_ERR_NETWORK_FAIL;
         }
     } else {
-        err = dcf_networking_send(client->networking, serialized, serialized_len, target);
-        if (err == DCF_SUCCESS) {
-            err = dcf_networking_receive(client->networking, response_out, NULL);
-        }
+        uint8_t* reply;
+        size_t reply_len;
+        err = dcf_networking_request(client->networking, serialized, serialized_len, target, timeout_ms, &reply, &reply_len);
+        if (err == DCF_SUCCESS) err = dcf_client_reply_view(reply, reply_len, response_out, response_len_out);
+        // A reply proves the hop alive to the failure detector; a send the kernel took does not
+        if (err == DCF_SUCCESS && reply) dcf_redundancy_heartbeat(client->redundancy, target);
+        free(reply);
     }
-    free(serialized);
     if (target != recipient) free(target);
     return err;
 }
 
-DCFError dcf_client_receive_message(DCFClient* client, char** message_out, char** sender_out) {
-    if (!client || !message_out || !sender_out) return DCF_ERR_NULL_PTR;
+DCFError dcf_client_send_message(DCFClient* client, const char* data, const char* recipient, char** response_out) {
+    if (!client || !data || !recipient || !response_out) return DCF_ERR_NULL_PTR;
+    const uint8_t* response;
+    size_t response_len;
+    DCFError err = dcf_client_send_payload(client, (const uint8_t*)data, strlen(data), recipient, &response, &response_len);
+    if (err != DCF_SUCCESS) return err;
+    *response_out = strdup((const char*)response);
+    return *response_out ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+}
+
+typedef struct {
+    const char* key;
+    size_t index;
+} DCFBatchKey;
+
+static int dcf_batch_key_compare(const void* a, const void* b) {
+    const DCFBatchKey* ka = a;
+    const DCFBatchKey* kb = b;
+    int cmp = strcmp(ka->key, kb->key);
+    if (cmp != 0) return cmp;
+    return ka->index < kb->index ? -1 : ka->index > kb->index;
+}
+
+DCFError dcf_client_send_batch(DCFClient* client, const DCFBatchEntry* entries, size_t count, DCFError* results_out) {
+    if (!client || !entries || !results_out) return DCF_ERR_NULL_PTR;
+    if (!client->running) return DCF_ERR_INVALID_STATE;
+    if (count == 0) return DCF_SUCCESS;
+    char* node_id;
+    DCFError err = dcf_config_get_node_id(client->config, &node_id);
+    if (err != DCF_SUCCESS) return err;
+    const char** data = malloc(count * sizeof(char*));
+    size_t* data_lens = malloc(count * sizeof(size_t));
+    const char** recipients = malloc(count * sizeof(char*));
+    size_t* lens = malloc(count * sizeof(size_t));
+    const uint8_t** packed = malloc(count * sizeof(uint8_t*));
+    char** routes = calloc(count, sizeof(char*));
+    DCFBatchKey* keys = malloc(count * sizeof(DCFBatchKey));
+    const uint8_t** group_data = malloc(count * sizeof(uint8_t*));
+    size_t* group_lens = malloc(count * sizeof(size_t));
+    size_t* group_index = malloc(count * sizeof(size_t));
+    DCFError* group_results = malloc(count * sizeof(DCFError));
+    uint8_t* buffer = NULL;
+    if (!data || !data_lens || !recipients || !lens || !packed || !routes || !keys || !group_data || !group_lens || !group_index || !group_results) {
+        err = DCF_ERR_MALLOC_FAIL;
+        goto done;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!entries[i].data || !entries[i].recipient) {
+            err = DCF_ERR_NULL_PTR;
+            goto done;
+        }
+        data[i] = entries[i].data;
+        data_lens[i] = entries[i].binary || entries[i].len ? entries[i].len : strlen(entries[i].data);
+        recipients[i] = entries[i].recipient;
+    }
+    err = dcf_serialize_batch(node_id, data, data_lens, recipients, count, &buffer, lens);
+    if (err != DCF_SUCCESS) goto done;
+    for (size_t i = 0, offset = 0; i < count; offset += lens[i], i++) {
+        packed[i] = buffer + offset;
+        results_out[i] = DCF_SUCCESS;
+    }
+    ITransport* transport = dcf_plugin_manager_get_transport(client->plugin_mgr);
+    if (transport) {
+        // ITransport has no batch operation
+        for (size_t i = 0; i < count; i++) {
+            results_out[i] = transport->send(transport, packed[i], lens[i], recipients[i]) ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+            if (err == DCF_SUCCESS) err = results_out[i];
+        }
+        goto done;
+    }
+    // Resolve each distinct recipient once, then group entries that share a route
+    for (size_t i = 0; i < count; i++) keys[i] = (DCFBatchKey){ recipients[i], i };
+    qsort(keys, count, sizeof(DCFBatchKey), dcf_batch_key_compare);
+    bool routed = client->current_mode == P2P_MODE || client->current_mode == AUTO_MODE;
+    for (size_t start = 0, end; start < count; start = end) {
+        for (end = start + 1; end < count && strcmp(keys[end].key, keys[start].key) == 0; end++) {}
+        char* route = NULL;
+        DCFError route_err = routed ? dcf_redundancy_get_optimal_route(client->redundancy, keys[start].key, &route) : DCF_SUCCESS;
+        // The run's first entry owns the route string; the rest share it
+        routes[keys[start].index] = route;
+        for (size_t k = start; k < end; k++) {
+            if (route_err != DCF_SUCCESS) results_out[keys[k].index] = route_err;
+            else if (route) keys[k].key = route;
+        }
+    }
+    qsort(keys, count, sizeof(DCFBatchKey), dcf_batch_key_compare);
+    for (size_t start = 0, end; start < count; start = end) {
+        for (end = start + 1; end < count && strcmp(keys[end].key, keys[start].key) == 0; end++) {}
+        // Entries whose route lookup failed already carry their error
+        size_t group = 0;
+        for (size_t k = start; k < end; k++) {
+            size_t i = keys[k].index;
+            if (results_out[i] != DCF_SUCCESS) continue;
+            group_data[group] = packed[i];
+            group_lens[group] = lens[i];
+            group_index[group] = i;
+            group++;
+        }
+        if (group == 0) continue;
+        dcf_networking_send_batch(client->networking, group_data, group_lens, group, keys[start].key, group_results);
+        for (size_t g = 0; g < group; g++) results_out[group_index[g]] = group_results[g];
+    }
+    for (size_t i = 0; i < count && err == DCF_SUCCESS; i++) err = results_out[i];
+done:
+    free(node_id);
+    free(buffer);
+    free(data);
+    free(data_lens);
+    free(recipients);
+    free(lens);
+    free(packed);
+    if (routes) for (size_t i = 0; i < count; i++) free(routes[i]);
+    free(routes);
+    free(keys);
+    free(group_data);
+    free(group_lens);
+    free(group_index);
+    free(group_results);
+    return err;
+}
+
+DCFError dcf_client_receive_payload(DCFClient* client, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    if (!client || !payload_out || !payload_len_out || !sender_out) return DCF_ERR_NULL_PTR;
     if (!client->running) return DCF_ERR_INVALID_STATE;
     ITransport* transport = dcf_plugin_manager_get_transport(client->plugin_mgr);
     if (transport) {
         size_t response_len;
         uint8_t* response_data = transport->receive(transport, &response_len);
         if (!response_data) return DCF_ERR_NETWORK_FAIL;
-        DCFError err = dcf_deserialize_message(response_data, response_len, message_out, sender_out);
+        // The view is unpacked into the arena, so the plugin's buffer can go
+        DCFError err = dcf_deserialize_payload_view(response_data, response_len, payload_out, payload_len_out, sender_out);
         free(response_data);
         return err;
     }
-    return dcf_networking_receive(client->networking, message_out, sender_out);
+    DCFError err = dcf_networking_receive_payload(client->networking, payload_out, payload_len_out, sender_out);
+    if (err == DCF_SUCCESS) dcf_redundancy_heartbeat(client->redundancy, *sender_out);
+    return err;
+}
+
+DCFError dcf_client_try_receive_payload(DCFClient* client, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    if (!client || !payload_out || !payload_len_out || !sender_out) return DCF_ERR_NULL_PTR;
+    if (!client->running) return DCF_ERR_INVALID_STATE;
+    // Plugin transports only offer a blocking receive
+    if (dcf_plugin_manager_get_transport(client->plugin_mgr)) return DCF_ERR_INVALID_STATE;
+    DCFError err = dcf_networking_try_receive_payload(client->networking, payload_out, payload_len_out, sender_out);
+    if (err == DCF_SUCCESS) dcf_redundancy_heartbeat(client->redundancy, *sender_out);
+    return err;
+}
+
+static DCFError dcf_client_copy_message(DCFError err, const uint8_t* payload, const char* sender, char** message_out, char** sender_out) {
+    if (err != DCF_SUCCESS) return err;
+    *message_out = strdup((const char*)payload);
+    *sender_out = strdup(sender);
+    if (!*message_out || !*sender_out) {
+        free(*message_out);
+        free(*sender_out);
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_client_receive_message(DCFClient* client, char** message_out, char** sender_out) {
+    if (!client || !message_out || !sender_out) return DCF_ERR_NULL_PTR;
+    const uint8_t* payload;
+    size_t payload_len;
+    const char* sender;
+    DCFError err = dcf_client_receive_payload(client, &payload, &payload_len, &sender);
+    return dcf_client_copy_message(err, payload, sender, message_out, sender_out);
+}
+
+DCFError dcf_client_try_receive_message(DCFClient* client, char** message_out, char** sender_out) {
+    if (!client || !message_out || !sender_out) return DCF_ERR_NULL_PTR;
+    const uint8_t* payload;
+    size_t payload_len;
+    const char* sender;
+    DCFError err = dcf_client_try_receive_payload(client, &payload, &payload_len, &sender);
+    return dcf_client_copy_message(err, payload, sender, message_out, sender_out);
+}
+
+static DCFError dcf_client_add_handler(DCFClient* client, DCFMessageHandler fn, DCFPayloadHandler payload_fn, void* user_data) {
+    if (client->handler_count == client->handler_cap) {
+        size_t cap = client->handler_cap ? client->handler_cap * 2 : 4;
+        DCFHandler* handlers = realloc(client->handlers, cap * sizeof(DCFHandler));
+        if (!handlers) return DCF_ERR_MALLOC_FAIL;
+        client->handlers = handlers;
+        client->handler_cap = cap;
+    }
+    client->handlers[client->handler_count].fn = fn;
+    client->handlers[client->handler_count].payload_fn = payload_fn;
+    client->handlers[client->handler_count].user_data = user_data;
+    client->handler_count++;
+    return DCF_SUCCESS;
+}
+
+static DCFError dcf_client_remove_handler(DCFClient* client, DCFMessageHandler fn, DCFPayloadHandler payload_fn, void* user_data) {
+    for (size_t i = 0; i < client->handler_count; i++) {
+        DCFHandler* h = &client->handlers[i];
+        if (h->fn == fn && h->payload_fn == payload_fn && h->user_data == user_data) {
+            memmove(h, h + 1, (client->handler_count - i - 1) * sizeof(DCFHandler));
+            client->handler_count--;
+            return DCF_SUCCESS;
+        }
+    }
+    return DCF_ERR_INVALID_ARG;
+}
+
+DCFError dcf_client_register_handler(DCFClient* client, DCFMessageHandler handler, void* user_data) {
+    if (!client || !handler) return DCF_ERR_NULL_PTR;
+    return dcf_client_add_handler(client, handler, NULL, user_data);
+}
+
+DCFError dcf_client_unregister_handler(DCFClient* client, DCFMessageHandler handler, void* user_data) {
+    if (!client || !handler) return DCF_ERR_NULL_PTR;
+    return dcf_client_remove_handler(client, handler, NULL, user_data);
+}
+
+DCFError dcf_client_register_payload_handler(DCFClient* client, DCFPayloadHandler handler, void* user_data) {
+    if (!client || !handler) return DCF_ERR_NULL_PTR;
+    return dcf_client_add_handler(client, NULL, handler, user_data);
+}
+
+DCFError dcf_client_unregister_payload_handler(DCFClient* client, DCFPayloadHandler handler, void* user_data) {
+    if (!client || !handler) return DCF_ERR_NULL_PTR;
+    return dcf_client_remove_handler(client, NULL, handler, user_data);
+}
+
+int dcf_client_get_fd(DCFClient* client) {
+    if (!client || dcf_plugin_manager_get_transport(client->plugin_mgr)) return -1;
+    return dcf_networking_get_fd(client->networking);
+}
+
+static DCFError dcf_client_dispatch(DCFClient* client, size_t* dispatched) {
+    while (*dispatched < DCF_CLIENT_POLL_BUDGET) {
+        // Handlers see the message in the deserialization arena, copied nowhere
+        const uint8_t* payload;
+        size_t payload_len;
+        const char* sender;
+        DCFError err = dcf_networking_try_receive_payload(client->networking, &payload, &payload_len, &sender);
+        if (err == DCF_ERR_TIMEOUT) return DCF_SUCCESS;
+        if (err != DCF_SUCCESS) return err;
+        dcf_redundancy_heartbeat(client->redundancy, sender);
+        for (size_t i = 0; i < client->handler_count; i++) {
+            DCFHandler* h = &client->handlers[i];
+            // Arena payloads are NUL-terminated, so string handlers read them directly
+            if (h->fn) h->fn(h->user_data, (const char*)payload, sender);
+            else h->payload_fn(h->user_data, payload, payload_len, sender);
+        }
+        (*dispatched)++;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_client_poll(DCFClient* client, int timeout_ms, size_t* dispatched_out) {
+    if (!client) return DCF_ERR_NULL_PTR;
+    if (!client->running) return DCF_ERR_INVALID_STATE;
+    int fd = dcf_client_get_fd(client);
+    if (fd < 0) return DCF_ERR_INVALID_STATE;
+    size_t dispatched = 0;
+    DCFError err = dcf_client_dispatch(client, &dispatched);
+    if (err == DCF_SUCCESS && dispatched == 0 && timeout_ms != 0) {
+        struct epoll_event ev;
+        int n = epoll_wait(fd, &ev, 1, timeout_ms);
+        if (n < 0 && errno != EINTR) err = DCF_ERR_NETWORK_FAIL;
+        else if (n > 0) err = dcf_client_dispatch(client, &dispatched);
+    }
+    if (dispatched_out) *dispatched_out = dispatched;
+    return err;
 }
 
 DCFError dcf_client_set_mode(DCFClient* client, DCFMode mode) {
@@ -142,9 +686,13 @@ DCFError dcf_client_set_log_level(DCFClient* client, int level) {
 
 void dcf_client_free(DCFClient* client) {
     if (!client) return;
+    // Redundancy first: its prober sends through networking until it stops
+    dcf_redundancy_free(client->redundancy);
     dcf_config_free(client->config);
     dcf_networking_free(client->networking);
-    dcf_redundancy_free(client->redundancy);
     dcf_plugin_manager_free(client->plugin_mgr);
+    free(client->handlers);
+    dcf_client_flush_envelopes(client);
+    pthread_mutex_destroy(&client->envelope_mutex);
     free(client);
 }
@@ -0,0 +1,110 @@
+#include "dcf_coordinate.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Gains and bounds from the Vivaldi paper and its height-vector extension
+#define DCF_COORD_CE 0.25f          // error estimate gain
+#define DCF_COORD_CC 0.25f          // position gain
+#define DCF_COORD_MAX_ERROR 1.5f
+#define DCF_COORD_MIN_ERROR 0.001f   // keeps the weight defined between two perfect nodes
+#define DCF_COORD_MIN_HEIGHT_US 10.0f
+#define DCF_COORD_ZERO_US 1.0f      // closer than this, two positions coincide
+#define DCF_COORD_MAX_US 1e8f       // samples and positions past 100 s are garbage
+
+static const uint8_t dcf_coord_magic[4] = { 'D', 'C', 'F', 'V' };
+
+void dcf_coordinate_init(DCFCoordinate* coord) {
+    memset(coord, 0, sizeof(DCFCoordinate));
+    coord->height = DCF_COORD_MIN_HEIGHT_US;
+    coord->error = DCF_COORD_MAX_ERROR;
+}
+
+static float dcf_coordinate_span(const DCFCoordinate* a, const DCFCoordinate* b) {
+    float sum = 0;
+    for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) {
+        float diff = a->vec[d] - b->vec[d];
+        sum += diff * diff;
+    }
+    return sqrtf(sum);
+}
+
+uint32_t dcf_coordinate_distance_us(const DCFCoordinate* a, const DCFCoordinate* b) {
+    float dist = dcf_coordinate_span(a, b) + a->height + b->height;
+    return dist < (float)UINT32_MAX / 2 ? (uint32_t)(dist + 0.5f) : UINT32_MAX / 2;
+}
+
+void dcf_coordinate_update(DCFCoordinate* local, const DCFCoordinate* remote, uint32_t rtt_us, unsigned int* seed) {
+    float rtt = (float)rtt_us;
+    if (rtt <= 0 || rtt > DCF_COORD_MAX_US) return;
+    float span = dcf_coordinate_span(local, remote);
+    float dist = span + local->height + remote->height;
+    // Trust the sample in proportion to how unsure we are relative to the remote
+    float weight = local->error / (local->error + remote->error);
+    float sample_error = fabsf(dist - rtt) / rtt;
+    local->error = sample_error * DCF_COORD_CE * weight + local->error * (1 - DCF_COORD_CE * weight);
+    if (local->error > DCF_COORD_MAX_ERROR) local->error = DCF_COORD_MAX_ERROR;
+    if (local->error < DCF_COORD_MIN_ERROR) local->error = DCF_COORD_MIN_ERROR;
+    float force = DCF_COORD_CC * weight * (rtt - dist);
+    float unit[DCF_COORDINATE_DIMENSIONS];
+    if (span > DCF_COORD_ZERO_US) {
+        for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) unit[d] = (local->vec[d] - remote->vec[d]) / span;
+    } else {
+        // Coincident nodes split in a random direction
+        float norm = 0;
+        for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) {
+            unit[d] = (float)rand_r(seed) / RAND_MAX - 0.5f;
+            norm += unit[d] * unit[d];
+        }
+        norm = sqrtf(norm);
+        for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) unit[d] = norm > 0 ? unit[d] / norm : d == 0;
+    }
+    for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) {
+        local->vec[d] += unit[d] * force;
+        if (local->vec[d] > DCF_COORD_MAX_US) local->vec[d] = DCF_COORD_MAX_US;
+        if (local->vec[d] < -DCF_COORD_MAX_US) local->vec[d] = -DCF_COORD_MAX_US;
+    }
+    if (span > DCF_COORD_ZERO_US) local->height += (local->height + remote->height) * force / span;
+    if (local->height < DCF_COORD_MIN_HEIGHT_US) local->height = DCF_COORD_MIN_HEIGHT_US;
+    if (local->height > DCF_COORD_MAX_US) local->height = DCF_COORD_MAX_US;
+}
+
+static void dcf_coordinate_put(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(bits >> (8 * i));
+}
+
+static float dcf_coordinate_get(const uint8_t* in) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) bits |= (uint32_t)in[i] << (8 * i);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Little-endian floats after the magic: vec, height, error
+void dcf_coordinate_encode(const DCFCoordinate* coord, uint8_t out[DCF_COORDINATE_WIRE_SIZE]) {
+    memcpy(out, dcf_coord_magic, sizeof(dcf_coord_magic));
+    uint8_t* p = out + sizeof(dcf_coord_magic);
+    for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++, p += 4) dcf_coordinate_put(p, coord->vec[d]);
+    dcf_coordinate_put(p, coord->height);
+    dcf_coordinate_put(p + 4, coord->error);
+}
+
+DCFError dcf_coordinate_decode(const uint8_t* buf, size_t len, DCFCoordinate* coord_out) {
+    if (!buf || !coord_out) return DCF_ERR_NULL_PTR;
+    if (len != DCF_COORDINATE_WIRE_SIZE || memcmp(buf, dcf_coord_magic, sizeof(dcf_coord_magic)) != 0) return DCF_ERR_DESERIALIZATION_FAIL;
+    DCFCoordinate coord;
+    const uint8_t* p = buf + sizeof(dcf_coord_magic);
+    for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++, p += 4) coord.vec[d] = dcf_coordinate_get(p);
+    coord.height = dcf_coordinate_get(p);
+    coord.error = dcf_coordinate_get(p + 4);
+    // A peer's bad coordinate must not drag ours somewhere unbounded
+    for (int d = 0; d < DCF_COORDINATE_DIMENSIONS; d++) {
+        if (!(fabsf(coord.vec[d]) <= DCF_COORD_MAX_US)) return DCF_ERR_DESERIALIZATION_FAIL;
+    }
+    if (!(coord.height >= 0 && coord.height <= DCF_COORD_MAX_US) || !(coord.error >= DCF_COORD_MIN_ERROR && coord.error <= DCF_COORD_MAX_ERROR)) return DCF_ERR_DESERIALIZATION_FAIL;
+    *coord_out = coord;
+    return DCF_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "dcf_dedup.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slots a sender may land in from its home slot
+#define DCF_DEDUP_PROBE 8
+#define DCF_DEDUP_WORDS (DCF_DEDUP_WINDOW / 64)
+
+// Bit sequence % DCF_DEDUP_WINDOW is set once that sequence number arrived;
+// only newest and the DCF_DEDUP_WINDOW - 1 numbers below it are meaningful
+typedef struct {
+    uint8_t* sender;        // NULL for a free slot
+    size_t sender_len;
+    uint32_t hash;
+    uint32_t newest;
+    uint64_t last_used;
+    uint64_t seen[DCF_DEDUP_WORDS];
+} DCFDedupSender;
+
+struct DCFDedup {
+    pthread_mutex_t mutex;
+    uint64_t clock;         // bumped per accept call, for least-recently-used eviction
+    DCFDedupSender senders[DCF_DEDUP_SENDERS];
+};
+
+static uint32_t dcf_dedup_hash(const uint8_t* s, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) hash = (hash ^ s[i]) * 16777619u;
+    return hash;
+}
+
+DCFDedup* dcf_dedup_new(void) {
+    DCFDedup* dedup = calloc(1, sizeof(DCFDedup));
+    if (!dedup) return NULL;
+    pthread_mutex_init(&dedup->mutex, NULL);
+    return dedup;
+}
+
+static bool dcf_dedup_test_and_set(DCFDedupSender* entry, uint32_t sequence) {
+    uint64_t* word = &entry->seen[(sequence % DCF_DEDUP_WINDOW) / 64];
+    uint64_t bit = UINT64_C(1) << (sequence % 64);
+    bool seen = *word & bit;
+    *word |= bit;
+    return seen;
+}
+
+static void dcf_dedup_restart(DCFDedupSender* entry, uint32_t sequence) {
+    memset(entry->seen, 0, sizeof(entry->seen));
+    entry->newest = sequence;
+    dcf_dedup_test_and_set(entry, sequence);
+}
+
+// The sender's slot, claiming a free or the stalest nearby one when it is new;
+// NULL only when out of memory
+static DCFDedupSender* dcf_dedup_slot(DCFDedup* dedup, const uint8_t* sender, size_t sender_len, uint32_t sequence) {
+    uint32_t hash = dcf_dedup_hash(sender, sender_len);
+    DCFDedupSender* victim = NULL;
+    for (uint32_t i = 0; i < DCF_DEDUP_PROBE; i++) {
+        DCFDedupSender* entry = &dedup->senders[(hash + i) % DCF_DEDUP_SENDERS];
+        if (entry->sender && entry->hash == hash && entry->sender_len == sender_len && memcmp(entry->sender, sender, sender_len) == 0) return entry;
+        if (!entry->sender) {
+            if (!victim || victim->sender) victim = entry;
+        } else if (!victim || (victim->sender && entry->last_used < victim->last_used)) {
+            victim = entry;
+        }
+    }
+    uint8_t* key = malloc(sender_len ? sender_len : 1);
+    if (!key) return NULL;
+    memcpy(key, sender, sender_len);
+    free(victim->sender);
+    victim->sender = key;
+    victim->sender_len = sender_len;
+    victim->hash = hash;
+    // Nothing from a new sender has been seen, so its first number only slides the window
+    memset(victim->seen, 0, sizeof(victim->seen));
+    victim->newest = sequence - 1;
+    return victim;
+}
+
+bool dcf_dedup_accept(DCFDedup* dedup, const uint8_t* sender, size_t sender_len, uint32_t sequence) {
+    if (!dedup || (!sender && sender_len)) return true;
+    pthread_mutex_lock(&dedup->mutex);
+    DCFDedupSender* entry = dcf_dedup_slot(dedup, sender, sender_len, sequence);
+    bool accept = true;
+    if (entry) {
+        entry->last_used = ++dedup->clock;
+        int32_t ahead = (int32_t)(sequence - entry->newest);
+        if (ahead > 0) {
+            // Slide the window up, forgetting the numbers it moves past
+            if (ahead >= DCF_DEDUP_WINDOW) {
+                memset(entry->seen, 0, sizeof(entry->seen));
+            } else {
+                for (uint32_t i = 1; i <= (uint32_t)ahead; i++) {
+                    uint32_t s = entry->newest + i;
+                    entry->seen[(s % DCF_DEDUP_WINDOW) / 64] &= ~(UINT64_C(1) << (s % 64));
+                }
+            }
+            entry->newest = sequence;
+            dcf_dedup_test_and_set(entry, sequence);
+        } else if (ahead > -DCF_DEDUP_WINDOW) {
+            accept = !dcf_dedup_test_and_set(entry, sequence);
+        } else {
+            dcf_dedup_restart(entry, sequence);
+        }
+    }
+    pthread_mutex_unlock(&dedup->mutex);
+    return accept;
+}
+
+void dcf_dedup_free(DCFDedup* dedup) {
+    if (!dedup) return;
+    for (size_t i = 0; i < DCF_DEDUP_SENDERS; i++) free(dedup->senders[i].sender);
+    pthread_mutex_destroy(&dedup->mutex);
+    free(dedup);
+}
@@ -17,6 +17,8 @@ const char* dcf_error_str(DCFError err) {
         case DCF_ERR_INVALID_ARG: return "Invalid argument";
         case DCF_ERR_CONFIG_UPDATE_FAIL: return "Configuration update failed";
         case DCF_ERR_UNKNOWN: return "Unknown error";
+        case DCF_ERR_TIMEOUT: return "Operation timed out";
+        case DCF_ERR_BUSY: return "Too many operations in flight";
     }
     return "Unknown error";
 }
@@ -0,0 +1,103 @@
+#include "dcf_histogram.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 2048 sub-buckets per power of two give three significant digits. Bucket 0
+// holds 0..2047 exactly; bucket b > 0 holds [1024 << b, 2048 << b) in steps
+// of 1 << b, so index = b * 1024 + (value >> b) covers every bucket without gaps.
+#define DCF_HISTOGRAM_SUB_BITS 11
+#define DCF_HISTOGRAM_HALF (1u << (DCF_HISTOGRAM_SUB_BITS - 1))
+#define DCF_HISTOGRAM_BUCKETS (36 - DCF_HISTOGRAM_SUB_BITS + 1)
+#define DCF_HISTOGRAM_COUNTS ((DCF_HISTOGRAM_BUCKETS + 1) * DCF_HISTOGRAM_HALF)
+
+struct DCFHistogram {
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+    uint64_t counts[DCF_HISTOGRAM_COUNTS];
+};
+
+static size_t dcf_histogram_index(uint64_t value) {
+    int bucket = 64 - __builtin_clzll(value | ((1u << DCF_HISTOGRAM_SUB_BITS) - 1)) - DCF_HISTOGRAM_SUB_BITS;
+    return (size_t)bucket * DCF_HISTOGRAM_HALF + (size_t)(value >> bucket);
+}
+
+// Highest value that maps to the same slot as index
+static uint64_t dcf_histogram_value(size_t index) {
+    int bucket = index < 2 * DCF_HISTOGRAM_HALF ? 0 : (int)(index / DCF_HISTOGRAM_HALF) - 1;
+    uint64_t sub = index - (size_t)bucket * DCF_HISTOGRAM_HALF;
+    return ((sub + 1) << bucket) - 1;
+}
+
+DCFHistogram* dcf_histogram_new(void) {
+    DCFHistogram* histogram = calloc(1, sizeof(DCFHistogram));
+    if (!histogram) return NULL;
+    histogram->min = UINT64_MAX;
+    return histogram;
+}
+
+void dcf_histogram_record(DCFHistogram* histogram, uint64_t value) {
+    if (!histogram) return;
+    if (value > DCF_HISTOGRAM_MAX_VALUE) value = DCF_HISTOGRAM_MAX_VALUE;
+    histogram->counts[dcf_histogram_index(value)]++;
+    histogram->total++;
+    histogram->sum += (double)value;
+    if (value < histogram->min) histogram->min = value;
+    if (value > histogram->max) histogram->max = value;
+}
+
+DCFError dcf_histogram_merge(DCFHistogram* into, const DCFHistogram* from) {
+    if (!into || !from) return DCF_ERR_NULL_PTR;
+    for (size_t i = 0; i < DCF_HISTOGRAM_COUNTS; i++) into->counts[i] += from->counts[i];
+    into->total += from->total;
+    into->sum += from->sum;
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+    return DCF_SUCCESS;
+}
+
+void dcf_histogram_reset(DCFHistogram* histogram) {
+    if (!histogram) return;
+    memset(histogram, 0, sizeof(DCFHistogram));
+    histogram->min = UINT64_MAX;
+}
+
+uint64_t dcf_histogram_count(const DCFHistogram* histogram) {
+    return histogram ? histogram->total : 0;
+}
+
+uint64_t dcf_histogram_min(const DCFHistogram* histogram) {
+    return histogram && histogram->total ? histogram->min : 0;
+}
+
+uint64_t dcf_histogram_max(const DCFHistogram* histogram) {
+    return histogram ? histogram->max : 0;
+}
+
+double dcf_histogram_mean(const DCFHistogram* histogram) {
+    return histogram && histogram->total ? histogram->sum / histogram->total : 0;
+}
+
+uint64_t dcf_histogram_percentile(const DCFHistogram* histogram, double percentile) {
+    if (!histogram || !histogram->total) return 0;
+    if (percentile > 100) percentile = 100;
+    // The rank of the value wanted, rounded up and at least the first one
+    double exact = percentile / 100 * histogram->total;
+    uint64_t rank = (uint64_t)exact;
+    if (rank < exact || rank < 1) rank++;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < DCF_HISTOGRAM_COUNTS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t value = dcf_histogram_value(i);
+            // Report no more than was actually recorded
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void dcf_histogram_free(DCFHistogram* histogram) {
+    free(histogram);
+}
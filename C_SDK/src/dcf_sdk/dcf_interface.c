@@ -1,5 +1,7 @@
 #include "dcf_interface.h"
+#include "dcf_loadgen.h"
 #include <cjson/cJSON.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -8,6 +10,102 @@
 
 static const char* DCF_VERSION = "5.0.0";
 
+// Latency percentiles reported by benchmark, HdrHistogram style
+static const double DCF_BENCHMARK_PERCENTILES[] = {50, 90, 99, 99.9};
+static const char* const DCF_BENCHMARK_PERCENTILE_KEYS[] = {"p50", "p90", "p99", "p99_9"};
+
+// Appends to a buffer of *cap bytes holding *len, doubling it when the text doesn't fit
+static DCFError dcf_interface_appendf(char** buf, size_t* cap, size_t* len, const char* fmt, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(*buf + *len, *cap - *len, fmt, args);
+        va_end(args);
+        if (n < 0) return DCF_ERR_INVALID_ARG;
+        if ((size_t)n < *cap - *len) {
+            *len += n;
+            return DCF_SUCCESS;
+        }
+        size_t grown = *cap * 2 > *len + n + 1 ? *cap * 2 : *len + n + 1;
+        char* bigger = realloc(*buf, grown);
+        if (!bigger) return DCF_ERR_MALLOC_FAIL;
+        *buf = bigger;
+        *cap = grown;
+    }
+}
+
+// benchmark peer[,peer...] [concurrency=N] [size=BYTES] [rate=MSGS_PER_S] [duration=S] [timeout=MS]
+static DCFError dcf_interface_benchmark(DCFClient* client, const char** args, int arg_count, char* result, cJSON* json) {
+    DCFLoadOptions options = { .concurrency = 1, .message_size = 64, .rate = 0, .duration_s = 10, .timeout_ms = 1000 };
+    for (int i = 1; i < arg_count; i++) {
+        const char* eq = strchr(args[i], '=');
+        if (!eq) return DCF_ERR_INVALID_ARG;
+        size_t key_len = eq - args[i];
+        const char* value = eq + 1;
+        if (key_len == 11 && strncmp(args[i], "concurrency", 11) == 0) options.concurrency = atoi(value);
+        else if (key_len == 4 && strncmp(args[i], "size", 4) == 0) options.message_size = strtoul(value, NULL, 10);
+        else if (key_len == 4 && strncmp(args[i], "rate", 4) == 0) options.rate = atof(value);
+        else if (key_len == 8 && strncmp(args[i], "duration", 8) == 0) options.duration_s = atof(value);
+        else if (key_len == 7 && strncmp(args[i], "timeout", 7) == 0) options.timeout_ms = atoi(value);
+        else return DCF_ERR_INVALID_ARG;
+    }
+    if (options.concurrency < 1 || options.message_size < 1 || options.rate < 0 || options.duration_s <= 0 || options.timeout_ms <= 0) return DCF_ERR_INVALID_ARG;
+    // The peer set is a comma-separated list
+    char* peer_list = strdup(args[0]);
+    if (!peer_list) return DCF_ERR_MALLOC_FAIL;
+    size_t peer_cap = 1;
+    for (const char* c = peer_list; *c; c++) peer_cap += *c == ',';
+    const char** peers = calloc(peer_cap, sizeof(char*));
+    if (!peers) {
+        free(peer_list);
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    char* save;
+    for (char* peer = strtok_r(peer_list, ",", &save); peer; peer = strtok_r(NULL, ",", &save)) peers[options.peer_count++] = peer;
+    options.peers = peers;
+    DCFLoadReport report;
+    DCFError err = dcf_loadgen_run(client, &options, &report);
+    if (err == DCF_SUCCESS) {
+        uint64_t percentiles[4];
+        for (int i = 0; i < 4; i++) percentiles[i] = dcf_histogram_percentile(report.latency_ns, DCF_BENCHMARK_PERCENTILES[i]);
+        uint64_t max = dcf_histogram_max(report.latency_ns);
+        uint64_t error_p50 = dcf_histogram_percentile(report.error_latency_ns, 50.0);
+        uint64_t error_max = dcf_histogram_max(report.error_latency_ns);
+        int len = snprintf(result, 4096, "Benchmark %s: %d threads, %zu bytes, %s\n"
+                           "Sent %llu (%llu errors) in %.2f s: %.1f msg/s\n"
+                           "Latency us: p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f",
+                           args[0], options.concurrency, options.message_size, options.rate > 0 ? "open loop" : "closed loop",
+                           (unsigned long long)report.sent, (unsigned long long)report.errors, report.elapsed_s, report.throughput,
+                           percentiles[0] / 1e3, percentiles[1] / 1e3, percentiles[2] / 1e3, percentiles[3] / 1e3, max / 1e3);
+        if (report.errors && len > 0 && len < 4096) {
+            snprintf(result + len, 4096 - len, "\nFailed after us: p50 %.1f, max %.1f", error_p50 / 1e3, error_max / 1e3);
+        }
+        if (json) {
+            cJSON* peer_array = cJSON_AddArrayToObject(json, "peers");
+            for (size_t i = 0; i < options.peer_count; i++) cJSON_AddItemToArray(peer_array, cJSON_CreateString(peers[i]));
+            cJSON_AddNumberToObject(json, "concurrency", options.concurrency);
+            cJSON_AddNumberToObject(json, "message_size", options.message_size);
+            cJSON_AddNumberToObject(json, "target_rate", options.rate);
+            cJSON_AddNumberToObject(json, "duration_s", report.elapsed_s);
+            cJSON_AddNumberToObject(json, "sent", report.sent);
+            cJSON_AddNumberToObject(json, "errors", report.errors);
+            cJSON_AddNumberToObject(json, "throughput", report.throughput);
+            cJSON* latency = cJSON_AddObjectToObject(json, "latency_us");
+            for (int i = 0; i < 4; i++) cJSON_AddNumberToObject(latency, DCF_BENCHMARK_PERCENTILE_KEYS[i], percentiles[i] / 1e3);
+            cJSON_AddNumberToObject(latency, "max", max / 1e3);
+            cJSON_AddNumberToObject(latency, "mean", dcf_histogram_mean(report.latency_ns) / 1e3);
+            cJSON* error_latency = cJSON_AddObjectToObject(json, "error_latency_us");
+            cJSON_AddNumberToObject(error_latency, "p50", error_p50 / 1e3);
+            cJSON_AddNumberToObject(error_latency, "max", error_max / 1e3);
+        }
+        dcf_histogram_free(report.latency_ns);
+        dcf_histogram_free(report.error_latency_ns);
+    }
+    free(peers);
+    free(peer_list);
+    return err;
+}
+
 DCFError dcf_interface_execute(DCFClient* client, DCFCmd cmd, const char** args, int arg_count, bool json_output, char** output) {
     if (!client || !output) return DCF_ERR_NULL_PTR;
     *output = NULL;
@@ -108,28 +206,35 @@ DCFError dcf_interface_execute(DCFClient* client, DCFCmd cmd, const char** args,
             }
             break;
         case DCF_CMD_LIST_PEERS: {
-            char** peers;
-            size_t peer_count;
-            if (dcf_config_get_peers(client->config, &peers, &peer_count) == DCF_SUCCESS) {
-                char* ptr = result;
-                ptr += snprintf(ptr, 4096, "Peers (%zu):\n", peer_count);
-                if (json) cJSON_AddArrayToObject(json, "peers");
-                for (size_t i = 0; i < peer_count; i++) {
-                    int rtt;
-                    dcf_redundancy_health_check(client->redundancy, peers[i], &rtt);
-                    ptr += snprintf(ptr, 4096 - (ptr - result), "%s (RTT: %d ms, Group: %s)\n", peers[i], rtt, client->redundancy->groups[i]);
-                    if (json) {
-                        cJSON* peer = cJSON_CreateObject();
-                        cJSON_AddStringToObject(peer, "address", peers[i]);
-                        cJSON_AddNumberToObject(peer, "rtt", rtt);
-                        cJSON_AddStringToObject(peer, "group", client->redundancy->groups[i]);
-                        cJSON_AddItemToArray(cJSON_GetObjectItem(json, "peers"), peer);
-                    }
-                    free(peers[i]);
+            // Walks the peer table by id and reports the prober's cached statistics,
+            // so listing never waits on the network
+            size_t peer_count = dcf_redundancy_peer_count(client->redundancy);
+            size_t result_cap = 4096;
+            size_t result_len = 0;
+            err = dcf_interface_appendf(&result, &result_cap, &result_len, "Peers (%zu):\n", peer_count);
+            if (json) cJSON_AddArrayToObject(json, "peers");
+            for (DCFPeerId id = 0; err == DCF_SUCCESS && id < peer_count; id++) {
+                const char* address = dcf_redundancy_peer_address(client->redundancy, id);
+                DCFPeerStats stats = { .srtt_us = DCF_RTT_UNKNOWN, .min_rtt_us = DCF_RTT_UNKNOWN };
+                if (!address || dcf_redundancy_get_peer_stats_id(client->redundancy, id, &stats) != DCF_SUCCESS) continue;
+                const char* group = stats.group ? stats.group : "unknown";
+                double srtt_ms = stats.srtt_us < DCF_RTT_UNKNOWN ? stats.srtt_us / 1e3 : -1;
+                int rtt = stats.srtt_us < DCF_RTT_UNKNOWN ? (int)((stats.srtt_us + 500) / 1000) : -1;
+                err = dcf_interface_appendf(&result, &result_cap, &result_len, "%s (RTT: %d ms, Smoothed: %.2f ms, Jitter: %.2f ms, Loss: %.0f%%, Group: %s)\n",
+                                            address, rtt, srtt_ms, stats.rttvar_us / 1e3, stats.loss_rate * 100, group);
+                if (json) {
+                    cJSON* peer = cJSON_CreateObject();
+                    cJSON_AddStringToObject(peer, "address", address);
+                    cJSON_AddNumberToObject(peer, "rtt", rtt);
+                    cJSON_AddNumberToObject(peer, "srtt_ms", srtt_ms);
+                    cJSON_AddNumberToObject(peer, "jitter_ms", stats.rttvar_us / 1e3);
+                    cJSON_AddNumberToObject(peer, "min_rtt_ms", stats.min_rtt_us < DCF_RTT_UNKNOWN ? stats.min_rtt_us / 1e3 : -1);
+                    cJSON_AddNumberToObject(peer, "loss_rate", stats.loss_rate);
+                    cJSON_AddStringToObject(peer, "group", group);
+                    cJSON_AddNumberToObject(peer, "phi", stats.phi);
+                    cJSON_AddBoolToObject(peer, "suspected", stats.suspected);
+                    cJSON_AddItemToArray(cJSON_GetObjectItem(json, "peers"), peer);
                 }
-                free(peers);
-            } else {
-                err = DCF_ERR_CONFIG_INVALID;
             }
             break;
         }
@@ -156,19 +261,7 @@ DCFError dcf_interface_execute(DCFClient* client, DCFCmd cmd, const char** args,
                 err = DCF_ERR_INVALID_ARG;
                 break;
             }
-            clock_t start = clock();
-            int rtt;
-            err = dcf_redundancy_health_check(client->redundancy, args[0], &rtt);
-            clock_t end = clock();
-            if (err == DCF_SUCCESS) {
-                double ms = ((double)(end - start) * 1000) / CLOCKS_PER_SEC;
-                snprintf(result, 4096, "Benchmark RTT to %s: %d ms, Execution: %.2f ms", args[0], rtt, ms);
-                if (json) {
-                    cJSON_AddStringToObject(json, "peer", args[0]);
-                    cJSON_AddNumberToObject(json, "rtt", rtt);
-                    cJSON_AddNumberToObject(json, "execution_ms", ms);
-                }
-            }
+            err = dcf_interface_benchmark(client, args, arg_count, result, json);
             break;
         case DCF_CMD_GROUP_PEERS:
             err = dcf_redundancy_group_peers(client->redundancy);
@@ -0,0 +1,304 @@
+#define _GNU_SOURCE
+#include "dcf_io_backend.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#ifdef DCF_HAVE_IO_URING
+#include <liburing.h>
+#endif
+
+// Receive buffers; the io_uring backend registers all of them as a provided-buffer ring
+#define DCF_IO_BUF_SIZE 65536
+#define DCF_IO_BUF_COUNT 256
+#define DCF_IO_BUF_GROUP 0
+#define DCF_IO_RING_ENTRIES 512
+#define DCF_IO_SEND_BATCH 32
+#define DCF_IO_EPOLL_EVENTS 64
+
+// Set in an epoll event or recv tag alongside the fd when it is a stream socket,
+// where a zero-length read means the peer closed rather than an empty datagram
+#define DCF_IO_STREAM_BIT (1ULL << 32)
+
+struct DCFIoBackend {
+    DCFIoBackendType type;
+    uint8_t* buffers;
+    int epoll_fd;
+    struct epoll_event events[DCF_IO_EPOLL_EVENTS];
+    int event_count;
+    int event_pos;
+#ifdef DCF_HAVE_IO_URING
+    // Receives and sends use separate rings, so a receiver blocked on its ring
+    // never reaps a sender's completions and senders need not wait on it
+    struct io_uring ring;
+    struct io_uring_buf_ring* buf_ring;
+    int held_bid;  // buffer lent to the caller, handed back to the kernel on the next receive
+    struct io_uring send_ring;
+    pthread_mutex_t send_mutex;  // one send_batch on send_ring at a time
+#endif
+};
+
+static bool dcf_io_is_stream(int fd) {
+    int type;
+    socklen_t len = sizeof(type);
+    return getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) == 0 && type == SOCK_STREAM;
+}
+
+#ifdef DCF_HAVE_IO_URING
+static bool dcf_io_uring_init(DCFIoBackend* backend) {
+    if (io_uring_queue_init(DCF_IO_RING_ENTRIES, &backend->ring, 0) != 0) return false;
+    int ret;
+    backend->buf_ring = io_uring_setup_buf_ring(&backend->ring, DCF_IO_BUF_COUNT, DCF_IO_BUF_GROUP, 0, &ret);
+    if (!backend->buf_ring) {
+        // Provided-buffer rings need Linux 5.19+
+        io_uring_queue_exit(&backend->ring);
+        return false;
+    }
+    if (io_uring_queue_init(DCF_IO_RING_ENTRIES, &backend->send_ring, 0) != 0) {
+        io_uring_free_buf_ring(&backend->ring, backend->buf_ring, DCF_IO_BUF_COUNT, DCF_IO_BUF_GROUP);
+        io_uring_queue_exit(&backend->ring);
+        return false;
+    }
+    pthread_mutex_init(&backend->send_mutex, NULL);
+    int mask = io_uring_buf_ring_mask(DCF_IO_BUF_COUNT);
+    for (int i = 0; i < DCF_IO_BUF_COUNT; i++) {
+        io_uring_buf_ring_add(backend->buf_ring, backend->buffers + (size_t)i * DCF_IO_BUF_SIZE, DCF_IO_BUF_SIZE, i, mask, i);
+    }
+    io_uring_buf_ring_advance(backend->buf_ring, DCF_IO_BUF_COUNT);
+    backend->held_bid = -1;
+    return true;
+}
+
+static void dcf_io_uring_recycle(DCFIoBackend* backend, int bid) {
+    io_uring_buf_ring_add(backend->buf_ring, backend->buffers + (size_t)bid * DCF_IO_BUF_SIZE, DCF_IO_BUF_SIZE, bid, io_uring_buf_ring_mask(DCF_IO_BUF_COUNT), 0);
+    io_uring_buf_ring_advance(backend->buf_ring, 1);
+}
+
+static DCFError dcf_io_uring_arm_recv(DCFIoBackend* backend, uint64_t tag) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&backend->ring);
+    if (!sqe) {
+        io_uring_submit(&backend->ring);
+        sqe = io_uring_get_sqe(&backend->ring);
+        if (!sqe) return DCF_ERR_NETWORK_FAIL;
+    }
+    io_uring_prep_recv_multishot(sqe, (int)(uint32_t)tag, NULL, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = DCF_IO_BUF_GROUP;
+    io_uring_sqe_set_data64(sqe, tag);
+    return io_uring_submit(&backend->ring) >= 0 ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+}
+
+static DCFError dcf_io_uring_send_batch_locked(DCFIoBackend* backend, int fd, struct msghdr* msgs, size_t count, DCFError* results_out, size_t* sent_out) {
+    for (size_t done = 0; done < count;) {
+        size_t chunk = 0;
+        struct io_uring_sqe* sqe;
+        while (done + chunk < count && chunk < DCF_IO_RING_ENTRIES && (sqe = io_uring_get_sqe(&backend->send_ring))) {
+            io_uring_prep_sendmsg(sqe, fd, &msgs[done + chunk], 0);
+            io_uring_sqe_set_data64(sqe, done + chunk);
+            chunk++;
+        }
+        if (chunk == 0 || io_uring_submit(&backend->send_ring) < 0) return DCF_ERR_NETWORK_FAIL;
+        // Every submitted send must be reaped before the ring is reused, even after an error
+        for (size_t completed = 0; completed < chunk;) {
+            struct io_uring_cqe* cqe;
+            int ret = io_uring_wait_cqe(&backend->send_ring, &cqe);
+            if (ret == -EINTR) continue;
+            if (ret < 0) return DCF_ERR_NETWORK_FAIL;
+            // Completions arrive in any order; user_data says whose each one is
+            size_t index = (size_t)io_uring_cqe_get_data64(cqe);
+            if (cqe->res >= 0) (*sent_out)++;
+            if (results_out && index < count) results_out[index] = cqe->res >= 0 ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+            completed++;
+            io_uring_cqe_seen(&backend->send_ring, cqe);
+        }
+        done += chunk;
+    }
+    return *sent_out == count ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+}
+
+static DCFError dcf_io_uring_send_batch(DCFIoBackend* backend, int fd, struct msghdr* msgs, size_t count, DCFError* results_out, size_t* sent_out) {
+    pthread_mutex_lock(&backend->send_mutex);
+    DCFError err = dcf_io_uring_send_batch_locked(backend, fd, msgs, count, results_out, sent_out);
+    pthread_mutex_unlock(&backend->send_mutex);
+    return err;
+}
+
+static DCFError dcf_io_uring_receive(DCFIoBackend* backend, int timeout_ms, int* fd_out, const uint8_t** data_out, size_t* len_out) {
+    if (backend->held_bid >= 0) {
+        dcf_io_uring_recycle(backend, backend->held_bid);
+        backend->held_bid = -1;
+    }
+    while (true) {
+        struct io_uring_cqe* cqe;
+        int ret;
+        if (timeout_ms < 0) {
+            ret = io_uring_wait_cqe(&backend->ring, &cqe);
+        } else {
+            struct __kernel_timespec ts = { .tv_sec = timeout_ms / 1000, .tv_nsec = (timeout_ms % 1000) * 1000000L };
+            ret = io_uring_wait_cqe_timeout(&backend->ring, &cqe, &ts);
+        }
+        if (ret == -ETIME) return DCF_ERR_TIMEOUT;
+        if (ret == -EINTR) continue;
+        if (ret < 0) return DCF_ERR_NETWORK_FAIL;
+        uint64_t tag = io_uring_cqe_get_data64(cqe);
+        int fd = (int)(uint32_t)tag;
+        int res = cqe->res;
+        uint32_t flags = cqe->flags;
+        io_uring_cqe_seen(&backend->ring, cqe);
+        bool more = flags & IORING_CQE_F_MORE;
+        if (res == 0 && !more && (tag & DCF_IO_STREAM_BIT)) {
+            // Stream peer closed; the multishot recv is finished for good
+            if (flags & IORING_CQE_F_BUFFER) dcf_io_uring_recycle(backend, flags >> IORING_CQE_BUFFER_SHIFT);
+            *fd_out = fd;
+            *data_out = NULL;
+            *len_out = 0;
+            return DCF_SUCCESS;
+        }
+        // A multishot recv ends when buffers run out or the kernel only supports single shot; re-arm it
+        if (!more && (res >= 0 || res == -ENOBUFS || res == -EINVAL || res == -EINTR)) {
+            dcf_io_uring_arm_recv(backend, tag);
+        }
+        if (res < 0 || !(flags & IORING_CQE_F_BUFFER)) continue;
+        // Zero-length datagrams are delivered like any other
+        backend->held_bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        *fd_out = fd;
+        *data_out = backend->buffers + (size_t)backend->held_bid * DCF_IO_BUF_SIZE;
+        *len_out = res;
+        return DCF_SUCCESS;
+    }
+}
+#endif
+
+DCFIoBackend* dcf_io_backend_new(DCFIoBackendType preferred) {
+    DCFIoBackend* backend = calloc(1, sizeof(DCFIoBackend));
+    if (!backend) return NULL;
+    backend->epoll_fd = -1;
+    backend->buffers = malloc((size_t)DCF_IO_BUF_COUNT * DCF_IO_BUF_SIZE);
+    if (!backend->buffers) {
+        free(backend);
+        return NULL;
+    }
+#ifdef DCF_HAVE_IO_URING
+    if (preferred == DCF_IO_BACKEND_IO_URING && dcf_io_uring_init(backend)) {
+        backend->type = DCF_IO_BACKEND_IO_URING;
+        return backend;
+    }
+#else
+    (void)preferred;
+#endif
+    backend->type = DCF_IO_BACKEND_EPOLL;
+    backend->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (backend->epoll_fd < 0) {
+        free(backend->buffers);
+        free(backend);
+        return NULL;
+    }
+    return backend;
+}
+
+DCFIoBackendType dcf_io_backend_get_type(DCFIoBackend* backend) {
+    if (!backend) return DCF_IO_BACKEND_EPOLL;
+    return backend->type;
+}
+
+int dcf_io_backend_get_fd(DCFIoBackend* backend) {
+    if (!backend) return -1;
+#ifdef DCF_HAVE_IO_URING
+    if (backend->type == DCF_IO_BACKEND_IO_URING) return backend->ring.ring_fd;
+#endif
+    return backend->epoll_fd;
+}
+
+const char* dcf_io_backend_name(DCFIoBackendType type) {
+    return type == DCF_IO_BACKEND_IO_URING ? "io_uring" : "epoll";
+}
+
+DCFError dcf_io_backend_watch(DCFIoBackend* backend, int fd) {
+    if (!backend) return DCF_ERR_NULL_PTR;
+    if (fd < 0) return DCF_ERR_INVALID_ARG;
+    uint64_t tag = (uint32_t)fd | (dcf_io_is_stream(fd) ? DCF_IO_STREAM_BIT : 0);
+#ifdef DCF_HAVE_IO_URING
+    if (backend->type == DCF_IO_BACKEND_IO_URING) return dcf_io_uring_arm_recv(backend, tag);
+#endif
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = tag };
+    if (epoll_ctl(backend->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) return DCF_ERR_NETWORK_FAIL;
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_io_backend_send_batch(DCFIoBackend* backend, int fd, struct msghdr* msgs, size_t count, DCFError* results_out, size_t* sent_out) {
+    if (!backend || !msgs || !sent_out) return DCF_ERR_NULL_PTR;
+    *sent_out = 0;
+    // Messages that never complete, or are never tried, count as failed
+    if (results_out) for (size_t i = 0; i < count; i++) results_out[i] = DCF_ERR_NETWORK_FAIL;
+#ifdef DCF_HAVE_IO_URING
+    if (backend->type == DCF_IO_BACKEND_IO_URING) return dcf_io_uring_send_batch(backend, fd, msgs, count, results_out, sent_out);
+#endif
+    struct mmsghdr batch[DCF_IO_SEND_BATCH];
+    while (*sent_out < count) {
+        size_t chunk = count - *sent_out;
+        if (chunk > DCF_IO_SEND_BATCH) chunk = DCF_IO_SEND_BATCH;
+        for (size_t i = 0; i < chunk; i++) {
+            batch[i].msg_hdr = msgs[*sent_out + i];
+            batch[i].msg_len = 0;
+        }
+        int n = sendmmsg(fd, batch, chunk, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return DCF_ERR_NETWORK_FAIL;
+        }
+        if (results_out) for (int i = 0; i < n; i++) results_out[*sent_out + i] = DCF_SUCCESS;
+        *sent_out += n;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_io_backend_receive(DCFIoBackend* backend, int timeout_ms, int* fd_out, const uint8_t** data_out, size_t* len_out) {
+    if (!backend || !fd_out || !data_out || !len_out) return DCF_ERR_NULL_PTR;
+#ifdef DCF_HAVE_IO_URING
+    if (backend->type == DCF_IO_BACKEND_IO_URING) return dcf_io_uring_receive(backend, timeout_ms, fd_out, data_out, len_out);
+#endif
+    while (true) {
+        // Drain each readable fd before waiting again
+        while (backend->event_pos < backend->event_count) {
+            uint64_t tag = backend->events[backend->event_pos].data.u64;
+            int fd = (int)(uint32_t)tag;
+            bool stream = tag & DCF_IO_STREAM_BIT;
+            ssize_t n = recv(fd, backend->buffers, DCF_IO_BUF_SIZE, MSG_DONTWAIT);
+            if (n < 0 && errno == EINTR) continue;
+            // A zero-length read is EOF only on a stream; on UDP it is an empty datagram
+            bool eof = n == 0 && stream;
+            if (n < 0 || eof) backend->event_pos++;
+            if (n < 0) continue;
+            if (eof) epoll_ctl(backend->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            *fd_out = fd;
+            *data_out = eof ? NULL : backend->buffers;
+            *len_out = n;
+            return DCF_SUCCESS;
+        }
+        int n = epoll_wait(backend->epoll_fd, backend->events, DCF_IO_EPOLL_EVENTS, timeout_ms);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return DCF_ERR_NETWORK_FAIL;
+        }
+        if (n == 0) return DCF_ERR_TIMEOUT;
+        backend->event_count = n;
+        backend->event_pos = 0;
+    }
+}
+
+void dcf_io_backend_free(DCFIoBackend* backend) {
+    if (!backend) return;
+#ifdef DCF_HAVE_IO_URING
+    if (backend->type == DCF_IO_BACKEND_IO_URING) {
+        io_uring_free_buf_ring(&backend->ring, backend->buf_ring, DCF_IO_BUF_COUNT, DCF_IO_BUF_GROUP);
+        io_uring_queue_exit(&backend->ring);
+        io_uring_queue_exit(&backend->send_ring);
+        pthread_mutex_destroy(&backend->send_mutex);
+    }
+#endif
+    if (backend->epoll_fd >= 0) close(backend->epoll_fd);
+    free(backend->buffers);
+    free(backend);
+}
@@ -0,0 +1,131 @@
+#include "dcf_loadgen.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    DCFClient* client;
+    const DCFLoadOptions* options;
+    const char* message;
+    size_t message_len;
+    int timeout_ms;
+    uint64_t end_ns;
+    uint64_t first_ns;      // this thread's first scheduled send
+    uint64_t interval_ns;   // 0 in closed loop
+    size_t peer_offset;
+    DCFHistogram* latency;
+    DCFHistogram* error_latency;
+    uint64_t sent;
+    uint64_t errors;
+} DCFLoadWorker;
+
+static uint64_t dcf_loadgen_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void dcf_loadgen_sleep_until(uint64_t when_ns) {
+    struct timespec ts = { .tv_sec = when_ns / 1000000000u, .tv_nsec = when_ns % 1000000000u };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {}
+}
+
+static void* dcf_loadgen_worker(void* arg) {
+    DCFLoadWorker* worker = arg;
+    const DCFLoadOptions* options = worker->options;
+    uint64_t scheduled = worker->first_ns;
+    for (uint64_t i = 0;; i++) {
+        uint64_t begin;
+        if (worker->interval_ns) {
+            // A late thread sends immediately, but still measures from when it was due
+            if (scheduled >= worker->end_ns) break;
+            if (dcf_loadgen_now() < scheduled) dcf_loadgen_sleep_until(scheduled);
+            begin = scheduled;
+            scheduled += worker->interval_ns;
+        } else {
+            begin = dcf_loadgen_now();
+            if (begin >= worker->end_ns) break;
+        }
+        const char* peer = options->peers[(worker->peer_offset + i) % options->peer_count];
+        const uint8_t* response;
+        size_t response_len;
+        if (dcf_client_send_payload_timeout(worker->client, (const uint8_t*)worker->message, worker->message_len, peer, worker->timeout_ms, &response, &response_len) == DCF_SUCCESS) {
+            dcf_histogram_record(worker->latency, dcf_loadgen_now() - begin);
+            worker->sent++;
+        } else {
+            dcf_histogram_record(worker->error_latency, dcf_loadgen_now() - begin);
+            worker->errors++;
+        }
+    }
+    return NULL;
+}
+
+DCFError dcf_loadgen_run(DCFClient* client, const DCFLoadOptions* options, DCFLoadReport* report_out) {
+    if (!client || !options || !report_out || !options->peers) return DCF_ERR_NULL_PTR;
+    int concurrency = options->concurrency > 0 ? options->concurrency : 1;
+    size_t message_size = options->message_size ? options->message_size : 64;
+    double duration_s = options->duration_s > 0 ? options->duration_s : 10;
+    int timeout_ms = options->timeout_ms > 0 ? options->timeout_ms : 1000;
+    if (options->peer_count == 0 || options->rate < 0 || options->timeout_ms < 0) return DCF_ERR_INVALID_ARG;
+    memset(report_out, 0, sizeof(DCFLoadReport));
+    report_out->latency_ns = dcf_histogram_new();
+    report_out->error_latency_ns = dcf_histogram_new();
+    char* message = malloc(message_size + 1);
+    DCFLoadWorker* workers = calloc(concurrency, sizeof(DCFLoadWorker));
+    pthread_t* threads = calloc(concurrency, sizeof(pthread_t));
+    DCFError err = DCF_SUCCESS;
+    if (!report_out->latency_ns || !report_out->error_latency_ns || !message || !workers || !threads) {
+        err = DCF_ERR_MALLOC_FAIL;
+        goto done;
+    }
+    memset(message, 'x', message_size);
+    message[message_size] = '\0';
+    // The combined schedule is one send every 1/rate s; each thread takes every concurrency-th slot
+    uint64_t slot_ns = options->rate > 0 ? (uint64_t)(1e9 / options->rate) : 0;
+    if (options->rate > 0 && slot_ns == 0) slot_ns = 1;
+    uint64_t start = dcf_loadgen_now();
+    int started = 0;
+    for (; started < concurrency; started++) {
+        DCFLoadWorker* worker = &workers[started];
+        worker->client = client;
+        worker->options = options;
+        worker->message = message;
+        worker->message_len = message_size;
+        worker->timeout_ms = timeout_ms;
+        worker->end_ns = start + (uint64_t)(duration_s * 1e9);
+        worker->first_ns = start + started * slot_ns;
+        worker->interval_ns = slot_ns * concurrency;
+        worker->peer_offset = started;
+        worker->latency = dcf_histogram_new();
+        worker->error_latency = dcf_histogram_new();
+        if (!worker->latency || !worker->error_latency || pthread_create(&threads[started], NULL, dcf_loadgen_worker, worker) != 0) {
+            dcf_histogram_free(worker->latency);
+            dcf_histogram_free(worker->error_latency);
+            err = DCF_ERR_UNKNOWN;
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        dcf_histogram_merge(report_out->latency_ns, workers[i].latency);
+        dcf_histogram_free(workers[i].latency);
+        dcf_histogram_merge(report_out->error_latency_ns, workers[i].error_latency);
+        dcf_histogram_free(workers[i].error_latency);
+        report_out->sent += workers[i].sent;
+        report_out->errors += workers[i].errors;
+    }
+    report_out->elapsed_s = (dcf_loadgen_now() - start) / 1e9;
+    if (report_out->elapsed_s > 0) report_out->throughput = report_out->sent / report_out->elapsed_s;
+done:
+    free(threads);
+    free(workers);
+    free(message);
+    if (err != DCF_SUCCESS) {
+        dcf_histogram_free(report_out->latency_ns);
+        dcf_histogram_free(report_out->error_latency_ns);
+        report_out->latency_ns = NULL;
+        report_out->error_latency_ns = NULL;
+    }
+    return err;
+}
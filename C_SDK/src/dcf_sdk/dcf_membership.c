@@ -0,0 +1,572 @@
+#include "dcf_membership.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Wire format, integers little-endian, strings a length byte then the bytes:
+// "DCFG", type u8, seq u32, source, subject, origin, update count u8, then
+// per update state u8, incarnation u32, address
+#define DCF_MEMBERSHIP_MAGIC "DCFG"
+#define DCF_MEMBERSHIP_MAX_UPDATES 8
+#define DCF_MEMBERSHIP_MAX_MESSAGE (4 + 1 + 4 + 3 * (1 + DCF_MEMBER_ADDRESS_MAX) + 1 + DCF_MEMBERSHIP_MAX_UPDATES * (1 + 4 + 1 + DCF_MEMBER_ADDRESS_MAX))
+#define DCF_MEMBER_NONE UINT32_MAX
+
+enum { DCF_MEMBERSHIP_PING = 1, DCF_MEMBERSHIP_ACK, DCF_MEMBERSHIP_PING_REQ };
+// Event state for a member that was forgotten
+#define DCF_MEMBERSHIP_REMOVED 0xff
+
+typedef struct {
+    char* address;
+    uint8_t state;
+    uint32_t incarnation;
+    uint64_t suspect_deadline_us;
+    uint64_t dead_since_us;
+    uint32_t transmits;     // piggybacks left for the member's latest update
+} DCFMember;
+
+// A callback deferred until the mutex is released
+typedef struct {
+    char* address;          // owns the allocation, which data follows
+    const uint8_t* data;    // the message to send, or NULL for a state change
+    size_t len;
+    uint8_t state;          // the new state, or DCF_MEMBERSHIP_REMOVED
+} DCFMembershipEvent;
+
+struct DCFMembership {
+    pthread_mutex_t mutex;
+    char* self;
+    uint32_t incarnation;
+    uint32_t self_transmits;
+    DCFMembershipOptions options;
+    DCFMembershipCallbacks callbacks;
+    // Dead members are kept for dead_timeout_ms so stale gossip about them
+    // can't bring them back; removing one moves the last member into its index
+    DCFMember* members;
+    uint32_t count;
+    uint32_t cap;
+    uint32_t* index;        // open-addressed address -> member, DCF_MEMBER_NONE when empty
+    uint32_t index_cap;     // power of two, kept at least twice count
+    uint32_t* order;        // probe order, reshuffled every full round
+    uint32_t order_pos;
+    // This period's probe
+    uint32_t probe_target;  // DCF_MEMBER_NONE when no probe is outstanding
+    uint32_t probe_seq;
+    bool probe_indirect;
+    uint64_t probe_deadline_us;
+    uint64_t period_end_us;
+    uint32_t seq;
+    unsigned int seed;
+    // Callbacks queued under the mutex, run once it is released
+    DCFMembershipEvent* events;
+    uint32_t event_count;
+    uint32_t event_cap;
+    bool delivering;        // a caller is running queued callbacks
+};
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+} DCFMembershipReader;
+
+static uint32_t dcf_membership_hash(const char* s) {
+    uint32_t hash = 2166136261u;
+    while (*s) hash = (hash ^ (uint8_t)*s++) * 16777619u;
+    return hash;
+}
+
+static uint32_t dcf_membership_find(const DCFMembership* m, const char* address) {
+    uint32_t mask = m->index_cap - 1;
+    for (uint32_t slot = dcf_membership_hash(address) & mask;; slot = (slot + 1) & mask) {
+        uint32_t member = m->index[slot];
+        if (member == DCF_MEMBER_NONE || strcmp(m->members[member].address, address) == 0) return member;
+    }
+}
+
+static void dcf_membership_index_insert(DCFMembership* m, uint32_t member) {
+    uint32_t mask = m->index_cap - 1;
+    uint32_t slot = dcf_membership_hash(m->members[member].address) & mask;
+    while (m->index[slot] != DCF_MEMBER_NONE) slot = (slot + 1) & mask;
+    m->index[slot] = member;
+}
+
+static void dcf_membership_reindex(DCFMembership* m) {
+    memset(m->index, 0xff, m->index_cap * sizeof(uint32_t));
+    for (uint32_t i = 0; i < m->count; i++) dcf_membership_index_insert(m, i);
+}
+
+static bool dcf_membership_grow(DCFMembership* m) {
+    uint32_t cap = m->cap ? m->cap * 2 : 16;
+    DCFMember* members = realloc(m->members, cap * sizeof(DCFMember));
+    if (members) m->members = members;
+    uint32_t* order = realloc(m->order, cap * sizeof(uint32_t));
+    if (order) m->order = order;
+    uint32_t* index = malloc(cap * 2 * sizeof(uint32_t));
+    if (!members || !order || !index) {
+        free(index);
+        return false;
+    }
+    free(m->index);
+    m->index = index;
+    m->index_cap = cap * 2;
+    m->cap = cap;
+    dcf_membership_reindex(m);
+    return true;
+}
+
+// Queues a message to send, or with data NULL a state change, for delivery once
+// the mutex is released. Dropped when out of memory, like a lost message.
+static void dcf_membership_queue(DCFMembership* m, const char* address, const uint8_t* data, size_t len, uint8_t state) {
+    if (m->event_count == m->event_cap) {
+        uint32_t cap = m->event_cap ? m->event_cap * 2 : 16;
+        DCFMembershipEvent* events = realloc(m->events, cap * sizeof(DCFMembershipEvent));
+        if (!events) return;
+        m->events = events;
+        m->event_cap = cap;
+    }
+    size_t address_len = strlen(address) + 1;
+    char* block = malloc(address_len + len);
+    if (!block) return;
+    memcpy(block, address, address_len);
+    if (data) memcpy(block + address_len, data, len);
+    m->events[m->event_count++] = (DCFMembershipEvent){ block, data ? (const uint8_t*)block + address_len : NULL, len, state };
+}
+
+static void dcf_membership_deliver(const DCFMembership* m, const DCFMembershipEvent* event) {
+    void* user_data = m->callbacks.user_data;
+    if (event->data) m->callbacks.send(user_data, event->address, event->data, event->len);
+    else if (event->state == DCF_MEMBERSHIP_REMOVED) m->callbacks.removed(user_data, event->address);
+    else m->callbacks.changed(user_data, event->address, event->state);
+}
+
+// Releases the mutex, then runs the callbacks queued under it. Only one caller
+// delivers at a time, which keeps them in order; a caller that finds delivery
+// under way leaves its events to that one.
+static void dcf_membership_unlock(DCFMembership* m) {
+    if (m->delivering) {
+        pthread_mutex_unlock(&m->mutex);
+        return;
+    }
+    m->delivering = true;
+    while (m->event_count) {
+        DCFMembershipEvent* events = m->events;
+        uint32_t count = m->event_count;
+        uint32_t cap = m->event_cap;
+        m->events = NULL;
+        m->event_count = 0;
+        m->event_cap = 0;
+        pthread_mutex_unlock(&m->mutex);
+        for (uint32_t i = 0; i < count; i++) {
+            dcf_membership_deliver(m, &events[i]);
+            free(events[i].address);
+        }
+        pthread_mutex_lock(&m->mutex);
+        // Keep the emptied array unless events queued meanwhile started another
+        if (!m->events) {
+            m->events = events;
+            m->event_cap = cap;
+        } else {
+            free(events);
+        }
+    }
+    m->delivering = false;
+    pthread_mutex_unlock(&m->mutex);
+}
+
+// Piggybacks each update gets: retransmit_mult times log2 of the cluster size, rounded up
+static uint32_t dcf_membership_transmit_limit(const DCFMembership* m) {
+    uint32_t log2n = 1;
+    while ((1u << log2n) < m->count + 2 && log2n < 31) log2n++;
+    return m->options.retransmit_mult * log2n;
+}
+
+static uint64_t dcf_membership_suspicion_us(const DCFMembership* m) {
+    double scale = log10((double)m->count + 1);
+    if (scale < 1) scale = 1;
+    return (uint64_t)(m->options.suspicion_mult * scale * m->options.period_ms * 1000);
+}
+
+DCFMembership* dcf_membership_new(const char* self, const DCFMembershipOptions* options, const DCFMembershipCallbacks* callbacks) {
+    if (!self || !options || !callbacks || !callbacks->send || strlen(self) > DCF_MEMBER_ADDRESS_MAX) return NULL;
+    if (options->period_ms == 0 || options->ack_timeout_ms == 0) return NULL;
+    DCFMembership* m = calloc(1, sizeof(DCFMembership));
+    if (!m) return NULL;
+    pthread_mutex_init(&m->mutex, NULL);
+    m->self = strdup(self);
+    m->options = *options;
+    m->callbacks = *callbacks;
+    m->probe_target = DCF_MEMBER_NONE;
+    m->seed = dcf_membership_hash(self);
+    if (!m->self || !dcf_membership_grow(m)) {
+        dcf_membership_free(m);
+        return NULL;
+    }
+    return m;
+}
+
+bool dcf_membership_is_message(const uint8_t* data, size_t len) {
+    return data && len >= 5 && memcmp(data, DCF_MEMBERSHIP_MAGIC, 4) == 0;
+}
+
+// Adds address with the given state, or returns DCF_MEMBER_NONE when out of
+// memory; the caller holds the mutex and has checked it is new and not self
+static uint32_t dcf_membership_add(DCFMembership* m, const char* address, uint8_t state, uint32_t incarnation, uint64_t now_us) {
+    if (m->count == m->cap && !dcf_membership_grow(m)) return DCF_MEMBER_NONE;
+    char* copy = strdup(address);
+    if (!copy) return DCF_MEMBER_NONE;
+    uint32_t member = m->count++;
+    m->members[member] = (DCFMember){ copy, state, incarnation, 0, 0, dcf_membership_transmit_limit(m) };
+    if (state == DCF_MEMBER_SUSPECT) m->members[member].suspect_deadline_us = now_us + dcf_membership_suspicion_us(m);
+    dcf_membership_index_insert(m, member);
+    // Somewhere in what is left of this round, so a newcomer is probed soon but not first
+    uint32_t pos = m->order_pos + (uint32_t)(rand_r(&m->seed) % (m->count - m->order_pos));
+    m->order[member] = m->order[pos];
+    m->order[pos] = member;
+    if (m->callbacks.changed) dcf_membership_queue(m, address, NULL, 0, state);
+    return member;
+}
+
+// Forgets member, moving the last member into its index; the caller holds the mutex
+static void dcf_membership_remove(DCFMembership* m, uint32_t member) {
+    if (m->callbacks.removed) dcf_membership_queue(m, m->members[member].address, NULL, 0, DCF_MEMBERSHIP_REMOVED);
+    free(m->members[member].address);
+    // Out of the probe order, leaving the rest of this round as it was
+    uint32_t pos = 0;
+    while (m->order[pos] != member) pos++;
+    memmove(&m->order[pos], &m->order[pos + 1], (m->count - pos - 1) * sizeof(uint32_t));
+    if (pos < m->order_pos) m->order_pos--;
+    uint32_t last = --m->count;
+    if (m->probe_target == member) m->probe_target = DCF_MEMBER_NONE;
+    if (member != last) {
+        m->members[member] = m->members[last];
+        for (uint32_t i = 0; i < m->count; i++) {
+            if (m->order[i] == last) m->order[i] = member;
+        }
+        if (m->probe_target == last) m->probe_target = member;
+    }
+    dcf_membership_reindex(m);
+}
+
+static void dcf_membership_set_state(DCFMembership* m, uint32_t member, uint8_t state, uint32_t incarnation, uint64_t now_us) {
+    DCFMember* entry = &m->members[member];
+    bool changed = entry->state != state;
+    entry->state = state;
+    entry->incarnation = incarnation;
+    entry->transmits = dcf_membership_transmit_limit(m);
+    if (state == DCF_MEMBER_SUSPECT && changed) entry->suspect_deadline_us = now_us + dcf_membership_suspicion_us(m);
+    if (state == DCF_MEMBER_DEAD && changed) entry->dead_since_us = now_us;
+    if (changed && m->callbacks.changed) dcf_membership_queue(m, entry->address, NULL, 0, state);
+}
+
+// SWIM's ordering: alive needs a newer incarnation to override anything, suspect
+// overrides alive at the same one, and dead overrides any live state at the same
+// one. A dead member comes back only with a newer alive, i.e. after rejoining.
+static void dcf_membership_apply(DCFMembership* m, uint8_t state, uint32_t incarnation, const char* address, uint64_t now_us) {
+    if (strcmp(address, m->self) == 0) {
+        // Refute: outbid the suspicion with a newer incarnation and spread it
+        if (state != DCF_MEMBER_ALIVE && incarnation >= m->incarnation) {
+            m->incarnation = incarnation + 1;
+            m->self_transmits = dcf_membership_transmit_limit(m);
+        }
+        return;
+    }
+    uint32_t member = dcf_membership_find(m, address);
+    if (member == DCF_MEMBER_NONE) {
+        // Nothing to learn from the death of a member never heard of
+        if (state != DCF_MEMBER_DEAD) dcf_membership_add(m, address, state, incarnation, now_us);
+        return;
+    }
+    const DCFMember* entry = &m->members[member];
+    bool accept;
+    switch (state) {
+    case DCF_MEMBER_ALIVE: accept = incarnation > entry->incarnation; break;
+    case DCF_MEMBER_SUSPECT: accept = incarnation > entry->incarnation || (entry->state == DCF_MEMBER_ALIVE && incarnation == entry->incarnation); break;
+    case DCF_MEMBER_DEAD: accept = entry->state != DCF_MEMBER_DEAD && incarnation >= entry->incarnation; break;
+    default: accept = false; break;
+    }
+    if (accept) dcf_membership_set_state(m, member, state, incarnation, now_us);
+}
+
+static uint8_t* dcf_membership_put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint8_t* dcf_membership_put_string(uint8_t* p, const char* s) {
+    size_t len = strlen(s);
+    *p++ = (uint8_t)len;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+// Picks the updates with the most piggybacks left, which are the freshest, and
+// spends one piggyback of each; the caller holds the mutex
+static uint8_t* dcf_membership_put_updates(DCFMembership* m, uint8_t* p) {
+    uint32_t chosen[DCF_MEMBERSHIP_MAX_UPDATES];
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < m->count; i++) {
+        uint32_t transmits = m->members[i].transmits;
+        if (transmits == 0) continue;
+        // Insertion into a short list kept sorted by transmits left, most first
+        uint32_t pos = count < DCF_MEMBERSHIP_MAX_UPDATES ? count++ : DCF_MEMBERSHIP_MAX_UPDATES;
+        while (pos > 0 && m->members[chosen[pos - 1]].transmits < transmits) {
+            if (pos < DCF_MEMBERSHIP_MAX_UPDATES) chosen[pos] = chosen[pos - 1];
+            pos--;
+        }
+        if (pos < DCF_MEMBERSHIP_MAX_UPDATES) chosen[pos] = i;
+    }
+    bool self = m->self_transmits > 0;
+    // A refutation always goes out, in place of the least fresh update if need be
+    if (self && count == DCF_MEMBERSHIP_MAX_UPDATES) count--;
+    *p++ = (uint8_t)(count + self);
+    if (self) {
+        m->self_transmits--;
+        *p++ = DCF_MEMBER_ALIVE;
+        p = dcf_membership_put_u32(p, m->incarnation);
+        p = dcf_membership_put_string(p, m->self);
+    }
+    for (uint32_t c = 0; c < count; c++) {
+        DCFMember* entry = &m->members[chosen[c]];
+        entry->transmits--;
+        *p++ = entry->state;
+        p = dcf_membership_put_u32(p, entry->incarnation);
+        p = dcf_membership_put_string(p, entry->address);
+    }
+    return p;
+}
+
+// The caller holds the mutex
+static void dcf_membership_send(DCFMembership* m, const char* to, uint8_t type, uint32_t seq, const char* subject, const char* origin) {
+    uint8_t buf[DCF_MEMBERSHIP_MAX_MESSAGE];
+    uint8_t* p = buf;
+    memcpy(p, DCF_MEMBERSHIP_MAGIC, 4);
+    p += 4;
+    *p++ = type;
+    p = dcf_membership_put_u32(p, seq);
+    p = dcf_membership_put_string(p, m->self);
+    p = dcf_membership_put_string(p, subject);
+    p = dcf_membership_put_string(p, origin);
+    p = dcf_membership_put_updates(m, p);
+    dcf_membership_queue(m, to, buf, (size_t)(p - buf), 0);
+}
+
+static uint8_t dcf_membership_get_u8(DCFMembershipReader* r) {
+    if (r->p >= r->end) {
+        r->ok = false;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint32_t dcf_membership_get_u32(DCFMembershipReader* r) {
+    if (r->end - r->p < 4) {
+        r->ok = false;
+        return 0;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)*r->p++ << (8 * i);
+    return v;
+}
+
+// Copies a string field into out, which holds DCF_MEMBER_ADDRESS_MAX + 1 bytes
+static void dcf_membership_get_string(DCFMembershipReader* r, char* out) {
+    size_t len = dcf_membership_get_u8(r);
+    if (!r->ok || (size_t)(r->end - r->p) < len || memchr(r->p, '\0', len)) {
+        r->ok = false;
+        out[0] = '\0';
+        return;
+    }
+    memcpy(out, r->p, len);
+    out[len] = '\0';
+    r->p += len;
+}
+
+DCFError dcf_membership_join(DCFMembership* membership, const char* address) {
+    if (!membership || !address) return DCF_ERR_NULL_PTR;
+    if (!*address || strlen(address) > DCF_MEMBER_ADDRESS_MAX) return DCF_ERR_INVALID_ARG;
+    pthread_mutex_lock(&membership->mutex);
+    DCFError err = DCF_SUCCESS;
+    if (strcmp(address, membership->self) != 0 && dcf_membership_find(membership, address) == DCF_MEMBER_NONE) {
+        if (dcf_membership_add(membership, address, DCF_MEMBER_ALIVE, 0, 0) == DCF_MEMBER_NONE) err = DCF_ERR_MALLOC_FAIL;
+    }
+    dcf_membership_unlock(membership);
+    return err;
+}
+
+DCFError dcf_membership_handle(DCFMembership* membership, const uint8_t* data, size_t len, uint64_t now_us) {
+    if (!membership || !data) return DCF_ERR_NULL_PTR;
+    if (!dcf_membership_is_message(data, len)) return DCF_ERR_DESERIALIZATION_FAIL;
+    DCFMembershipReader r = { data + 4, data + len, true };
+    char source[DCF_MEMBER_ADDRESS_MAX + 1], subject[DCF_MEMBER_ADDRESS_MAX + 1], origin[DCF_MEMBER_ADDRESS_MAX + 1];
+    char address[DCF_MEMBER_ADDRESS_MAX + 1];
+    uint8_t type = dcf_membership_get_u8(&r);
+    uint32_t seq = dcf_membership_get_u32(&r);
+    dcf_membership_get_string(&r, source);
+    dcf_membership_get_string(&r, subject);
+    dcf_membership_get_string(&r, origin);
+    uint8_t updates = dcf_membership_get_u8(&r);
+    if (!r.ok || !source[0] || type < DCF_MEMBERSHIP_PING || type > DCF_MEMBERSHIP_PING_REQ) return DCF_ERR_DESERIALIZATION_FAIL;
+    pthread_mutex_lock(&membership->mutex);
+    for (uint8_t u = 0; u < updates && r.ok; u++) {
+        uint8_t state = dcf_membership_get_u8(&r);
+        uint32_t incarnation = dcf_membership_get_u32(&r);
+        dcf_membership_get_string(&r, address);
+        if (r.ok && address[0] && state <= DCF_MEMBER_DEAD) dcf_membership_apply(membership, state, incarnation, address, now_us);
+    }
+    // Hearing from a node is how it joins; one we have given up on is told so
+    // in our reply, so it can refute
+    uint32_t from = strcmp(source, membership->self) == 0 ? DCF_MEMBER_NONE : dcf_membership_find(membership, source);
+    if (from == DCF_MEMBER_NONE && strcmp(source, membership->self) != 0) {
+        dcf_membership_add(membership, source, DCF_MEMBER_ALIVE, 0, now_us);
+    } else if (from != DCF_MEMBER_NONE && membership->members[from].state != DCF_MEMBER_ALIVE) {
+        membership->members[from].transmits = dcf_membership_transmit_limit(membership);
+    }
+    switch (type) {
+    case DCF_MEMBERSHIP_PING:
+        dcf_membership_send(membership, source, DCF_MEMBERSHIP_ACK, seq, membership->self, origin);
+        break;
+    case DCF_MEMBERSHIP_PING_REQ:
+        // Probe subject on source's behalf; its ack comes back through us
+        if (subject[0] && strcmp(subject, membership->self) != 0) dcf_membership_send(membership, subject, DCF_MEMBERSHIP_PING, seq, subject, source);
+        break;
+    case DCF_MEMBERSHIP_ACK:
+        if (origin[0] && strcmp(origin, membership->self) != 0) {
+            dcf_membership_send(membership, origin, DCF_MEMBERSHIP_ACK, seq, subject, origin);
+        } else if (membership->probe_target != DCF_MEMBER_NONE && seq == membership->probe_seq &&
+                   strcmp(subject, membership->members[membership->probe_target].address) == 0) {
+            membership->probe_target = DCF_MEMBER_NONE;
+        }
+        break;
+    }
+    dcf_membership_unlock(membership);
+    return r.ok ? DCF_SUCCESS : DCF_ERR_DESERIALIZATION_FAIL;
+}
+
+// Next member to probe in the shuffled round-robin order, skipping the dead;
+// DCF_MEMBER_NONE when none is left. The caller holds the mutex.
+static uint32_t dcf_membership_next_target(DCFMembership* m) {
+    for (uint32_t tries = 0; tries <= m->count; tries++) {
+        if (m->order_pos >= m->count) {
+            // A new round in a new order, so every member is probed once per round
+            for (uint32_t i = m->count; i > 1; i--) {
+                uint32_t j = (uint32_t)(rand_r(&m->seed) % i);
+                uint32_t t = m->order[i - 1];
+                m->order[i - 1] = m->order[j];
+                m->order[j] = t;
+            }
+            m->order_pos = 0;
+            if (m->count == 0) return DCF_MEMBER_NONE;
+        }
+        uint32_t member = m->order[m->order_pos++];
+        if (m->members[member].state != DCF_MEMBER_DEAD) return member;
+    }
+    return DCF_MEMBER_NONE;
+}
+
+// Asks up to indirect_probes random live members to ping the probe target
+static void dcf_membership_probe_indirect(DCFMembership* m) {
+    uint32_t asked[16];
+    uint32_t want = m->options.indirect_probes < 16 ? m->options.indirect_probes : 16;
+    uint32_t count = 0;
+    const char* target = m->members[m->probe_target].address;
+    for (uint32_t tries = 0; count < want && tries < want * 4 && m->count > 1; tries++) {
+        uint32_t member = (uint32_t)(rand_r(&m->seed) % m->count);
+        if (member == m->probe_target || m->members[member].state != DCF_MEMBER_ALIVE) continue;
+        bool seen = false;
+        for (uint32_t c = 0; c < count; c++) seen |= asked[c] == member;
+        if (seen) continue;
+        asked[count++] = member;
+        dcf_membership_send(m, m->members[member].address, DCF_MEMBERSHIP_PING_REQ, m->probe_seq, target, "");
+    }
+}
+
+uint64_t dcf_membership_tick(DCFMembership* membership, uint64_t now_us) {
+    if (!membership) return UINT64_MAX;
+    pthread_mutex_lock(&membership->mutex);
+    DCFMembership* m = membership;
+    uint64_t next = UINT64_MAX;
+    for (uint32_t i = 0; i < m->count; i++) {
+        DCFMember* entry = &m->members[i];
+        if (entry->state != DCF_MEMBER_SUSPECT) continue;
+        if (entry->suspect_deadline_us <= now_us) dcf_membership_set_state(m, i, DCF_MEMBER_DEAD, entry->incarnation, now_us);
+        else if (entry->suspect_deadline_us < next) next = entry->suspect_deadline_us;
+    }
+    // Dead members are forgotten once their death has long since spread
+    uint64_t dead_timeout_us = (uint64_t)m->options.dead_timeout_ms * 1000;
+    for (uint32_t i = 0; dead_timeout_us && i < m->count;) {
+        DCFMember* entry = &m->members[i];
+        if (entry->state == DCF_MEMBER_DEAD && entry->dead_since_us + dead_timeout_us <= now_us) {
+            dcf_membership_remove(m, i);  // the last member now sits at i
+            continue;
+        }
+        if (entry->state == DCF_MEMBER_DEAD && entry->dead_since_us + dead_timeout_us < next) next = entry->dead_since_us + dead_timeout_us;
+        i++;
+    }
+    if (m->probe_target != DCF_MEMBER_NONE && !m->probe_indirect && now_us >= m->probe_deadline_us) {
+        dcf_membership_probe_indirect(m);
+        m->probe_indirect = true;
+    }
+    if (now_us >= m->period_end_us) {
+        // Neither a direct nor an indirect ack came back within the period
+        if (m->probe_target != DCF_MEMBER_NONE) {
+            DCFMember* entry = &m->members[m->probe_target];
+            if (entry->state == DCF_MEMBER_ALIVE) dcf_membership_set_state(m, m->probe_target, DCF_MEMBER_SUSPECT, entry->incarnation, now_us);
+            if (entry->state == DCF_MEMBER_SUSPECT && entry->suspect_deadline_us < next) next = entry->suspect_deadline_us;
+        }
+        m->probe_target = dcf_membership_next_target(m);
+        if (m->probe_target != DCF_MEMBER_NONE) {
+            m->probe_seq = ++m->seq;
+            m->probe_indirect = false;
+            m->probe_deadline_us = now_us + (uint64_t)m->options.ack_timeout_ms * 1000;
+            const char* target = m->members[m->probe_target].address;
+            dcf_membership_send(m, target, DCF_MEMBERSHIP_PING, m->probe_seq, target, "");
+        }
+        m->period_end_us = now_us + (uint64_t)m->options.period_ms * 1000;
+    }
+    if (m->period_end_us < next) next = m->period_end_us;
+    if (m->probe_target != DCF_MEMBER_NONE && !m->probe_indirect && m->probe_deadline_us < next) next = m->probe_deadline_us;
+    dcf_membership_unlock(membership);
+    return next;
+}
+
+size_t dcf_membership_count(DCFMembership* membership) {
+    if (!membership) return 0;
+    pthread_mutex_lock(&membership->mutex);
+    size_t count = membership->count;
+    pthread_mutex_unlock(&membership->mutex);
+    return count;
+}
+
+DCFError dcf_membership_get_state(DCFMembership* membership, const char* address, DCFMemberState* state_out, uint32_t* incarnation_out) {
+    if (!membership || !address || !state_out) return DCF_ERR_NULL_PTR;
+    pthread_mutex_lock(&membership->mutex);
+    uint32_t member = dcf_membership_find(membership, address);
+    if (member != DCF_MEMBER_NONE) {
+        *state_out = membership->members[member].state;
+        if (incarnation_out) *incarnation_out = membership->members[member].incarnation;
+    }
+    pthread_mutex_unlock(&membership->mutex);
+    return member == DCF_MEMBER_NONE ? DCF_ERR_ROUTE_NOT_FOUND : DCF_SUCCESS;
+}
+
+uint32_t dcf_membership_incarnation(DCFMembership* membership) {
+    if (!membership) return 0;
+    pthread_mutex_lock(&membership->mutex);
+    uint32_t incarnation = membership->incarnation;
+    pthread_mutex_unlock(&membership->mutex);
+    return incarnation;
+}
+
+void dcf_membership_free(DCFMembership* membership) {
+    if (!membership) return;
+    for (uint32_t i = 0; i < membership->count; i++) free(membership->members[i].address);
+    for (uint32_t i = 0; i < membership->event_count; i++) free(membership->events[i].address);
+    free(membership->events);
+    free(membership->members);
+    free(membership->index);
+    free(membership->order);
+    free(membership->self);
+    pthread_mutex_destroy(&membership->mutex);
+    free(membership);
+}
@@ -0,0 +1,101 @@
+#include "dcf_message_view.h"
+#include <string.h>
+
+#define DCF_WIRE_VARINT 0
+#define DCF_WIRE_64BIT 1
+#define DCF_WIRE_LENGTH 2
+#define DCF_WIRE_32BIT 5
+
+// Reads a varint of at most max_bytes; returns the bytes consumed, 0 when malformed
+static size_t dcf_read_varint(const uint8_t* p, const uint8_t* end, size_t max_bytes, uint64_t* value_out) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < max_bytes && p + i < end; i++) {
+        value |= (uint64_t)(p[i] & 0x7f) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *value_out = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static DCFSlice* dcf_view_slice(DCFMessageView* view, uint32_t field) {
+    switch (field) {
+    case 1: return &view->sender;
+    case 2: return &view->recipient;
+    case 3: return &view->data;
+    case 7: return &view->redundancy_path;
+    case 8: return &view->group_id;
+    default: return NULL;
+    }
+}
+
+DCFError dcf_message_view_parse(const uint8_t* buf, size_t len, uint32_t wanted, DCFMessageView* view_out) {
+    if ((!buf && len) || !view_out) return DCF_ERR_NULL_PTR;
+    DCFMessageView view;
+    memset(&view, 0, sizeof(view));
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + len;
+    while (p < end) {
+        // Limits and truncation follow protobuf-c: keys and length prefixes are
+        // at most 5 bytes, field numbers wrap to 32 bits, lengths fit an int
+        uint64_t key;
+        size_t n = dcf_read_varint(p, end, 5, &key);
+        if (n == 0) return DCF_ERR_DESERIALIZATION_FAIL;
+        p += n;
+        uint32_t field = (uint32_t)(key >> 3);
+        uint32_t wire_type = key & 7;
+        uint64_t value = 0;
+        const uint8_t* bytes = NULL;
+        switch (wire_type) {
+        case DCF_WIRE_VARINT:
+            n = dcf_read_varint(p, end, 10, &value);
+            if (n == 0) return DCF_ERR_DESERIALIZATION_FAIL;
+            p += n;
+            break;
+        case DCF_WIRE_64BIT:
+            if (end - p < 8) return DCF_ERR_DESERIALIZATION_FAIL;
+            p += 8;
+            break;
+        case DCF_WIRE_LENGTH:
+            n = dcf_read_varint(p, end, 5, &value);
+            if (n == 0 || value > INT32_MAX || value > (uint64_t)(end - p - n)) return DCF_ERR_DESERIALIZATION_FAIL;
+            bytes = p + n;
+            p = bytes + value;
+            break;
+        case DCF_WIRE_32BIT:
+            if (end - p < 4) return DCF_ERR_DESERIALIZATION_FAIL;
+            p += 4;
+            break;
+        default:
+            // Groups are unsupported by protobuf-c as well
+            return DCF_ERR_DESERIALIZATION_FAIL;
+        }
+        if (field == 0 || field > 8) continue;  // unknown fields are skipped
+        // A known field with the wrong wire type fails the unpack, wanted or not
+        bool length_field = dcf_view_slice(&view, field) != NULL;
+        if (length_field != (wire_type == DCF_WIRE_LENGTH) || (!length_field && wire_type != DCF_WIRE_VARINT)) return DCF_ERR_DESERIALIZATION_FAIL;
+        uint32_t bit = 1u << field;
+        if (!(wanted & bit)) continue;
+        view.present |= bit;
+        if (length_field) {
+            DCFSlice* slice = dcf_view_slice(&view, field);
+            slice->data = bytes;
+            slice->len = (size_t)value;
+        } else if (field == 4) {
+            view.timestamp = (int64_t)value;
+        } else if (field == 5) {
+            view.sync = value != 0;
+        } else {
+            view.sequence = (uint32_t)value;
+        }
+    }
+    *view_out = view;
+    return DCF_SUCCESS;
+}
+
+bool dcf_slice_equals(DCFSlice slice, const char* s) {
+    if (!s) return false;
+    size_t len = strlen(s);
+    return slice.len == len && (len == 0 || memcmp(slice.data, s, len) == 0);
+}
@@ -1,73 +1,448 @@
 #include "dcf_networking.h"
+#include "dcf_dedup.h"
+#include "dcf_message_view.h"
+#include "dcf_serialization.h"
+#include "dcf_shm_transport.h"
+#include "dcf_tcp_transport.h"
+#include "dcf_udp_transport.h"
 #include "grpc_wrapper.h"
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// How long a relayed multipath copy may take to reach the next hop
+#define DCF_RELAY_TIMEOUT_MS 5000
+// Longest hop address a relayed copy can name
+#define DCF_RELAY_ADDR_MAX 256
 
 struct DCFNetworking {
+    DCFTransportType transport;
     void* grpc_handle;
+    DCFUdpTransport* udp;
+    DCFTcpTransport* tcp;
+    DCFShmTransport* shm;  // same-host peers, tried before the network transport
+    bool shm_inbound;      // shm owns a ring that receive must also watch
+    int epoll_fd;          // readiness of every receive source, created by get_fd
+    DCFDedup* dedup;       // drops extra copies of multipath sends
+    DCFControlHandler control;  // takes protocol traffic before the application sees it
+    void* control_data;
     char* host;
+    char* node_id;  // names this node's MessageStream to its server
+    char* address;  // host:port, the other name a redundancy_path may give this node
     int port;
     DCFMode mode;
 };
 
+typedef struct {
+    DCFSendCallback cb;
+    void* user_data;
+} DCFAsyncSend;
+
+static void dcf_networking_async_complete(void* user_data, bool ok, const uint8_t* response, size_t response_len) {
+    DCFAsyncSend* pending = user_data;
+    if (pending->cb) pending->cb(pending->user_data, ok ? DCF_SUCCESS : DCF_ERR_GRPC_FAIL, response, response_len);
+    free(pending);
+}
+
 DCFNetworking* dcf_networking_new(void) {
     DCFNetworking* net = calloc(1, sizeof(DCFNetworking));
     if (!net) return NULL;
+    net->epoll_fd = -1;
+    net->dedup = dcf_dedup_new();
+    if (!net->dedup) {
+        free(net);
+        return NULL;
+    }
     return net;
 }
 
+static DCFError dcf_networking_init_transport(DCFNetworking* net, DCFConfig* config) {
+    if (net->transport == DCF_TRANSPORT_UDP) {
+        net->udp = dcf_udp_transport_new();
+        if (!net->udp) return DCF_ERR_MALLOC_FAIL;
+        DCFError err = dcf_udp_transport_initialize(net->udp, net->host, net->port, dcf_config_get_socket_rcvbuf(config), dcf_config_get_socket_sndbuf(config));
+        DCFSocketIo io = dcf_config_get_io_backend(config);
+        if (err == DCF_SUCCESS && io != DCF_SOCKET_IO_DIRECT) {
+            err = dcf_udp_transport_set_io_backend(net->udp, io == DCF_SOCKET_IO_URING ? DCF_IO_BACKEND_IO_URING : DCF_IO_BACKEND_EPOLL);
+        }
+        return err;
+    }
+    if (net->transport == DCF_TRANSPORT_TCP) {
+        net->tcp = dcf_tcp_transport_new();
+        if (!net->tcp) return DCF_ERR_MALLOC_FAIL;
+        return dcf_tcp_transport_initialize(net->tcp, net->host, net->port, dcf_config_get_socket_rcvbuf(config), dcf_config_get_socket_sndbuf(config));
+    }
+    net->grpc_handle = grpc_wrapper_new(net->host, net->port);
+    if (!net->grpc_handle) return DCF_ERR_GRPC_FAIL;
+    grpc_wrapper_configure_pool(net->grpc_handle, dcf_config_get_channels_per_peer(config), dcf_config_get_max_peer_channels(config));
+    grpc_wrapper_configure_server(net->grpc_handle, dcf_config_get_server_threads(config));
+    return DCF_SUCCESS;
+}
+
 DCFError dcf_networking_initialize(DCFNetworking* net, DCFConfig* config) {
     if (!net || !config) return DCF_ERR_NULL_PTR;
     DCFError err = dcf_config_get_host(config, &net->host);
     if (err != DCF_SUCCESS) return err;
     net->port = dcf_config_get_port(config);
     err = dcf_config_get_mode(config, &net->mode);
-    if (err != DCF_SUCCESS) { free(net->host); return err; }
-    net->grpc_handle = grpc_wrapper_new(net->host, net->port);
-    if (!net->grpc_handle) { free(net->host); return DCF_ERR_GRPC_FAIL; }
-    return DCF_SUCCESS;
+    if (err != DCF_SUCCESS) { free(net->host); net->host = NULL; return err; }
+    net->transport = dcf_config_get_transport(config);
+    if (net->transport == DCF_TRANSPORT_WEBSOCKET) { free(net->host); net->host = NULL; return DCF_ERR_CONFIG_INVALID; }
+    // Names a gRPC client's MessageStream, and lets relays recognize this node in a path
+    if (dcf_config_get_node_id(config, &net->node_id) != DCF_SUCCESS) net->node_id = NULL;
+    size_t address_len = strlen(net->host) + 8;
+    net->address = malloc(address_len);
+    if (!net->address) err = DCF_ERR_MALLOC_FAIL;
+    else snprintf(net->address, address_len, "%s:%d", net->host, net->port);
+    if (err == DCF_SUCCESS) err = dcf_networking_init_transport(net, config);
+    if (err == DCF_SUCCESS && dcf_config_get_shared_memory(config)) {
+        // Only nodes that own their port get an inbound ring; a gRPC client's port is its server's
+        bool listens = net->transport != DCF_TRANSPORT_GRPC || net->mode == SERVER_MODE;
+        net->shm = dcf_shm_transport_new();
+        if (!net->shm) err = DCF_ERR_MALLOC_FAIL;
+        else err = dcf_shm_transport_initialize(net->shm, listens ? net->port : 0);
+        net->shm_inbound = listens;
+    }
+    if (err != DCF_SUCCESS) {
+        dcf_shm_transport_free(net->shm);
+        net->shm = NULL;
+        if (net->grpc_handle) grpc_wrapper_free(net->grpc_handle);
+        net->grpc_handle = NULL;
+        dcf_udp_transport_free(net->udp);
+        net->udp = NULL;
+        dcf_tcp_transport_free(net->tcp);
+        net->tcp = NULL;
+        free(net->host);
+        net->host = NULL;
+        free(net->node_id);
+        net->node_id = NULL;
+        free(net->address);
+        net->address = NULL;
+    }
+    return err;
 }
 
 DCFError dcf_networking_start(DCFNetworking* net, DCFMode mode) {
     if (!net) return DCF_ERR_NULL_PTR;
     net->mode = mode;
+    if (!net->grpc_handle) return DCF_SUCCESS;
     if (net->mode == SERVER_MODE) {
         if (!grpc_wrapper_start_server(net->grpc_handle)) return DCF_ERR_GRPC_FAIL;
+    } else {
+        if (!net->node_id || !grpc_wrapper_start_stream(net->grpc_handle, net->node_id)) return DCF_ERR_GRPC_FAIL;
     }
     return DCF_SUCCESS;
 }
 
 DCFError dcf_networking_stop(DCFNetworking* net) {
     if (!net) return DCF_ERR_NULL_PTR;
+    if (!net->grpc_handle) return DCF_SUCCESS;
     if (net->mode == SERVER_MODE) {
         if (!grpc_wrapper_stop_server(net->grpc_handle)) return DCF_ERR_GRPC_FAIL;
+    } else {
+        if (!grpc_wrapper_stop_stream(net->grpc_handle)) return DCF_ERR_GRPC_FAIL;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_networking_warm_up(DCFNetworking* net, const char* const* peers, size_t count) {
+    if (!net || (!peers && count > 0)) return DCF_ERR_NULL_PTR;
+    if (!net->grpc_handle) return DCF_SUCCESS;
+    for (size_t i = 0; i < count; i++) {
+        if (peers[i]) grpc_wrapper_warm_up(net->grpc_handle, peers[i]);
     }
     return DCF_SUCCESS;
 }
 
+DCFError dcf_networking_set_ack_data(DCFNetworking* net, const uint8_t* data, size_t len) {
+    if (!net || (!data && len)) return DCF_ERR_NULL_PTR;
+    if (net->grpc_handle) grpc_wrapper_set_ack_data(net->grpc_handle, data, len);
+    return DCF_SUCCESS;
+}
+
+// Whether a message may take the shared memory ring. Health probes stay on the
+// network transport, whose reply is what times them; a ring has no reply.
+static bool dcf_networking_via_shm(const DCFNetworking* net, const uint8_t* data, size_t len) {
+    if (!net->shm || len > DCF_SHM_MAX_MESSAGE) return false;
+    DCFMessageView view;
+    return dcf_message_view_parse(data, len, DCF_VIEW_GROUP_ID, &view) != DCF_SUCCESS || !dcf_slice_equals(view.group_id, DCF_GROUP_HEALTH);
+}
+
 DCFError dcf_networking_send(DCFNetworking* net, const uint8_t* data, size_t len, const char* recipient) {
+    return dcf_networking_request(net, data, len, recipient, 0, NULL, NULL);
+}
+
+DCFError dcf_networking_request(DCFNetworking* net, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, uint8_t** response_out, size_t* response_len_out) {
+    if (!net || !data || !recipient || (response_out && !response_len_out)) return DCF_ERR_NULL_PTR;
+    if (response_out) {
+        *response_out = NULL;
+        *response_len_out = 0;
+    }
+    if (dcf_networking_via_shm(net, data, len)) {
+        DCFError err = dcf_shm_transport_send(net->shm, data, len, recipient);
+        if (err != DCF_ERR_ROUTE_NOT_FOUND) return err;
+    }
+    if (net->udp) return dcf_udp_transport_send(net->udp, data, len, recipient);
+    if (net->tcp) return dcf_tcp_transport_send_timeout(net->tcp, data, len, recipient, timeout_ms);
+    if (!grpc_wrapper_send(net->grpc_handle, data, len, recipient, timeout_ms, response_out, response_len_out)) return DCF_ERR_GRPC_FAIL;
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_networking_send_batch(DCFNetworking* net, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, DCFError* results_out) {
+    if (!net || !data || !lens || !recipient || !results_out) return DCF_ERR_NULL_PTR;
+    if (count == 0) return DCF_SUCCESS;
+    if (net->shm && dcf_shm_transport_reaches(net->shm, recipient)) {
+        // Ring enqueues are plain copies, so there is no syscall to amortize
+        DCFError first = DCF_SUCCESS;
+        for (size_t i = 0; i < count; i++) {
+            results_out[i] = lens[i] <= DCF_SHM_MAX_MESSAGE ? dcf_shm_transport_send(net->shm, data[i], lens[i], recipient) : dcf_networking_send(net, data[i], lens[i], recipient);
+            if (first == DCF_SUCCESS) first = results_out[i];
+        }
+        return first;
+    }
+    if (net->udp) {
+        size_t sent = 0;
+        DCFError err = dcf_udp_transport_send_batch(net->udp, data, lens, count, recipient, results_out, &sent);
+        // Setup failures, like an unresolvable recipient, are every message's outcome
+        if (err != DCF_SUCCESS && sent == 0) for (size_t i = 0; i < count; i++) results_out[i] = err;
+        return err;
+    }
+    if (net->tcp) {
+        DCFError err = dcf_tcp_transport_send_batch(net->tcp, data, lens, count, recipient);
+        for (size_t i = 0; i < count; i++) results_out[i] = err;
+        return err;
+    }
+    bool* ok = calloc(count, sizeof(bool));
+    if (!ok) return DCF_ERR_MALLOC_FAIL;
+    DCFError err = grpc_wrapper_send_batch(net->grpc_handle, data, lens, count, recipient, ok) ? DCF_SUCCESS : DCF_ERR_GRPC_FAIL;
+    for (size_t i = 0; i < count; i++) {
+        results_out[i] = ok[i] ? DCF_SUCCESS : DCF_ERR_GRPC_FAIL;
+        if (err == DCF_SUCCESS) err = results_out[i];
+    }
+    free(ok);
+    return err;
+}
+
+DCFError dcf_networking_send_async(DCFNetworking* net, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, DCFSendCallback cb, void* user_data) {
     if (!net || !data || !recipient) return DCF_ERR_NULL_PTR;
-    char* response;
-    if (!grpc_wrapper_send(net->grpc_handle, data, len, recipient, &response)) return DCF_ERR_GRPC_FAIL;
-    free(response);
+    if (dcf_networking_via_shm(net, data, len)) {
+        DCFError err = dcf_shm_transport_send(net->shm, data, len, recipient);
+        if (err == DCF_SUCCESS && cb) cb(user_data, DCF_SUCCESS, NULL, 0);
+        if (err != DCF_ERR_ROUTE_NOT_FOUND) return err;
+    }
+    if (net->udp || net->tcp) {
+        // Socket sends complete once handed to the kernel; there is no response
+        DCFError err = net->udp ? dcf_udp_transport_send(net->udp, data, len, recipient) : dcf_tcp_transport_send_timeout(net->tcp, data, len, recipient, timeout_ms);
+        if (err == DCF_SUCCESS && cb) cb(user_data, DCF_SUCCESS, NULL, 0);
+        return err;
+    }
+    DCFAsyncSend* pending = malloc(sizeof(DCFAsyncSend));
+    if (!pending) return DCF_ERR_MALLOC_FAIL;
+    pending->cb = cb;
+    pending->user_data = user_data;
+    int started = grpc_wrapper_send_async(net->grpc_handle, data, len, recipient, timeout_ms, dcf_networking_async_complete, pending);
+    if (started <= 0) {
+        free(pending);
+        return started == 0 ? DCF_ERR_BUSY : DCF_ERR_GRPC_FAIL;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_networking_set_control_handler(DCFNetworking* net, DCFControlHandler handler, void* user_data) {
+    if (!net) return DCF_ERR_NULL_PTR;
+    net->control = handler;
+    net->control_data = user_data;
     return DCF_SUCCESS;
 }
 
+// Passes a multipath copy on along its path, "next,...,recipient", which no longer
+// names this node. Best effort: the other copies cover a relay that fails.
+static void dcf_networking_relay(DCFNetworking* net, const uint8_t* data, size_t len, DCFSlice path) {
+    const uint8_t* comma = memchr(path.data, ',', path.len);
+    size_t hop_len = comma ? (size_t)(comma - path.data) : path.len;
+    char hop[DCF_RELAY_ADDR_MAX];
+    if (hop_len == 0 || hop_len >= sizeof(hop)) return;
+    memcpy(hop, path.data, hop_len);
+    hop[hop_len] = '\0';
+    const uint8_t* relayed;
+    size_t relayed_len;
+    if (dcf_serialize_rerouted_scratch(data, len, path.data, path.len, &relayed, &relayed_len) != DCF_SUCCESS) return;
+    dcf_networking_send_async(net, relayed, relayed_len, hop, DCF_RELAY_TIMEOUT_MS, NULL, NULL);
+}
+
+// Whether a redundancy_path names this node, by node_id or host:port
+static bool dcf_networking_is_self(const DCFNetworking* net, const uint8_t* name, size_t len) {
+    DCFSlice slice = { name, len };
+    return (net->node_id && dcf_slice_equals(slice, net->node_id)) || (net->address && dcf_slice_equals(slice, net->address));
+}
+
+// Messages receive never returns: health probes, which only gRPC answers,
+// the rest of the SDK's reserved groups, which go to the control handler, and
+// routed copies (they carry their path in redundancy_path; the node at the
+// head of a longer path relays the copy, a node the path doesn't start with
+// drops it, and the recipient drops all but the first copy to arrive)
+static bool dcf_networking_consumed(DCFNetworking* net, const uint8_t* data, size_t len) {
+    DCFMessageView view;
+    uint32_t wanted = DCF_VIEW_SENDER | DCF_VIEW_SEQUENCE | DCF_VIEW_REDUNDANCY_PATH | DCF_VIEW_GROUP_ID;
+    if (net->control) wanted |= DCF_VIEW_DATA;
+    // Malformed input is left for deserialization to reject
+    if (dcf_message_view_parse(data, len, wanted, &view) != DCF_SUCCESS) return false;
+    if (dcf_slice_equals(view.group_id, DCF_GROUP_HEALTH)) return true;
+    size_t reserved_len = sizeof(DCF_GROUP_RESERVED_PREFIX) - 1;
+    if (view.group_id.len >= reserved_len && memcmp(view.group_id.data, DCF_GROUP_RESERVED_PREFIX, reserved_len) == 0) {
+        if (net->control) net->control(net->control_data, view.data.data, view.data.len);
+        return true;
+    }
+    if (view.redundancy_path.len) {
+        // "this,next,...,recipient": a longer path means the copy isn't ours yet
+        const uint8_t* comma = memchr(view.redundancy_path.data, ',', view.redundancy_path.len);
+        size_t head_len = comma ? (size_t)(comma - view.redundancy_path.data) : view.redundancy_path.len;
+        if (!dcf_networking_is_self(net, view.redundancy_path.data, head_len)) return true;
+        if (comma) {
+            DCFSlice rest = { comma + 1, view.redundancy_path.data + view.redundancy_path.len - (comma + 1) };
+            dcf_networking_relay(net, data, len, rest);
+            return true;
+        }
+        if (!dcf_dedup_accept(net->dedup, view.sender.data, view.sender.len, view.sequence)) return true;
+    }
+    return false;
+}
+
+// Receives from the network transport into a payload view; when block is false,
+// DCF_ERR_TIMEOUT means nothing was queued
+static DCFError dcf_networking_receive_network(DCFNetworking* net, bool block, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    for (;;) {
+        if (net->udp || net->tcp) {
+            const uint8_t* frame;
+            size_t frame_len;
+            DCFError err;
+            if (net->udp) err = block ? dcf_udp_transport_receive(net->udp, &frame, &frame_len) : dcf_udp_transport_try_receive(net->udp, &frame, &frame_len);
+            else err = block ? dcf_tcp_transport_receive(net->tcp, &frame, &frame_len) : dcf_tcp_transport_try_receive(net->tcp, &frame, &frame_len);
+            if (err != DCF_SUCCESS) return err;
+            if (dcf_networking_consumed(net, frame, frame_len)) continue;
+            return dcf_deserialize_payload_view(frame, frame_len, payload_out, payload_len_out, sender_out);
+        }
+        size_t len;
+        uint8_t* data;
+        if (block) {
+            if (!grpc_wrapper_receive(net->grpc_handle, &data, &len)) return DCF_ERR_GRPC_FAIL;
+        } else {
+            int result = grpc_wrapper_try_receive(net->grpc_handle, &data, &len);
+            if (result == 0) return DCF_ERR_TIMEOUT;
+            if (result < 0) return DCF_ERR_GRPC_FAIL;
+        }
+        if (dcf_networking_consumed(net, data, len)) {
+            free(data);
+            continue;
+        }
+        // The view is unpacked into the arena, so the wrapper's buffer can go
+        DCFError err = dcf_deserialize_payload_view(data, len, payload_out, payload_len_out, sender_out);
+        free(data);
+        return err;
+    }
+}
+
+static DCFError dcf_networking_copy_view(DCFError err, const char* message, const char* sender, char** message_out, char** sender_out) {
+    if (err != DCF_SUCCESS) return err;
+    *message_out = strdup(message);
+    *sender_out = strdup(sender);
+    if (!*message_out || !*sender_out) {
+        free(*message_out);
+        free(*sender_out);
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_networking_try_receive_payload(DCFNetworking* net, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    if (!net || !payload_out || !payload_len_out || !sender_out) return DCF_ERR_NULL_PTR;
+    while (net->shm_inbound) {
+        const uint8_t* data;
+        size_t len;
+        DCFError err = dcf_shm_transport_receive(net->shm, 0, &data, &len);
+        if (err == DCF_ERR_TIMEOUT) break;
+        if (err != DCF_SUCCESS) return err;
+        if (!dcf_networking_consumed(net, data, len)) return dcf_deserialize_payload_view(data, len, payload_out, payload_len_out, sender_out);
+    }
+    return dcf_networking_receive_network(net, false, payload_out, payload_len_out, sender_out);
+}
+
+DCFError dcf_networking_receive_payload(DCFNetworking* net, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    if (!net || !payload_out || !payload_len_out || !sender_out) return DCF_ERR_NULL_PTR;
+    if (!net->shm_inbound) return dcf_networking_receive_network(net, true, payload_out, payload_len_out, sender_out);
+    // Several sources: drain them without blocking, then sleep until one turns readable
+    int fd = dcf_networking_get_fd(net);
+    if (fd < 0) return DCF_ERR_NETWORK_FAIL;
+    while (true) {
+        DCFError err = dcf_networking_try_receive_payload(net, payload_out, payload_len_out, sender_out);
+        if (err != DCF_ERR_TIMEOUT) return err;
+        struct epoll_event ev;
+        if (epoll_wait(fd, &ev, 1, -1) < 0 && errno != EINTR) return DCF_ERR_NETWORK_FAIL;
+    }
+}
+
+DCFError dcf_networking_try_receive_view(DCFNetworking* net, const char** message_out, const char** sender_out) {
+    if (!message_out) return DCF_ERR_NULL_PTR;
+    // Arena payloads are NUL-terminated, so the byte view doubles as a string
+    const uint8_t* payload;
+    size_t payload_len;
+    DCFError err = dcf_networking_try_receive_payload(net, &payload, &payload_len, sender_out);
+    if (err == DCF_SUCCESS) *message_out = (const char*)payload;
+    return err;
+}
+
+DCFError dcf_networking_try_receive(DCFNetworking* net, char** message_out, char** sender_out) {
+    if (!net || !message_out || !sender_out) return DCF_ERR_NULL_PTR;
+    const char* message;
+    const char* sender;
+    DCFError err = dcf_networking_try_receive_view(net, &message, &sender);
+    return dcf_networking_copy_view(err, message, sender, message_out, sender_out);
+}
+
+int dcf_networking_get_fd(DCFNetworking* net) {
+    if (!net) return -1;
+    if (net->epoll_fd >= 0) return net->epoll_fd;
+    int sources[2] = {-1, -1};
+    if (net->udp) sources[0] = dcf_udp_transport_get_fd(net->udp);
+    else if (net->tcp) sources[0] = dcf_tcp_transport_get_fd(net->tcp);
+    else if (net->grpc_handle) sources[0] = grpc_wrapper_get_fd(net->grpc_handle);
+    if (net->shm_inbound) sources[1] = dcf_shm_transport_get_fd(net->shm);
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) return -1;
+    for (size_t i = 0; i < 2; i++) {
+        if (sources[i] < 0) continue;
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = sources[i] };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sources[i], &ev) != 0) {
+            close(epoll_fd);
+            return -1;
+        }
+    }
+    net->epoll_fd = epoll_fd;
+    return epoll_fd;
+}
+
 DCFError dcf_networking_receive(DCFNetworking* net, char** message_out, char** sender_out) {
     if (!net || !message_out || !sender_out) return DCF_ERR_NULL_PTR;
-    size_t len;
-    uint8_t* data;
-    char* sender;
-    if (!grpc_wrapper_receive(net->grpc_handle, &data, &len, &sender)) return DCF_ERR_GRPC_FAIL;
-    DCFError err = dcf_deserialize_message(data, len, message_out, sender_out);
-    free(data);
-    free(sender);
-    return err;
+    const uint8_t* payload;
+    size_t payload_len;
+    const char* sender;
+    DCFError err = dcf_networking_receive_payload(net, &payload, &payload_len, &sender);
+    return dcf_networking_copy_view(err, (const char*)payload, sender, message_out, sender_out);
 }
 
 void dcf_networking_free(DCFNetworking* net) {
     if (!net) return;
     if (net->grpc_handle) grpc_wrapper_free(net->grpc_handle);
+    dcf_udp_transport_free(net->udp);
+    dcf_tcp_transport_free(net->tcp);
+    dcf_shm_transport_free(net->shm);
+    if (net->epoll_fd >= 0) close(net->epoll_fd);
+    dcf_dedup_free(net->dedup);
     free(net->host);
+    free(net->node_id);
+    free(net->address);
     free(net);
 }
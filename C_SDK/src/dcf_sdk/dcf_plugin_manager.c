@@ -52,6 +52,13 @@ ITransport* dcf_plugin_manager_get_transport(DCFPluginManager* manager) {
     return manager->transport;
 }
 
+DCFError dcf_plugin_manager_set_transport(DCFPluginManager* manager, ITransport* transport) {
+    if (!manager || !transport) return DCF_ERR_NULL_PTR;
+    if (manager->transport && manager->transport->destroy) manager->transport->destroy(manager->transport);
+    manager->transport = transport;
+    return DCF_SUCCESS;
+}
+
 void dcf_plugin_manager_free(DCFPluginManager* manager) {
     if (!manager) return;
     if (manager->transport && manager->transport->destroy) manager->transport->destroy(manager->transport);
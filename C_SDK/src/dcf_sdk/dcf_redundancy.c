@@ -1,136 +1,1272 @@
 #include "dcf_redundancy.h"
 #include "dcf_serialization.h"
+#include "dcf_coordinate.h"
+#include "dcf_membership.h"
+#include "dcf_message_view.h"
+#include "dcf_routing.h"
+#include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <limits.h>
 
+// RFC 6298 smoothing: srtt gains 1/8 of each sample's error, rttvar 1/4 of its deviation
+#define DCF_RTT_ALPHA_SHIFT 3
+#define DCF_RTT_BETA_SHIFT 2
+// Loss rate is an EWMA of per-probe loss with the same 1/8 gain
+#define DCF_LOSS_GAIN 0.125f
+// A sample within this many rttvars (plus a floor) of srtt counts as stable
+#define DCF_PROBE_STABLE_RTTVARS 2
+#define DCF_PROBE_STABLE_FLOOR_US 1000
+// Heartbeat gap mean and variance use the same 1/8 gain; data-path heartbeats
+// closer together than this are dropped so busy peers don't contend on the lock
+#define DCF_PHI_GAIN 0.125f
+#define DCF_PHI_MIN_GAP_US 1000
+// Gaps needed before a peer can be suspected
+#define DCF_PHI_MIN_HEARTBEATS 3
+// Each gossip update rides on this many times log2 of the cluster size messages
+#define DCF_GOSSIP_RETRANSMIT_MULT 3
+// Peer index slot of a removed peer, which lookups probe past
+#define DCF_PEER_TOMBSTONE (DCF_PEER_NONE - 1)
+// How long a removed peer's address, or a replaced index, outlives its removal
+// for lock-free readers that loaded it just before
+#define DCF_PEER_RETIRE_US 10000000u
+
+enum { DCF_GROUP_UNKNOWN, DCF_GROUP_LOCAL, DCF_GROUP_REMOTE, DCF_GROUP_UNREACHABLE };
+static const char* const dcf_group_names[] = { NULL, "local", "remote", "unreachable" };
+
+// Completion context for peer's in-flight probe, one per peer so probing never allocates
+typedef struct {
+    DCFRedundancy* redundancy;
+    size_t peer;
+} DCFProbeSlot;
+
+// Open-addressed address -> DCFPeerId, DCF_PEER_NONE when empty. Replaced
+// whole when tombstones pile up, so lock-free readers never see it rehash.
+typedef struct {
+    size_t cap;             // power of two, at least twice peer_cap
+    size_t used;            // slots holding an id or a tombstone
+    DCFPeerId slots[];
+} DCFPeerIndex;
+
 struct DCFRedundancy {
+    // NULL for a vacant id. Lock-free readers load entries with acquire.
     char** peers;
+    // One past the highest id handed out, under both probe_mutex and stats_mutex.
+    // It grows as gossip discovers peers; the new slot is filled before the count
+    // is stored with release, so lock-free readers load it with acquire.
     size_t peer_count;
-    int* rtt_cache;
-    char** groups;
+    size_t peer_cap;        // every per-peer array holds this many
+    size_t seed_count;      // configured peers hold ids below this and are never removed
+    // Ids of removed peers, reused before peer_count grows; under both mutexes
+    DCFPeerId* free_ids;
+    size_t free_count;
+    // Addresses and indexes lock-free readers may still hold, freed DCF_PEER_RETIRE_US
+    // after they were replaced; under both mutexes
+    void** retired;
+    uint64_t* retired_us;
+    size_t retired_count;
+    size_t retired_cap;
+    DCFPeerIndex* peer_index;
+    // Link statistics as parallel arrays indexed by DCFPeerId. Writers hold
+    // stats_mutex; srtt_us and groups are also stored atomically for lock-free readers.
+    uint32_t* srtt_us;      // DCF_RTT_UNKNOWN until measured, DCF_RTT_UNREACHABLE after a failure
+    uint32_t* rttvar_us;
+    uint32_t* min_rtt_us;
+    float* loss_rate;
+    uint32_t* probes;
+    uint8_t* groups;
+    pthread_mutex_t stats_mutex;
+    // Links from this node weighted by srtt, plus those neighbors report; routes are read from here
+    DCFRoutingTable* routes;
+    char* self;
+    DCFRouteNode* route_nodes;  // each peer's routing handle, tagged with its DCFPeerId
+    // Vivaldi coordinates, also under stats_mutex: ours moves with every RTT sample
+    // to a peer whose coordinate came back on its ack, so any pair's RTT can be
+    // estimated without having probed it
+    DCFCoordinate coord;
+    DCFCoordinate* peer_coords;
+    uint8_t* has_coord;
+    unsigned int coord_seed;
+    // Phi-accrual failure detector over heartbeat gaps, i.e. probe replies and
+    // data-path arrivals, also under stats_mutex. suspect_at_us is when phi will
+    // cross phi_threshold, stored atomically so the send path checks it lock-free.
+    uint64_t* last_heard_us;
+    float* gap_mean_us;
+    float* gap_var_us2;
+    uint32_t* heartbeats;
+    uint64_t* suspect_at_us;    // UINT64_MAX while suspected or not yet judged
+    uint8_t* suspected;
+    // A probe to the peer has come back with a reply. Only then is the detector
+    // armed: over one-way transports a quiet peer may just have nothing to say,
+    // and no probe could ever clear the suspicion.
+    uint8_t* answers;
+    double phi_threshold;       // 0 disables the detector
+    float phi_y;                // standard deviations past the mean gap where phi reaches the threshold
+    float phi_min_std_us;
+    uint64_t phi_pause_us;
+    // Prober schedule, also parallel arrays, guarded by probe_mutex
+    uint64_t* next_probe_us;
+    uint32_t* interval_ms;
+    uint64_t* probe_start_us;
+    uint8_t* probing;
+    uint8_t* departed;      // gossip declared the peer dead, so it is no longer probed
+    uint8_t* leaving;       // removed while a probe was in flight; vacated when it completes
+    DCFProbeSlot* probe_slots;
+    pthread_mutex_t probe_mutex;
+    pthread_cond_t probe_cond;  // on CLOCK_MONOTONIC; signalled on completions and schedule changes
+    size_t in_flight;
+    bool prober_running;
+    pthread_t prober_thread;
+    unsigned int jitter_seed;
+    int probe_interval_ms;
+    int probe_base_interval_ms; // probe_interval_ms before the neighbor budget stretched it
+    int probe_neighbors;
+    int probe_max_interval_ms;
+    int probe_timeout_ms;
+    int probe_concurrency;
+    bool probe_budgeted;    // probe_neighbors stretched the interval below one sweep per interval
     int rtt_threshold;
+    // SWIM gossip, NULL unless gossip_interval_ms is set. Its callbacks take
+    // probe_mutex and stats_mutex, so it is only driven without them held.
+    DCFMembership* membership;
+    pthread_cond_t gossip_cond; // on CLOCK_MONOTONIC, with probe_mutex
+    bool gossip_running;
+    pthread_t gossip_thread;
     DCFNetworking* networking;
     bool running;
     DCFMode mode;
 };
 
+static uint64_t dcf_redundancy_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static uint32_t dcf_redundancy_hash(const char* s) {
+    uint32_t hash = 2166136261u;
+    while (*s) hash = (hash ^ (uint8_t)*s++) * 16777619u;
+    return hash;
+}
+
+static DCFPeerId dcf_redundancy_find(DCFRedundancy* redundancy, const char* peer) {
+    DCFPeerIndex* index = __atomic_load_n(&redundancy->peer_index, __ATOMIC_ACQUIRE);
+    if (!index) return DCF_PEER_NONE;
+    size_t mask = index->cap - 1;
+    for (size_t slot = dcf_redundancy_hash(peer) & mask;; slot = (slot + 1) & mask) {
+        DCFPeerId id = __atomic_load_n(&index->slots[slot], __ATOMIC_ACQUIRE);
+        if (id == DCF_PEER_NONE) return DCF_PEER_NONE;
+        if (id == DCF_PEER_TOMBSTONE) continue;
+        // An id removed and reused since the slot was read names another address
+        const char* address = __atomic_load_n(&redundancy->peers[id], __ATOMIC_ACQUIRE);
+        if (address && strcmp(address, peer) == 0) return id;
+    }
+}
+
+// Indexes peer i unless its address already has an id, reusing the first
+// tombstone on the way. The slot is stored with release, so a lock-free find
+// that sees it also sees the peer's address.
+static void dcf_redundancy_index_insert(DCFRedundancy* redundancy, DCFPeerIndex* index, DCFPeerId i) {
+    size_t mask = index->cap - 1;
+    size_t slot = dcf_redundancy_hash(redundancy->peers[i]) & mask;
+    size_t target = SIZE_MAX;
+    for (; index->slots[slot] != DCF_PEER_NONE; slot = (slot + 1) & mask) {
+        DCFPeerId id = index->slots[slot];
+        if (id == DCF_PEER_TOMBSTONE) {
+            if (target == SIZE_MAX) target = slot;
+        } else if (strcmp(redundancy->peers[id], redundancy->peers[i]) == 0) {
+            return;
+        }
+    }
+    if (target == SIZE_MAX) {
+        target = slot;
+        index->used++;
+    }
+    __atomic_store_n(&index->slots[target], i, __ATOMIC_RELEASE);
+}
+
+// A fresh index of every peer; a duplicated address keeps its first id
+static DCFPeerIndex* dcf_redundancy_build_index(DCFRedundancy* redundancy) {
+    size_t cap = 16;
+    while (cap < redundancy->peer_cap * 2) cap *= 2;
+    DCFPeerIndex* index = malloc(sizeof(DCFPeerIndex) + cap * sizeof(DCFPeerId));
+    if (!index) return NULL;
+    memset(index->slots, 0xff, cap * sizeof(DCFPeerId));
+    index->cap = cap;
+    index->used = 0;
+    for (size_t i = 0; i < redundancy->peer_count; i++) {
+        if (redundancy->peers[i]) dcf_redundancy_index_insert(redundancy, index, (DCFPeerId)i);
+    }
+    return index;
+}
+
+// Frees what has been retired for long enough; the caller holds both mutexes
+static void dcf_redundancy_reclaim(DCFRedundancy* redundancy, uint64_t now) {
+    size_t kept = 0;
+    for (size_t r = 0; r < redundancy->retired_count; r++) {
+        if (now - redundancy->retired_us[r] >= DCF_PEER_RETIRE_US) {
+            free(redundancy->retired[r]);
+        } else {
+            redundancy->retired[kept] = redundancy->retired[r];
+            redundancy->retired_us[kept++] = redundancy->retired_us[r];
+        }
+    }
+    redundancy->retired_count = kept;
+}
+
+// Frees p once lock-free readers are done with it; the caller holds both mutexes.
+// Leaked when the list can't grow, as freeing it early would be worse.
+static void dcf_redundancy_retire(DCFRedundancy* redundancy, void* p) {
+    uint64_t now = dcf_redundancy_now_us();
+    dcf_redundancy_reclaim(redundancy, now);
+    if (redundancy->retired_count == redundancy->retired_cap) {
+        size_t cap = redundancy->retired_cap ? redundancy->retired_cap * 2 : 16;
+        void** retired = realloc(redundancy->retired, cap * sizeof(void*));
+        if (retired) redundancy->retired = retired;
+        uint64_t* retired_us = realloc(redundancy->retired_us, cap * sizeof(uint64_t));
+        if (retired_us) redundancy->retired_us = retired_us;
+        if (!retired || !retired_us) return;
+        redundancy->retired_cap = cap;
+    }
+    redundancy->retired[redundancy->retired_count] = p;
+    redundancy->retired_us[redundancy->retired_count++] = now;
+}
+
 DCFRedundancy* dcf_redundancy_new(void) {
     DCFRedundancy* redundancy = calloc(1, sizeof(DCFRedundancy));
     if (!redundancy) return NULL;
+    pthread_mutex_init(&redundancy->stats_mutex, NULL);
+    pthread_mutex_init(&redundancy->probe_mutex, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&redundancy->probe_cond, &attr);
+    pthread_cond_init(&redundancy->gossip_cond, &attr);
+    pthread_condattr_destroy(&attr);
     return redundancy;
 }
 
+// Phi as approximated in the phi-accrual paper's follow-ups: a logistic fit of
+// the normal CDF, -log10 of the chance the next heartbeat is still this late
+static double dcf_redundancy_phi(double y) {
+    double e = exp(-y * (1.5976 + 0.070566 * y * y));
+    return y > 0 ? -log10(e / (1 + e)) : -log10(1 - 1 / (1 + e));
+}
+
+// Solves phi(y) = threshold once, so each peer's suspicion time is a multiply-add
+static float dcf_redundancy_phi_y(double threshold) {
+    if (threshold <= 0) return 0;
+    double lo = 0, hi = 64;
+    for (int i = 0; i < 64; i++) {
+        double mid = (lo + hi) / 2;
+        if (dcf_redundancy_phi(mid) < threshold) lo = mid;
+        else hi = mid;
+    }
+    return (float)hi;
+}
+
+// When peer i's phi will reach the threshold; the caller holds stats_mutex
+static void dcf_redundancy_schedule_suspicion(DCFRedundancy* redundancy, size_t i) {
+    uint64_t at = UINT64_MAX;
+    if (redundancy->phi_threshold > 0 && redundancy->answers[i] && !redundancy->suspected[i] && redundancy->heartbeats[i] >= DCF_PHI_MIN_HEARTBEATS) {
+        float std = sqrtf(redundancy->gap_var_us2[i]);
+        if (std < redundancy->phi_min_std_us) std = redundancy->phi_min_std_us;
+        at = redundancy->last_heard_us[i] + redundancy->phi_pause_us + (uint64_t)(redundancy->gap_mean_us[i] + redundancy->phi_y * std);
+    }
+    __atomic_store_n(&redundancy->suspect_at_us[i], at, __ATOMIC_RELAXED);
+}
+
+// The direct link to peer i back in the routing table, weighted as before it was suspected
+static void dcf_redundancy_restore_link(DCFRedundancy* redundancy, size_t i) {
+    uint32_t srtt = redundancy->srtt_us[i];
+    dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, redundancy->route_nodes[i], srtt < DCF_RTT_UNKNOWN ? srtt : DCF_RTT_UNKNOWN);
+    uint8_t group = srtt >= DCF_RTT_UNKNOWN ? DCF_GROUP_UNKNOWN :
+                    (uint64_t)srtt < (uint64_t)redundancy->rtt_threshold * 1000 ? DCF_GROUP_LOCAL : DCF_GROUP_REMOTE;
+    __atomic_store_n(&redundancy->groups[i], group, __ATOMIC_RELAXED);
+}
+
+// A heartbeat from peer i: folds the gap into its model and clears any suspicion.
+// The caller holds stats_mutex.
+static void dcf_redundancy_heard(DCFRedundancy* redundancy, size_t i, uint64_t now) {
+    uint64_t last = redundancy->last_heard_us[i];
+    if (last && now > last) {
+        float gap = (float)(now - last);
+        if (redundancy->heartbeats[i] < 2) {
+            redundancy->gap_mean_us[i] = gap;
+            redundancy->gap_var_us2[i] = gap * gap / 4;
+        } else {
+            float diff = gap - redundancy->gap_mean_us[i];
+            redundancy->gap_mean_us[i] += diff * DCF_PHI_GAIN;
+            redundancy->gap_var_us2[i] += (diff * diff - redundancy->gap_var_us2[i]) * DCF_PHI_GAIN;
+        }
+    }
+    redundancy->heartbeats[i]++;
+    __atomic_store_n(&redundancy->last_heard_us[i], now, __ATOMIC_RELAXED);
+    if (redundancy->suspected[i]) {
+        redundancy->suspected[i] = 0;
+        dcf_redundancy_restore_link(redundancy, i);
+    }
+    dcf_redundancy_schedule_suspicion(redundancy, i);
+}
+
+// Takes peer i out of routing, so sends fail over on the next route lookup.
+// Returns false when it already was; takes stats_mutex.
+static bool dcf_redundancy_mark_suspect(DCFRedundancy* redundancy, size_t i) {
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    bool fresh = !redundancy->suspected[i];
+    if (fresh) {
+        redundancy->suspected[i] = 1;
+        dcf_redundancy_schedule_suspicion(redundancy, i);
+        dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, redundancy->route_nodes[i], DCF_ROUTE_NO_LINK);
+        __atomic_store_n(&redundancy->groups[i], DCF_GROUP_UNREACHABLE, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    return fresh;
+}
+
+// Puts our current coordinate on every ack this node sends from now on
+static void dcf_redundancy_publish_coordinate(DCFRedundancy* redundancy) {
+    uint8_t encoded[DCF_COORDINATE_WIRE_SIZE];
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    dcf_coordinate_encode(&redundancy->coord, encoded);
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    dcf_networking_set_ack_data(redundancy->networking, encoded, sizeof(encoded));
+}
+
+// The coordinate a probe reply carries in its data field, if any
+static bool dcf_redundancy_reply_coordinate(const uint8_t* response, size_t response_len, DCFCoordinate* coord_out) {
+    DCFMessageView view;
+    if (!response || dcf_message_view_parse(response, response_len, DCF_VIEW_DATA, &view) != DCF_SUCCESS) return false;
+    return dcf_coordinate_decode(view.data.data, view.data.len, coord_out) == DCF_SUCCESS;
+}
+
+// With a neighbor budget each peer is probed less often as the mesh grows, so
+// this node sends about probe_neighbors probes per interval whatever its size
+// and coordinates estimate the RTTs in between. Rerun whenever a peer is added,
+// with probe_mutex held once the table is shared.
+static void dcf_redundancy_budget(DCFRedundancy* redundancy) {
+    size_t n = redundancy->peer_count - redundancy->free_count;
+    int neighbors = redundancy->probe_neighbors;
+    redundancy->probe_interval_ms = redundancy->probe_base_interval_ms;
+    redundancy->probe_budgeted = false;
+    if (neighbors > 0 && n > (size_t)neighbors && redundancy->probe_interval_ms > 0) {
+        size_t rounds = (n + neighbors - 1) / neighbors;
+        uint64_t interval = (uint64_t)redundancy->probe_interval_ms * rounds;
+        redundancy->probe_interval_ms = interval < INT_MAX ? (int)interval : INT_MAX;
+        redundancy->probe_budgeted = true;
+    }
+    if (redundancy->probe_max_interval_ms < redundancy->probe_interval_ms) redundancy->probe_max_interval_ms = redundancy->probe_interval_ms;
+}
+
+// Fills peer i's slot, whose address is set, as an unmeasured link, clearing
+// whatever a removed peer left in it; the caller holds probe_mutex and
+// stats_mutex once the table is shared
+static DCFError dcf_redundancy_init_peer(DCFRedundancy* redundancy, size_t i) {
+    __atomic_store_n(&redundancy->srtt_us[i], DCF_RTT_UNKNOWN, __ATOMIC_RELAXED);
+    redundancy->rttvar_us[i] = 0;
+    redundancy->min_rtt_us[i] = DCF_RTT_UNKNOWN;
+    redundancy->loss_rate[i] = 0;
+    redundancy->probes[i] = 0;
+    __atomic_store_n(&redundancy->groups[i], DCF_GROUP_UNKNOWN, __ATOMIC_RELAXED);
+    redundancy->has_coord[i] = 0;
+    __atomic_store_n(&redundancy->last_heard_us[i], 0, __ATOMIC_RELAXED);
+    redundancy->gap_mean_us[i] = 0;
+    redundancy->gap_var_us2[i] = 0;
+    redundancy->heartbeats[i] = 0;
+    redundancy->suspected[i] = 0;
+    redundancy->answers[i] = 0;
+    redundancy->departed[i] = 0;
+    redundancy->leaving[i] = 0;
+    redundancy->interval_ms[i] = redundancy->probe_interval_ms;
+    __atomic_store_n(&redundancy->suspect_at_us[i], UINT64_MAX, __ATOMIC_RELAXED);
+    redundancy->probe_slots[i].redundancy = redundancy;
+    redundancy->probe_slots[i].peer = i;
+    DCFRouteNode node = dcf_routing_node(redundancy->routes, redundancy->peers[i]);
+    if (node == DCF_ROUTE_NODE_NONE) return DCF_ERR_MALLOC_FAIL;
+    redundancy->route_nodes[i] = node;
+    if (node == DCF_ROUTE_SELF) return DCF_SUCCESS;
+    // The tag maps a first hop back to its peer; a duplicated address keeps its first id
+    DCFPeerId first = dcf_redundancy_find(redundancy, redundancy->peers[i]);
+    if (first == DCF_PEER_NONE || first == i) dcf_routing_set_tag(redundancy->routes, node, (uint32_t)i);
+    // Unmeasured links weigh more than any measured one, so they are used only as a last resort
+    return dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, node, DCF_RTT_UNKNOWN);
+}
+
+// Indexes peer i, first replacing the index when tombstones leave under a
+// quarter of it empty; the caller holds both mutexes
+static DCFError dcf_redundancy_index_add(DCFRedundancy* redundancy, DCFPeerId i) {
+    DCFPeerIndex* index = redundancy->peer_index;
+    if ((index->used + 1) * 4 > index->cap * 3) {
+        DCFPeerIndex* fresh = dcf_redundancy_build_index(redundancy);
+        if (!fresh) return DCF_ERR_MALLOC_FAIL;
+        __atomic_store_n(&redundancy->peer_index, fresh, __ATOMIC_RELEASE);
+        dcf_redundancy_retire(redundancy, index);
+        index = fresh;
+    }
+    dcf_redundancy_index_insert(redundancy, index, i);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_redundancy_add_peer(DCFRedundancy* redundancy, const char* peer, DCFPeerId* id_out) {
+    if (!redundancy || !peer) return DCF_ERR_NULL_PTR;
+    if (!redundancy->routes) return DCF_ERR_INVALID_STATE;
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    DCFPeerId id = dcf_redundancy_find(redundancy, peer);
+    DCFError err = DCF_SUCCESS;
+    if (id != DCF_PEER_NONE && redundancy->leaving[id]) {
+        // Back before its removal finished, so it keeps its id and statistics
+        redundancy->leaving[id] = 0;
+        redundancy->departed[id] = 0;
+    } else if (id == DCF_PEER_NONE && !redundancy->free_count && redundancy->peer_count == redundancy->peer_cap) {
+        err = DCF_ERR_INVALID_STATE;
+    } else if (id == DCF_PEER_NONE) {
+        // Removed peers' ids are reused before the table grows
+        bool reused = redundancy->free_count > 0;
+        size_t i = reused ? redundancy->free_ids[--redundancy->free_count] : redundancy->peer_count;
+        char* address = strdup(peer);
+        __atomic_store_n(&redundancy->peers[i], address, __ATOMIC_RELEASE);
+        err = address ? dcf_redundancy_init_peer(redundancy, i) : DCF_ERR_MALLOC_FAIL;
+        if (err == DCF_SUCCESS) err = dcf_redundancy_index_add(redundancy, (DCFPeerId)i);
+        if (err == DCF_SUCCESS) {
+            // Like the first sweep, its first probe lands somewhere in the next interval
+            uint64_t spread = (uint64_t)redundancy->probe_interval_ms * 1000;
+            redundancy->next_probe_us[i] = dcf_redundancy_now_us() + (uint64_t)rand_r(&redundancy->jitter_seed) * spread / ((uint64_t)RAND_MAX + 1);
+            if (!reused) __atomic_store_n(&redundancy->peer_count, i + 1, __ATOMIC_RELEASE);
+            dcf_redundancy_budget(redundancy);
+            pthread_cond_broadcast(&redundancy->probe_cond);
+            id = (DCFPeerId)i;
+        } else {
+            __atomic_store_n(&redundancy->peers[i], NULL, __ATOMIC_RELEASE);
+            free(address);
+            // Kept out of the probe sweep until the id is handed out again
+            redundancy->departed[i] = 1;
+            if (reused) redundancy->free_ids[redundancy->free_count++] = (DCFPeerId)i;
+        }
+    }
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    if (err == DCF_SUCCESS && id_out) *id_out = id;
+    return err;
+}
+
+// Takes peer i out of the table and frees its id for reuse; the caller holds
+// both mutexes and has checked no probe of it is in flight
+static void dcf_redundancy_vacate(DCFRedundancy* redundancy, DCFPeerId i) {
+    DCFPeerIndex* index = redundancy->peer_index;
+    size_t mask = index->cap - 1;
+    for (size_t slot = dcf_redundancy_hash(redundancy->peers[i]) & mask; index->slots[slot] != DCF_PEER_NONE; slot = (slot + 1) & mask) {
+        if (index->slots[slot] == i) {
+            __atomic_store_n(&index->slots[slot], DCF_PEER_TOMBSTONE, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    // Its routing node stays, unlinked, in case the address comes back
+    if (redundancy->route_nodes[i] != DCF_ROUTE_SELF) {
+        dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, redundancy->route_nodes[i], DCF_ROUTE_NO_LINK);
+        dcf_routing_set_tag(redundancy->routes, redundancy->route_nodes[i], DCF_ROUTE_NODE_NONE);
+    }
+    __atomic_store_n(&redundancy->suspect_at_us[i], UINT64_MAX, __ATOMIC_RELAXED);
+    __atomic_store_n(&redundancy->groups[i], DCF_GROUP_UNKNOWN, __ATOMIC_RELAXED);
+    redundancy->has_coord[i] = 0;
+    redundancy->leaving[i] = 0;
+    redundancy->departed[i] = 1;
+    dcf_redundancy_retire(redundancy, redundancy->peers[i]);
+    __atomic_store_n(&redundancy->peers[i], NULL, __ATOMIC_RELEASE);
+    redundancy->free_ids[redundancy->free_count++] = i;
+    dcf_redundancy_budget(redundancy);
+}
+
+DCFError dcf_redundancy_remove_peer(DCFRedundancy* redundancy, const char* peer) {
+    if (!redundancy || !peer) return DCF_ERR_NULL_PTR;
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    DCFPeerId id = dcf_redundancy_find(redundancy, peer);
+    DCFError err = DCF_SUCCESS;
+    if (id == DCF_PEER_NONE || redundancy->leaving[id]) {
+        err = DCF_ERR_ROUTE_NOT_FOUND;
+    } else if (id < redundancy->seed_count) {
+        err = DCF_ERR_INVALID_ARG;
+    } else if (redundancy->probing[id]) {
+        // The probe's completion still writes to the slot, so it vacates it
+        redundancy->departed[id] = 1;
+        redundancy->leaving[id] = 1;
+    } else {
+        dcf_redundancy_vacate(redundancy, id);
+    }
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    return err;
+}
+
+// Gossip travels as the data of a DCFMessage in group DCF_GROUP_GOSSIP, sent and
+// forgotten: the protocol's own timeouts deal with what gets lost
+static void dcf_redundancy_gossip_send(void* user_data, const char* address, const uint8_t* data, size_t len) {
+    DCFRedundancy* redundancy = user_data;
+    DCFEnvelope* envelope = dcf_envelope_new(redundancy->self, address, NULL, DCF_GROUP_GOSSIP);
+    const uint8_t* message;
+    size_t message_len;
+    DCFError err = envelope ? dcf_envelope_pack_scratch(envelope, data, len, 0, 0, &message, &message_len) : DCF_ERR_MALLOC_FAIL;
+    dcf_envelope_free(envelope);
+    if (err != DCF_SUCCESS) return;
+    dcf_networking_send_async(redundancy->networking, message, message_len, address, redundancy->probe_timeout_ms, NULL, NULL);
+}
+
+// Members feed the peer table. Gossip's verdicts steer our probing, but for
+// peers that answer probes our own replies still decide whether it is in routing.
+static void dcf_redundancy_gossip_changed(void* user_data, const char* address, DCFMemberState state) {
+    DCFRedundancy* redundancy = user_data;
+    DCFPeerId id;
+    if (state == DCF_MEMBER_ALIVE) {
+        if (dcf_redundancy_add_peer(redundancy, address, &id) != DCF_SUCCESS) return;
+    } else {
+        id = dcf_redundancy_find(redundancy, address);
+        if (id == DCF_PEER_NONE) return;
+    }
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    // Removed, and perhaps handed to another address, since it was looked up
+    if (!redundancy->peers[id] || redundancy->leaving[id] || strcmp(redundancy->peers[id], address) != 0) {
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+        return;
+    }
+    if (state != DCF_MEMBER_ALIVE) dcf_redundancy_mark_suspect(redundancy, id);
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    bool suspected = redundancy->suspected[id];
+    // Probes that never reply can't clear a suspicion, so gossip's word stands
+    if (state == DCF_MEMBER_ALIVE && suspected && !redundancy->answers[id]) {
+        redundancy->suspected[id] = 0;
+        dcf_redundancy_restore_link(redundancy, id);
+        dcf_redundancy_schedule_suspicion(redundancy, id);
+    }
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    bool was_departed = redundancy->departed[id];
+    redundancy->departed[id] = state == DCF_MEMBER_DEAD;
+    // A suspect, or one that came back, is probed at once to settle it for ourselves
+    if (state == DCF_MEMBER_SUSPECT || (state == DCF_MEMBER_ALIVE && (was_departed || suspected))) {
+        redundancy->next_probe_us[id] = 0;
+        redundancy->interval_ms[id] = redundancy->probe_interval_ms;
+        pthread_cond_broadcast(&redundancy->probe_cond);
+    }
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+}
+
+// A member gossip has held dead for gossip_dead_timeout_ms leaves the peer
+// table and frees its id; configured peers stay, as seeds to rejoin through
+static void dcf_redundancy_gossip_removed(void* user_data, const char* address) {
+    dcf_redundancy_remove_peer(user_data, address);
+}
+
+// Gets the data of reserved-group messages, which networking has already kept
+// from the application; anything not gossip is ignored
+static bool dcf_redundancy_gossip_receive(void* user_data, const uint8_t* data, size_t len) {
+    DCFRedundancy* redundancy = user_data;
+    if (!dcf_membership_is_message(data, len)) return false;
+    dcf_membership_handle(redundancy->membership, data, len, dcf_redundancy_now_us());
+    return true;
+}
+
 DCFError dcf_redundancy_initialize(DCFRedundancy* redundancy, DCFConfig* config, DCFNetworking* networking) {
     if (!redundancy || !config || !networking) return DCF_ERR_NULL_PTR;
     redundancy->networking = networking;
     DCFError err = dcf_config_get_peers(config, &redundancy->peers, &redundancy->peer_count);
     if (err != DCF_SUCCESS) return err;
-    redundancy->rtt_cache = calloc(redundancy->peer_count, sizeof(int));
-    if (!redundancy->rtt_cache) return DCF_ERR_MALLOC_FAIL;
-    redundancy->groups = calloc(redundancy->peer_count, sizeof(char*));
-    if (!redundancy->groups) { free(redundancy->rtt_cache); return DCF_ERR_MALLOC_FAIL; }
+    // With gossip the table has room for the peers it will discover
+    size_t n = redundancy->peer_count;
+    int gossip_interval_ms = dcf_config_get_gossip_interval_ms(config);
+    size_t max_peers = (size_t)dcf_config_get_max_peers(config);
+    redundancy->peer_cap = gossip_interval_ms > 0 && max_peers > n ? max_peers : n;
+    redundancy->seed_count = n;
+    if (redundancy->peer_cap >= DCF_PEER_TOMBSTONE) return DCF_ERR_CONFIG_INVALID;
+    char** peers = realloc(redundancy->peers, (redundancy->peer_cap + 1) * sizeof(char*));
+    if (!peers) return DCF_ERR_MALLOC_FAIL;
+    redundancy->peers = peers;
+    redundancy->peer_index = dcf_redundancy_build_index(redundancy);
+    if (!redundancy->peer_index) return DCF_ERR_MALLOC_FAIL;
+    // Without a node_id the routing graph still needs a name for its root. Gossip
+    // names members by the address they are reached at, so it needs node_id to be ours.
+    const char* self = dcf_config_acquire_node_id(config);
+    bool named = self != NULL;
+    redundancy->self = strdup(self ? self : "self");
+    dcf_config_release_node_id(config);
+    if (gossip_interval_ms > 0 && !named) return DCF_ERR_CONFIG_INVALID;
+    if (!redundancy->self) return DCF_ERR_MALLOC_FAIL;
+    redundancy->routes = dcf_routing_new(redundancy->self);
+    if (!redundancy->routes) return DCF_ERR_MALLOC_FAIL;
+    // One spare element so an empty peer list still gets non-NULL arrays
+    size_t cap = redundancy->peer_cap;
+    redundancy->srtt_us = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->rttvar_us = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->min_rtt_us = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->loss_rate = calloc(cap + 1, sizeof(float));
+    redundancy->probes = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->groups = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->next_probe_us = calloc(cap + 1, sizeof(uint64_t));
+    redundancy->interval_ms = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->probe_start_us = calloc(cap + 1, sizeof(uint64_t));
+    redundancy->probing = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->departed = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->leaving = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->free_ids = calloc(cap + 1, sizeof(DCFPeerId));
+    redundancy->probe_slots = calloc(cap + 1, sizeof(DCFProbeSlot));
+    redundancy->route_nodes = calloc(cap + 1, sizeof(DCFRouteNode));
+    redundancy->peer_coords = calloc(cap + 1, sizeof(DCFCoordinate));
+    redundancy->has_coord = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->last_heard_us = calloc(cap + 1, sizeof(uint64_t));
+    redundancy->gap_mean_us = calloc(cap + 1, sizeof(float));
+    redundancy->gap_var_us2 = calloc(cap + 1, sizeof(float));
+    redundancy->heartbeats = calloc(cap + 1, sizeof(uint32_t));
+    redundancy->suspect_at_us = calloc(cap + 1, sizeof(uint64_t));
+    redundancy->suspected = calloc(cap + 1, sizeof(uint8_t));
+    redundancy->answers = calloc(cap + 1, sizeof(uint8_t));
+    if (!redundancy->srtt_us || !redundancy->rttvar_us || !redundancy->min_rtt_us || !redundancy->loss_rate || !redundancy->probes || !redundancy->groups ||
+        !redundancy->next_probe_us || !redundancy->interval_ms || !redundancy->probe_start_us || !redundancy->probing || !redundancy->departed || !redundancy->leaving || !redundancy->free_ids || !redundancy->probe_slots ||
+        !redundancy->route_nodes || !redundancy->peer_coords || !redundancy->has_coord ||
+        !redundancy->last_heard_us || !redundancy->gap_mean_us || !redundancy->gap_var_us2 || !redundancy->heartbeats || !redundancy->suspect_at_us || !redundancy->suspected || !redundancy->answers) return DCF_ERR_MALLOC_FAIL;
+    redundancy->phi_threshold = dcf_config_get_phi_threshold(config);
+    redundancy->phi_y = dcf_redundancy_phi_y(redundancy->phi_threshold);
+    redundancy->phi_min_std_us = dcf_config_get_phi_min_std_ms(config) * 1000.0f;
+    redundancy->phi_pause_us = (uint64_t)dcf_config_get_phi_acceptable_pause_ms(config) * 1000;
+    redundancy->probe_base_interval_ms = dcf_config_get_probe_interval_ms(config);
+    redundancy->probe_neighbors = dcf_config_get_probe_neighbors(config);
+    redundancy->probe_max_interval_ms = dcf_config_get_probe_max_interval_ms(config);
+    redundancy->probe_timeout_ms = dcf_config_get_probe_timeout_ms(config);
+    redundancy->probe_concurrency = dcf_config_get_probe_concurrency(config);
+    dcf_redundancy_budget(redundancy);
+    redundancy->jitter_seed = (unsigned int)dcf_redundancy_now_us();
+    redundancy->coord_seed = redundancy->jitter_seed ^ 0x5bd1e995u;
+    dcf_coordinate_init(&redundancy->coord);
+    for (size_t i = 0; i < n; i++) {
+        err = dcf_redundancy_init_peer(redundancy, i);
+        if (err != DCF_SUCCESS) return err;
+    }
     redundancy->rtt_threshold = dcf_config_get_rtt_threshold(config);
+    if (gossip_interval_ms > 0) {
+        // An ack slower than half a period leaves no time for the indirect probes
+        int ack_timeout_ms = gossip_interval_ms / 2 > 0 ? gossip_interval_ms / 2 : 1;
+        if (ack_timeout_ms > redundancy->probe_timeout_ms) ack_timeout_ms = redundancy->probe_timeout_ms;
+        DCFMembershipOptions options = {
+            .period_ms = (uint32_t)gossip_interval_ms,
+            .ack_timeout_ms = (uint32_t)ack_timeout_ms,
+            .indirect_probes = (uint32_t)dcf_config_get_gossip_indirect_probes(config),
+            .suspicion_mult = (uint32_t)dcf_config_get_gossip_suspicion_mult(config),
+            .retransmit_mult = DCF_GOSSIP_RETRANSMIT_MULT,
+            .dead_timeout_ms = (uint32_t)dcf_config_get_gossip_dead_timeout_ms(config)
+        };
+        DCFMembershipCallbacks callbacks = { dcf_redundancy_gossip_send, dcf_redundancy_gossip_changed, dcf_redundancy_gossip_removed, redundancy };
+        redundancy->membership = dcf_membership_new(redundancy->self, &options, &callbacks);
+        if (!redundancy->membership) return DCF_ERR_MALLOC_FAIL;
+        // Configured peers are the seeds the cluster is joined through
+        for (size_t i = 0; i < n; i++) {
+            if (strcmp(redundancy->peers[i], redundancy->self) != 0) dcf_membership_join(redundancy->membership, redundancy->peers[i]);
+        }
+        dcf_networking_set_control_handler(networking, dcf_redundancy_gossip_receive, redundancy);
+    }
+    dcf_redundancy_publish_coordinate(redundancy);
     dcf_redundancy_group_peers(redundancy);
     return DCF_SUCCESS;
 }
 
+// Next due time for a peer probed every interval_ms, spread over +/-25% so
+// peers that started together drift apart instead of probing in lockstep
+static uint64_t dcf_redundancy_jittered(DCFRedundancy* redundancy, uint64_t now_us, uint32_t interval_ms) {
+    uint64_t interval_us = (uint64_t)interval_ms * 1000;
+    uint64_t spread = interval_us / 2;
+    uint64_t offset = spread ? (uint64_t)rand_r(&redundancy->jitter_seed) * (spread + 1) / ((uint64_t)RAND_MAX + 1) : 0;
+    return now_us + interval_us - spread / 2 + offset;
+}
+
+// Folds one probe outcome into peer i's statistics; the caller holds stats_mutex.
+// has_sample is false for a lost probe or a one-way transport that confirms
+// delivery without a reply. remote is the coordinate the reply carried, or NULL.
+// Returns whether the link looks stable.
+static bool dcf_redundancy_record(DCFRedundancy* redundancy, size_t i, bool lost, bool has_sample, uint32_t sample_us, const DCFCoordinate* remote) {
+    redundancy->probes[i]++;
+    redundancy->loss_rate[i] += ((lost ? 1.0f : 0.0f) - redundancy->loss_rate[i]) * DCF_LOSS_GAIN;
+    if (lost) return false;
+    if (!has_sample) return true;
+    redundancy->answers[i] = 1;
+    dcf_redundancy_heard(redundancy, i, dcf_redundancy_now_us());
+    uint32_t srtt = redundancy->srtt_us[i];
+    bool stable = false;
+    if (srtt >= DCF_RTT_UNKNOWN) {
+        // First sample, or the first since the peer was marked unreachable
+        __atomic_store_n(&redundancy->srtt_us[i], sample_us, __ATOMIC_RELAXED);
+        redundancy->rttvar_us[i] = sample_us / 2;
+    } else {
+        uint32_t deviation = srtt > sample_us ? srtt - sample_us : sample_us - srtt;
+        stable = deviation <= DCF_PROBE_STABLE_RTTVARS * redundancy->rttvar_us[i] + DCF_PROBE_STABLE_FLOOR_US;
+        redundancy->rttvar_us[i] = redundancy->rttvar_us[i] - (redundancy->rttvar_us[i] >> DCF_RTT_BETA_SHIFT) + (deviation >> DCF_RTT_BETA_SHIFT);
+        __atomic_store_n(&redundancy->srtt_us[i], srtt - (srtt >> DCF_RTT_ALPHA_SHIFT) + (sample_us >> DCF_RTT_ALPHA_SHIFT), __ATOMIC_RELAXED);
+    }
+    if (sample_us < redundancy->min_rtt_us[i]) redundancy->min_rtt_us[i] = sample_us;
+    if (remote) {
+        redundancy->peer_coords[i] = *remote;
+        redundancy->has_coord[i] = 1;
+        dcf_coordinate_update(&redundancy->coord, remote, sample_us, &redundancy->coord_seed);
+    }
+    dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, redundancy->route_nodes[i], redundancy->srtt_us[i]);
+    bool local = (uint64_t)redundancy->srtt_us[i] < (uint64_t)redundancy->rtt_threshold * 1000;
+    __atomic_store_n(&redundancy->groups[i], local ? DCF_GROUP_LOCAL : DCF_GROUP_REMOTE, __ATOMIC_RELAXED);
+    return stable;
+}
+
+// Runs on the transport's completion thread, or inline for socket transports
+static void dcf_redundancy_probe_complete(void* user_data, DCFError err, const uint8_t* response, size_t response_len) {
+    DCFProbeSlot* slot = user_data;
+    DCFRedundancy* redundancy = slot->redundancy;
+    size_t i = slot->peer;
+    uint64_t now = dcf_redundancy_now_us();
+    uint64_t elapsed = now - redundancy->probe_start_us[i];
+    // A reply after the deadline counts as lost even if the transport delivered it
+    bool lost = err != DCF_SUCCESS || elapsed > (uint64_t)redundancy->probe_timeout_ms * 1000;
+    // A probe the transport had no room for says nothing about the peer; it is
+    // tried again an interval later
+    bool busy = err == DCF_ERR_BUSY;
+    DCFCoordinate remote;
+    bool has_remote = !lost && dcf_redundancy_reply_coordinate(response, response_len, &remote);
+    bool stable = false;
+    if (!busy) {
+        pthread_mutex_lock(&redundancy->stats_mutex);
+        stable = dcf_redundancy_record(redundancy, i, lost, response != NULL, elapsed < DCF_RTT_UNKNOWN ? (uint32_t)elapsed : DCF_RTT_UNKNOWN - 1, has_remote ? &remote : NULL);
+        pthread_mutex_unlock(&redundancy->stats_mutex);
+    }
+    if (has_remote) dcf_redundancy_publish_coordinate(redundancy);
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    // Stable peers back off towards the maximum interval; any change snaps back to the base
+    uint32_t interval = redundancy->interval_ms[i];
+    if (stable) interval = interval * 2 < (uint32_t)redundancy->probe_max_interval_ms ? interval * 2 : (uint32_t)redundancy->probe_max_interval_ms;
+    else if (!busy) interval = redundancy->probe_interval_ms;
+    if (interval != redundancy->interval_ms[i]) {
+        // Probe replies set the heartbeat pace, so a new interval moves the gap the detector expects
+        pthread_mutex_lock(&redundancy->stats_mutex);
+        float mean = redundancy->gap_mean_us[i] + ((float)interval - (float)redundancy->interval_ms[i]) * 1000;
+        redundancy->gap_mean_us[i] = mean > 0 ? mean : 0;
+        dcf_redundancy_schedule_suspicion(redundancy, i);
+        pthread_mutex_unlock(&redundancy->stats_mutex);
+    }
+    redundancy->interval_ms[i] = interval;
+    redundancy->next_probe_us[i] = dcf_redundancy_jittered(redundancy, now, interval);
+    redundancy->probing[i] = 0;
+    redundancy->in_flight--;
+    if (redundancy->leaving[i]) {
+        pthread_mutex_lock(&redundancy->stats_mutex);
+        dcf_redundancy_vacate(redundancy, (DCFPeerId)i);
+        pthread_mutex_unlock(&redundancy->stats_mutex);
+    }
+    pthread_cond_broadcast(&redundancy->probe_cond);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+}
+
+// Starts a probe of peer i, which the caller has marked probing and counted in
+// in_flight; called without probe_mutex because completion may run inline
+static void dcf_redundancy_launch_probe(DCFRedundancy* redundancy, size_t i) {
+    uint8_t* request;
+    size_t request_len;
+    DCFError err = dcf_serialize_health_request(redundancy->peers[i], &request, &request_len);
+    redundancy->probe_start_us[i] = dcf_redundancy_now_us();
+    if (err == DCF_SUCCESS) {
+        err = dcf_networking_send_async(redundancy->networking, request, request_len, redundancy->peers[i], redundancy->probe_timeout_ms,
+                                        dcf_redundancy_probe_complete, &redundancy->probe_slots[i]);
+        free(request);
+    }
+    // A send that failed to start never reaches the callback
+    if (err != DCF_SUCCESS) dcf_redundancy_probe_complete(&redundancy->probe_slots[i], err, NULL, 0);
+}
+
+// Claims up to max due peers for probing; the caller holds probe_mutex.
+// Sets *next_due_out to the earliest due time among peers left waiting.
+static size_t dcf_redundancy_claim_due(DCFRedundancy* redundancy, uint64_t now, size_t* claimed, size_t max, uint64_t* next_due_out) {
+    size_t count = 0;
+    uint64_t next_due = UINT64_MAX;
+    for (size_t i = 0; i < redundancy->peer_count; i++) {
+        if (redundancy->probing[i] || redundancy->departed[i]) continue;
+        if (redundancy->next_probe_us[i] > now || count == max) {
+            if (redundancy->next_probe_us[i] < next_due) next_due = redundancy->next_probe_us[i];
+            continue;
+        }
+        redundancy->probing[i] = 1;
+        redundancy->in_flight++;
+        claimed[count++] = i;
+    }
+    *next_due_out = next_due;
+    return count;
+}
+
+// Suspects every peer whose phi crossed the threshold and reprobes it at once;
+// the caller holds probe_mutex. Returns the next time a peer will cross it.
+static uint64_t dcf_redundancy_expire(DCFRedundancy* redundancy, uint64_t now) {
+    uint64_t next = UINT64_MAX;
+    for (size_t i = 0; i < redundancy->peer_count; i++) {
+        uint64_t at = __atomic_load_n(&redundancy->suspect_at_us[i], __ATOMIC_RELAXED);
+        if (at > now) {
+            if (at < next) next = at;
+            continue;
+        }
+        if (dcf_redundancy_mark_suspect(redundancy, i)) {
+            redundancy->next_probe_us[i] = 0;
+            redundancy->interval_ms[i] = redundancy->probe_interval_ms;
+        }
+    }
+    return next;
+}
+
+static void* dcf_redundancy_prober(void* arg) {
+    DCFRedundancy* redundancy = arg;
+    size_t* claimed = malloc(redundancy->probe_concurrency * sizeof(size_t));
+    if (!claimed) return NULL;
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    while (redundancy->prober_running) {
+        uint64_t now = dcf_redundancy_now_us();
+        uint64_t next_suspect = dcf_redundancy_expire(redundancy, now);
+        size_t room = redundancy->in_flight < (size_t)redundancy->probe_concurrency ? redundancy->probe_concurrency - redundancy->in_flight : 0;
+        uint64_t next_due;
+        size_t count = dcf_redundancy_claim_due(redundancy, now, claimed, room, &next_due);
+        if (count) {
+            pthread_mutex_unlock(&redundancy->probe_mutex);
+            for (size_t c = 0; c < count; c++) dcf_redundancy_launch_probe(redundancy, claimed[c]);
+            pthread_mutex_lock(&redundancy->probe_mutex);
+            continue;
+        }
+        // Sleep until the next peer is due; completions and kicks wake us early
+        uint64_t wake = next_due != UINT64_MAX && next_due > now ? next_due : now + (uint64_t)redundancy->probe_interval_ms * 1000;
+        if (next_suspect < wake) wake = next_suspect;
+        struct timespec ts = { .tv_sec = wake / 1000000u, .tv_nsec = (wake % 1000000u) * 1000 };
+        pthread_cond_timedwait(&redundancy->probe_cond, &redundancy->probe_mutex, &ts);
+    }
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    free(claimed);
+    return NULL;
+}
+
+// Drives the membership protocol on its own clock; ticks run without probe_mutex
+// because the membership callbacks take it
+static void* dcf_redundancy_gossiper(void* arg) {
+    DCFRedundancy* redundancy = arg;
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    while (redundancy->gossip_running) {
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+        uint64_t wake = dcf_membership_tick(redundancy->membership, dcf_redundancy_now_us());
+        pthread_mutex_lock(&redundancy->probe_mutex);
+        if (!redundancy->gossip_running) break;
+        struct timespec ts = { .tv_sec = wake / 1000000u, .tv_nsec = (wake % 1000000u) * 1000 };
+        pthread_cond_timedwait(&redundancy->gossip_cond, &redundancy->probe_mutex, &ts);
+    }
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    return NULL;
+}
+
+static void dcf_redundancy_stop_gossiper(DCFRedundancy* redundancy) {
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    bool was_running = redundancy->gossip_running;
+    redundancy->gossip_running = false;
+    pthread_cond_broadcast(&redundancy->gossip_cond);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    if (was_running) pthread_join(redundancy->gossip_thread, NULL);
+}
+
+static void dcf_redundancy_stop_prober(DCFRedundancy* redundancy) {
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    bool was_running = redundancy->prober_running;
+    redundancy->prober_running = false;
+    pthread_cond_broadcast(&redundancy->probe_cond);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    if (was_running) pthread_join(redundancy->prober_thread, NULL);
+    // Probes already sent still complete into our arrays; their deadlines bound the wait
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    while (redundancy->in_flight) pthread_cond_wait(&redundancy->probe_cond, &redundancy->probe_mutex);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+}
+
 DCFError dcf_redundancy_start(DCFRedundancy* redundancy, DCFMode mode) {
     if (!redundancy) return DCF_ERR_NULL_PTR;
     redundancy->running = true;
     redundancy->mode = mode;
+    // probe_interval_ms 0 leaves probing to explicit health checks and regroups.
+    // With gossip the prober runs from the start, as peers may turn up at any time.
+    if ((redundancy->peer_count || redundancy->membership) && redundancy->probe_interval_ms > 0 && !redundancy->prober_running) {
+        uint64_t now = dcf_redundancy_now_us();
+        pthread_mutex_lock(&redundancy->probe_mutex);
+        // The first sweep is spread over one interval rather than fired at once
+        for (size_t i = 0; i < redundancy->peer_count; i++) {
+            redundancy->next_probe_us[i] = now + (uint64_t)rand_r(&redundancy->jitter_seed) * redundancy->probe_interval_ms * 1000 / ((uint64_t)RAND_MAX + 1);
+        }
+        redundancy->prober_running = true;
+        if (pthread_create(&redundancy->prober_thread, NULL, dcf_redundancy_prober, redundancy) != 0) redundancy->prober_running = false;
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+    }
+    if (redundancy->membership && !redundancy->gossip_running) {
+        redundancy->gossip_running = true;
+        if (pthread_create(&redundancy->gossip_thread, NULL, dcf_redundancy_gossiper, redundancy) != 0) redundancy->gossip_running = false;
+    }
     return DCF_SUCCESS;
 }
 
 DCFError dcf_redundancy_stop(DCFRedundancy* redundancy) {
     if (!redundancy) return DCF_ERR_NULL_PTR;
     redundancy->running = false;
+    dcf_redundancy_stop_gossiper(redundancy);
+    dcf_redundancy_stop_prober(redundancy);
     return DCF_SUCCESS;
 }
 
+// False once peer's phi has crossed the threshold, in which case it has just
+// been taken out of routing and queued for an immediate reprobe
+static bool dcf_redundancy_hop_alive(DCFRedundancy* redundancy, DCFPeerId peer) {
+    uint64_t at = __atomic_load_n(&redundancy->suspect_at_us[peer], __ATOMIC_RELAXED);
+    if (at == UINT64_MAX || at > dcf_redundancy_now_us()) return true;
+    if (dcf_redundancy_mark_suspect(redundancy, peer)) {
+        pthread_mutex_lock(&redundancy->probe_mutex);
+        redundancy->next_probe_us[peer] = 0;
+        redundancy->interval_ms[peer] = redundancy->probe_interval_ms;
+        pthread_cond_broadcast(&redundancy->probe_cond);
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+    }
+    return false;
+}
+
+DCFError dcf_redundancy_get_optimal_route_id(DCFRedundancy* redundancy, DCFPeerId recipient, DCFPeerId* hop_out) {
+    if (!redundancy || !hop_out) return DCF_ERR_NULL_PTR;
+    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    if (!dcf_redundancy_peer_address(redundancy, recipient)) return DCF_ERR_INVALID_ARG;
+    // The routing table keeps each node's first hop current, so this is one array read.
+    // First hops are always peers, since only peers have links from this node, and
+    // their tags are their ids. A hop found overdue is dropped on the spot and the
+    // route looked up again.
+    for (;;) {
+        uint32_t hop;
+        DCFError err = dcf_routing_next_hop_tag(redundancy->routes, redundancy->route_nodes[recipient], &hop);
+        if (err != DCF_SUCCESS) return err;
+        *hop_out = hop;
+        if (*hop_out == DCF_PEER_NONE) return DCF_ERR_ROUTE_NOT_FOUND;
+        if (dcf_redundancy_hop_alive(redundancy, *hop_out)) return DCF_SUCCESS;
+    }
+}
+
 DCFError dcf_redundancy_get_optimal_route(DCFRedundancy* redundancy, const char* recipient, char** route_out) {
     if (!redundancy || !recipient || !route_out) return DCF_ERR_NULL_PTR;
     if (!redundancy->running) return DCF_ERR_INVALID_STATE;
-    int min_rtt = INT_MAX;
-    size_t min_idx = 0;
-    bool found = false;
-    for (size_t i = 0; i < redundancy->peer_count; i++) {
-        if (strcmp(redundancy->peers[i], recipient) == 0) continue;
-        if (redundancy->rtt_cache[i] < min_rtt) {
-            min_rtt = redundancy->rtt_cache[i];
-            min_idx = i;
-            found = true;
+    DCFPeerId id = dcf_redundancy_find(redundancy, recipient);
+    if (id != DCF_PEER_NONE) {
+        DCFPeerId hop;
+        DCFError err = dcf_redundancy_get_optimal_route_id(redundancy, id, &hop);
+        if (err != DCF_SUCCESS) return err;
+        // The hop may have been removed since the route was read
+        const char* address = __atomic_load_n(&redundancy->peers[hop], __ATOMIC_ACQUIRE);
+        if (!address) return DCF_ERR_ROUTE_NOT_FOUND;
+        *route_out = strdup(address);
+        return *route_out ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+    }
+    // Beyond our peers, only nodes neighbors reported links to are in the graph;
+    // a recipient nobody has reported is addressed directly
+    if (!dcf_routing_has_node(redundancy->routes, recipient)) {
+        *route_out = strdup(recipient);
+        return *route_out ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+    }
+    for (;;) {
+        DCFError err = dcf_routing_next_hop(redundancy->routes, recipient, route_out);
+        if (err != DCF_SUCCESS) return err;
+        DCFPeerId hop = dcf_redundancy_find(redundancy, *route_out);
+        if (hop == DCF_PEER_NONE || dcf_redundancy_hop_alive(redundancy, hop)) return DCF_SUCCESS;
+        free(*route_out);
+    }
+}
+
+DCFError dcf_redundancy_get_disjoint_routes(DCFRedundancy* redundancy, const char* recipient, size_t k, char** routes_out, size_t* count_out) {
+    if (!redundancy || !recipient || !routes_out || !count_out) return DCF_ERR_NULL_PTR;
+    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    if (k == 0) return DCF_ERR_INVALID_ARG;
+    if (!dcf_routing_has_node(redundancy->routes, recipient)) {
+        routes_out[0] = strdup(recipient);
+        *count_out = routes_out[0] ? 1 : 0;
+        return routes_out[0] ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+    }
+    // Like get_optimal_route: an overdue first hop leaves routing on the spot
+    // and the routes are searched again without it
+    for (;;) {
+        DCFError err = dcf_routing_disjoint_routes(redundancy->routes, recipient, k, routes_out, count_out);
+        if (err != DCF_SUCCESS) return err;
+        bool alive = true;
+        for (size_t i = 0; i < *count_out && alive; i++) {
+            // First hops are peers; the hop ends at the first comma
+            size_t hop_len = strcspn(routes_out[i], ",");
+            char saved = routes_out[i][hop_len];
+            routes_out[i][hop_len] = '\0';
+            DCFPeerId hop = dcf_redundancy_find(redundancy, routes_out[i]);
+            routes_out[i][hop_len] = saved;
+            alive = hop == DCF_PEER_NONE || dcf_redundancy_hop_alive(redundancy, hop);
         }
+        if (alive) return DCF_SUCCESS;
+        for (size_t i = 0; i < *count_out; i++) free(routes_out[i]);
+    }
+}
+
+DCFError dcf_redundancy_report_links(DCFRedundancy* redundancy, const char* neighbor, const char* const* peers, const uint32_t* srtt_us, size_t count) {
+    if (!redundancy || !neighbor || (count && (!peers || !srtt_us))) return DCF_ERR_NULL_PTR;
+    if (!redundancy->routes) return DCF_ERR_INVALID_STATE;
+    for (size_t i = 0; i < count; i++) {
+        // A neighbor's view of its links to us says nothing about our own paths
+        if (!peers[i] || strcmp(peers[i], neighbor) == 0 || strcmp(peers[i], redundancy->self) == 0) continue;
+        DCFError err = dcf_routing_set_link(redundancy->routes, neighbor, peers[i], srtt_us[i] >= DCF_RTT_UNKNOWN ? DCF_ROUTE_NO_LINK : srtt_us[i]);
+        if (err != DCF_SUCCESS) return err;
     }
-    if (!found) return DCF_ERR_ROUTE_NOT_FOUND;
-    *route_out = strdup(redundancy->peers[min_idx]);
-    if (!*route_out) return DCF_ERR_MALLOC_FAIL;
     return DCF_SUCCESS;
 }
 
-DCFError dcf_redundancy_health_check(DCFRedundancy* redundancy, const char* peer, int* rtt_out) {
-    if (!redundancy || !peer || !rtt_out) return DCF_ERR_NULL_PTR;
-    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+// Probes peer, whose id is DCF_PEER_NONE when it is not in the peer table
+static DCFError dcf_redundancy_probe(DCFRedundancy* redundancy, DCFPeerId id, const char* peer, int* rtt_out) {
     uint8_t* health_request;
     size_t req_len;
     DCFError err = dcf_serialize_health_request(peer, &health_request, &req_len);
     if (err != DCF_SUCCESS) return err;
-    err = dcf_networking_send(redundancy->networking, health_request, req_len, peer);
+    // Timed from just before the send to this probe's own reply, on the monotonic
+    // clock, and given up on after probe_timeout_ms like a background probe
+    uint64_t start = dcf_redundancy_now_us();
+    uint8_t* reply;
+    size_t reply_len;
+    err = dcf_networking_request(redundancy->networking, health_request, req_len, peer, redundancy->probe_timeout_ms, &reply, &reply_len);
     free(health_request);
-    if (err != DCF_SUCCESS) return err;
-    char* response, *sender;
-    err = dcf_networking_receive(redundancy->networking, &response, &sender);
-    if (err != DCF_SUCCESS) return err;
-    *rtt_out = rand() % 100;  // Mock RTT; replace with real measurement
-    free(response);
-    free(sender);
-    for (size_t i = 0; i < redundancy->peer_count; i++) {
-        if (strcmp(redundancy->peers[i], peer) == 0) {
-            redundancy->rtt_cache[i] = *rtt_out;
-            free(redundancy->groups[i]);
-            redundancy->groups[i] = strdup(*rtt_out < redundancy->rtt_threshold ? "local" : "remote");
-            break;
-        }
+    uint64_t elapsed = dcf_redundancy_now_us() - start;
+    uint32_t sample_us = elapsed < DCF_RTT_UNKNOWN ? (uint32_t)elapsed : DCF_RTT_UNKNOWN - 1;
+    bool lost = err != DCF_SUCCESS || elapsed > (uint64_t)redundancy->probe_timeout_ms * 1000;
+    DCFCoordinate remote;
+    bool has_remote = !lost && dcf_redundancy_reply_coordinate(reply, reply_len, &remote);
+    bool has_sample = reply != NULL;
+    free(reply);
+    if (id != DCF_PEER_NONE) {
+        pthread_mutex_lock(&redundancy->stats_mutex);
+        dcf_redundancy_record(redundancy, id, lost, has_sample, sample_us, has_remote ? &remote : NULL);
+        pthread_mutex_unlock(&redundancy->stats_mutex);
+        if (has_remote) dcf_redundancy_publish_coordinate(redundancy);
     }
+    if (lost) return err != DCF_SUCCESS ? err : DCF_ERR_TIMEOUT;
+    // Socket and shared-memory probes are delivered without a reply to time
+    *rtt_out = has_sample ? (int)((sample_us + 500) / 1000) : -1;
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_redundancy_health_check(DCFRedundancy* redundancy, const char* peer, int* rtt_out) {
+    if (!redundancy || !peer || !rtt_out) return DCF_ERR_NULL_PTR;
+    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    return dcf_redundancy_probe(redundancy, dcf_redundancy_find(redundancy, peer), peer, rtt_out);
+}
+
+DCFError dcf_redundancy_health_check_id(DCFRedundancy* redundancy, DCFPeerId peer, int* rtt_out) {
+    if (!redundancy || !rtt_out) return DCF_ERR_NULL_PTR;
+    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    const char* address = dcf_redundancy_peer_address(redundancy, peer);
+    if (!address) return DCF_ERR_INVALID_ARG;
+    return dcf_redundancy_probe(redundancy, peer, address, rtt_out);
+}
+
+DCFError dcf_redundancy_get_peer_stats_id(DCFRedundancy* redundancy, DCFPeerId peer, DCFPeerStats* stats_out) {
+    if (!redundancy || !stats_out) return DCF_ERR_NULL_PTR;
+    if (!dcf_redundancy_peer_address(redundancy, peer)) return DCF_ERR_INVALID_ARG;
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    stats_out->srtt_us = redundancy->srtt_us[peer];
+    stats_out->rttvar_us = redundancy->rttvar_us[peer];
+    stats_out->min_rtt_us = redundancy->min_rtt_us[peer];
+    stats_out->loss_rate = redundancy->loss_rate[peer];
+    stats_out->probes = redundancy->probes[peer];
+    stats_out->group = dcf_group_names[redundancy->groups[peer]];
+    stats_out->suspected = redundancy->suspected[peer];
+    stats_out->phi = 0;
+    if (redundancy->answers[peer] && redundancy->heartbeats[peer] >= DCF_PHI_MIN_HEARTBEATS) {
+        float std = sqrtf(redundancy->gap_var_us2[peer]);
+        if (std < redundancy->phi_min_std_us) std = redundancy->phi_min_std_us;
+        double late = (double)(dcf_redundancy_now_us() - redundancy->last_heard_us[peer]) - (double)redundancy->phi_pause_us;
+        stats_out->phi = dcf_redundancy_phi((late - redundancy->gap_mean_us[peer]) / std);
+    }
+    stats_out->estimated_rtt_us = redundancy->has_coord[peer] ? dcf_coordinate_distance_us(&redundancy->coord, &redundancy->peer_coords[peer]) : DCF_RTT_UNKNOWN;
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    stats_out->probe_interval_ms = redundancy->interval_ms[peer];
+    pthread_mutex_unlock(&redundancy->probe_mutex);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_redundancy_get_peer_stats(DCFRedundancy* redundancy, const char* peer, DCFPeerStats* stats_out) {
+    if (!redundancy || !peer || !stats_out) return DCF_ERR_NULL_PTR;
+    DCFPeerId id = dcf_redundancy_find(redundancy, peer);
+    if (id == DCF_PEER_NONE) return DCF_ERR_ROUTE_NOT_FOUND;
+    return dcf_redundancy_get_peer_stats_id(redundancy, id, stats_out);
+}
+
+DCFError dcf_redundancy_simulate_failure_id(DCFRedundancy* redundancy, DCFPeerId peer) {
+    if (!redundancy) return DCF_ERR_NULL_PTR;
+    if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    if (!dcf_redundancy_peer_address(redundancy, peer)) return DCF_ERR_INVALID_ARG;
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    __atomic_store_n(&redundancy->srtt_us[peer], DCF_RTT_UNREACHABLE, __ATOMIC_RELAXED);
+    __atomic_store_n(&redundancy->groups[peer], DCF_GROUP_UNREACHABLE, __ATOMIC_RELAXED);
+    dcf_routing_set_link_nodes(redundancy->routes, DCF_ROUTE_SELF, redundancy->route_nodes[peer], DCF_ROUTE_NO_LINK);
+    // Suspected like a detected failure, so the next heartbeat brings it back
+    redundancy->suspected[peer] = 1;
+    dcf_redundancy_schedule_suspicion(redundancy, peer);
+    pthread_mutex_unlock(&redundancy->stats_mutex);
     return DCF_SUCCESS;
 }
 
 DCFError dcf_redundancy_simulate_failure(DCFRedundancy* redundancy, const char* peer) {
     if (!redundancy || !peer) return DCF_ERR_NULL_PTR;
     if (!redundancy->running) return DCF_ERR_INVALID_STATE;
-    for (size_t i = 0; i < redundancy->peer_count; i++) {
-        if (strcmp(redundancy->peers[i], peer) == 0) {
-            redundancy->rtt_cache[i] = INT_MAX;
-            free(redundancy->groups[i]);
-            redundancy->groups[i] = strdup("unreachable");
-            return DCF_SUCCESS;
-        }
-    }
-    return DCF_ERR_UNKNOWN;
+    DCFPeerId id = dcf_redundancy_find(redundancy, peer);
+    if (id == DCF_PEER_NONE) return DCF_ERR_UNKNOWN;
+    return dcf_redundancy_simulate_failure_id(redundancy, id);
+}
+
+// Coordinate of peer, or ours for DCF_PEER_NONE; the caller holds stats_mutex
+static const DCFCoordinate* dcf_redundancy_coordinate(DCFRedundancy* redundancy, DCFPeerId peer) {
+    if (peer == DCF_PEER_NONE) return &redundancy->coord;
+    return redundancy->has_coord[peer] ? &redundancy->peer_coords[peer] : NULL;
+}
+
+DCFError dcf_redundancy_estimate_rtt_id(DCFRedundancy* redundancy, DCFPeerId a, DCFPeerId b, uint32_t* rtt_us_out) {
+    if (!redundancy || !rtt_us_out) return DCF_ERR_NULL_PTR;
+    if ((a != DCF_PEER_NONE && a >= dcf_redundancy_peer_count(redundancy)) || (b != DCF_PEER_NONE && b >= dcf_redundancy_peer_count(redundancy))) return DCF_ERR_INVALID_ARG;
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    const DCFCoordinate* ca = dcf_redundancy_coordinate(redundancy, a);
+    const DCFCoordinate* cb = dcf_redundancy_coordinate(redundancy, b);
+    if (ca && cb) *rtt_us_out = a == b ? 0 : dcf_coordinate_distance_us(ca, cb);
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    return ca && cb ? DCF_SUCCESS : DCF_ERR_ROUTE_NOT_FOUND;
+}
+
+DCFError dcf_redundancy_estimate_rtt(DCFRedundancy* redundancy, const char* a, const char* b, uint32_t* rtt_us_out) {
+    if (!redundancy || !rtt_us_out) return DCF_ERR_NULL_PTR;
+    DCFPeerId ia = a ? dcf_redundancy_find(redundancy, a) : DCF_PEER_NONE;
+    DCFPeerId ib = b ? dcf_redundancy_find(redundancy, b) : DCF_PEER_NONE;
+    if ((a && ia == DCF_PEER_NONE) || (b && ib == DCF_PEER_NONE)) return DCF_ERR_ROUTE_NOT_FOUND;
+    return dcf_redundancy_estimate_rtt_id(redundancy, ia, ib, rtt_us_out);
+}
+
+DCFError dcf_redundancy_get_coordinate(DCFRedundancy* redundancy, DCFCoordinate* coord_out) {
+    if (!redundancy || !coord_out) return DCF_ERR_NULL_PTR;
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    *coord_out = redundancy->coord;
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_redundancy_heartbeat_id(DCFRedundancy* redundancy, DCFPeerId peer) {
+    if (!redundancy) return DCF_ERR_NULL_PTR;
+    if (!dcf_redundancy_peer_address(redundancy, peer)) return DCF_ERR_INVALID_ARG;
+    uint64_t now = dcf_redundancy_now_us();
+    // Busy peers heartbeat on every message; a lock-free check keeps that cheap
+    if (now - __atomic_load_n(&redundancy->last_heard_us[peer], __ATOMIC_RELAXED) < DCF_PHI_MIN_GAP_US) return DCF_SUCCESS;
+    pthread_mutex_lock(&redundancy->stats_mutex);
+    dcf_redundancy_heard(redundancy, peer, now);
+    pthread_mutex_unlock(&redundancy->stats_mutex);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_redundancy_heartbeat(DCFRedundancy* redundancy, const char* peer) {
+    if (!redundancy || !peer) return DCF_ERR_NULL_PTR;
+    DCFPeerId id = dcf_redundancy_find(redundancy, peer);
+    if (id == DCF_PEER_NONE) return DCF_ERR_ROUTE_NOT_FOUND;
+    return dcf_redundancy_heartbeat_id(redundancy, id);
+}
+
+DCFError dcf_redundancy_find_peer(DCFRedundancy* redundancy, const char* peer, DCFPeerId* id_out) {
+    if (!redundancy || !peer || !id_out) return DCF_ERR_NULL_PTR;
+    *id_out = dcf_redundancy_find(redundancy, peer);
+    return *id_out == DCF_PEER_NONE ? DCF_ERR_ROUTE_NOT_FOUND : DCF_SUCCESS;
+}
+
+size_t dcf_redundancy_peer_count(DCFRedundancy* redundancy) {
+    return redundancy ? __atomic_load_n(&redundancy->peer_count, __ATOMIC_ACQUIRE) : 0;
+}
+
+const char* dcf_redundancy_peer_address(DCFRedundancy* redundancy, DCFPeerId peer) {
+    if (!redundancy || peer >= dcf_redundancy_peer_count(redundancy)) return NULL;
+    return __atomic_load_n(&redundancy->peers[peer], __ATOMIC_ACQUIRE);
 }
 
 DCFError dcf_redundancy_group_peers(DCFRedundancy* redundancy) {
     if (!redundancy) return DCF_ERR_NULL_PTR;
     if (!redundancy->running) return DCF_ERR_INVALID_STATE;
+    if (redundancy->probe_budgeted && redundancy->prober_running) {
+        // Reprobing the whole mesh would blow the probe budget, so regroup on
+        // coordinate estimates instead; peers known to be down stay down
+        uint64_t threshold_us = (uint64_t)redundancy->rtt_threshold * 1000;
+        pthread_mutex_lock(&redundancy->stats_mutex);
+        for (size_t i = 0; i < redundancy->peer_count; i++) {
+            if (!redundancy->has_coord[i] || redundancy->groups[i] == DCF_GROUP_UNREACHABLE) continue;
+            bool local = dcf_coordinate_distance_us(&redundancy->coord, &redundancy->peer_coords[i]) < threshold_us;
+            __atomic_store_n(&redundancy->groups[i], local ? DCF_GROUP_LOCAL : DCF_GROUP_REMOTE, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&redundancy->stats_mutex);
+        return DCF_SUCCESS;
+    }
+    pthread_mutex_lock(&redundancy->probe_mutex);
+    if (redundancy->prober_running) {
+        // Make every peer due and let the prober regroup in the background
+        for (size_t i = 0; i < redundancy->peer_count; i++) redundancy->next_probe_us[i] = 0;
+        pthread_cond_broadcast(&redundancy->probe_cond);
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+        return DCF_SUCCESS;
+    }
+    // No prober: one sweep with probe_concurrency probes in flight, bounded by the probe deadline
     for (size_t i = 0; i < redundancy->peer_count; i++) {
-        int rtt;
-        DCFError err = dcf_redundancy_health_check(redundancy, redundancy->peers[i], &rtt);
-        if (err != DCF_SUCCESS) continue;
+        if (redundancy->departed[i]) continue;
+        while (redundancy->probing[i] || redundancy->in_flight >= (size_t)redundancy->probe_concurrency) {
+            pthread_cond_wait(&redundancy->probe_cond, &redundancy->probe_mutex);
+        }
+        redundancy->probing[i] = 1;
+        redundancy->in_flight++;
+        pthread_mutex_unlock(&redundancy->probe_mutex);
+        dcf_redundancy_launch_probe(redundancy, i);
+        pthread_mutex_lock(&redundancy->probe_mutex);
     }
+    while (redundancy->in_flight) pthread_cond_wait(&redundancy->probe_cond, &redundancy->probe_mutex);
+    pthread_mutex_unlock(&redundancy->probe_mutex);
     return DCF_SUCCESS;
 }
 
 void dcf_redundancy_free(DCFRedundancy* redundancy) {
     if (!redundancy) return;
-    for (size_t i = 0; i < redundancy->peer_count; i++) {
-        free(redundancy->peers[i]);
-        free(redundancy->groups[i]);
+    dcf_redundancy_stop_gossiper(redundancy);
+    dcf_redundancy_stop_prober(redundancy);
+    if (redundancy->membership) {
+        dcf_networking_set_control_handler(redundancy->networking, NULL, NULL);
+        dcf_membership_free(redundancy->membership);
     }
+    for (size_t i = 0; i < redundancy->peer_count; i++) free(redundancy->peers[i]);
     free(redundancy->peers);
-    free(redundancy->rtt_cache);
+    free(redundancy->srtt_us);
+    free(redundancy->rttvar_us);
+    free(redundancy->min_rtt_us);
+    free(redundancy->loss_rate);
+    free(redundancy->probes);
     free(redundancy->groups);
-    free(redundancy);
-}
+    free(redundancy->next_probe_us);
+    free(redundancy->interval_ms);
+    free(redundancy->probe_start_us);
+    free(redundancy->probing);
+    free(redundancy->departed);
+    free(redundancy->leaving);
+    free(redundancy->free_ids);
+    for (size_t r = 0; r < redundancy->retired_count; r++) free(redundancy->retired[r]);
+    free(redundancy->retired);
+    free(redundancy->retired_us);
+    free(redundancy->probe_slots);
+    free(redundancy->peer_index);
+    free(redundancy->route_nodes);
+    free(redundancy->peer_coords);
+    free(redundancy->has_coord);
+    free(redundancy->last_heard_us);
+    free(redundancy->gap_mean_us);
+    free(redundancy->gap_var_us2);
+    free(redundancy->heartbeats);
+    free(redundancy->suspect_at_us);
+    free(redundancy->answers);
+    free(redundancy->suspected);
+    dcf_routing_free(redundancy->routes);
+    free(redundancy->self);
+    pthread_mutex_destroy(&redundancy->stats_mutex);
+    pthread_mutex_destroy(&redundancy->probe_mutex);
+    pthread_cond_destroy(&redundancy->probe_cond);
+    pthread_cond_destroy(&redundancy->gossip_cond);
     free(redundancy);
 }
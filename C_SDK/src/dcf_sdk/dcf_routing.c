@@ -0,0 +1,496 @@
+#include "dcf_routing.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DCF_ROUTE_NONE DCF_ROUTE_NODE_NONE
+#define DCF_ROUTE_INF UINT64_MAX
+#define DCF_ROUTE_ROOT DCF_ROUTE_SELF
+
+typedef struct {
+    uint32_t node;
+    uint32_t weight_us;
+} DCFRouteEdge;
+
+typedef struct {
+    DCFRouteEdge* edges;
+    uint32_t count;
+    uint32_t cap;
+} DCFRouteEdges;
+
+// Min-heap on dist with positions tracked for decrease-key
+typedef struct {
+    uint32_t* nodes;
+    uint32_t* pos;          // position in nodes, DCF_ROUTE_NONE when not queued
+    uint32_t size;
+    const uint64_t* dist;
+} DCFRouteHeap;
+
+// Nodes are dense indices with per-node parallel arrays; node 0 is the root.
+// Out-edges drive relaxation; in-edges let an orphaned subtree find new parents.
+struct DCFRoutingTable {
+    pthread_rwlock_t lock;
+    uint32_t node_count;
+    uint32_t node_cap;
+    char** names;
+    DCFRouteEdges* out;
+    DCFRouteEdges* in;
+    uint64_t* dist;
+    uint32_t* parent;
+    uint32_t* next_hop;
+    uint32_t* tags;         // caller's value per node, DCF_ROUTE_NONE until set
+    DCFRouteHeap heap;      // over dist, for relaxation
+    uint32_t* index;        // open-addressed name -> node, DCF_ROUTE_NONE when empty
+    uint32_t index_cap;     // power of two, kept at least twice node_count
+};
+
+static uint32_t dcf_routing_hash(const char* s) {
+    uint32_t hash = 2166136261u;
+    while (*s) hash = (hash ^ (uint8_t)*s++) * 16777619u;
+    return hash;
+}
+
+static uint32_t dcf_routing_find(const DCFRoutingTable* table, const char* name) {
+    uint32_t mask = table->index_cap - 1;
+    for (uint32_t slot = dcf_routing_hash(name) & mask;; slot = (slot + 1) & mask) {
+        uint32_t node = table->index[slot];
+        if (node == DCF_ROUTE_NONE || strcmp(table->names[node], name) == 0) return node;
+    }
+}
+
+static void dcf_routing_index_insert(DCFRoutingTable* table, uint32_t node) {
+    uint32_t mask = table->index_cap - 1;
+    uint32_t slot = dcf_routing_hash(table->names[node]) & mask;
+    while (table->index[slot] != DCF_ROUTE_NONE) slot = (slot + 1) & mask;
+    table->index[slot] = node;
+}
+
+static bool dcf_routing_grow(DCFRoutingTable* table) {
+    uint32_t cap = table->node_cap ? table->node_cap * 2 : 16;
+    // Every per-node array grows together; on failure the table keeps its old arrays
+    void* arrays[9] = {
+        realloc(table->names, cap * sizeof(char*)),
+        realloc(table->out, cap * sizeof(DCFRouteEdges)),
+        realloc(table->in, cap * sizeof(DCFRouteEdges)),
+        realloc(table->dist, cap * sizeof(uint64_t)),
+        realloc(table->parent, cap * sizeof(uint32_t)),
+        realloc(table->next_hop, cap * sizeof(uint32_t)),
+        realloc(table->heap.pos, cap * sizeof(uint32_t)),
+        realloc(table->heap.nodes, cap * sizeof(uint32_t)),
+        realloc(table->tags, cap * sizeof(uint32_t))
+    };
+    if (arrays[0]) table->names = arrays[0];
+    if (arrays[1]) table->out = arrays[1];
+    if (arrays[2]) table->in = arrays[2];
+    if (arrays[3]) table->dist = arrays[3];
+    if (arrays[4]) table->parent = arrays[4];
+    if (arrays[5]) table->next_hop = arrays[5];
+    if (arrays[6]) table->heap.pos = arrays[6];
+    if (arrays[7]) table->heap.nodes = arrays[7];
+    if (arrays[8]) table->tags = arrays[8];
+    table->heap.dist = table->dist;
+    for (int i = 0; i < 9; i++) {
+        if (!arrays[i]) return false;
+    }
+    uint32_t* index = malloc(cap * 2 * sizeof(uint32_t));
+    if (!index) return false;
+    free(table->index);
+    table->index = index;
+    table->index_cap = cap * 2;
+    memset(index, 0xff, table->index_cap * sizeof(uint32_t));
+    table->node_cap = cap;
+    for (uint32_t node = 0; node < table->node_count; node++) dcf_routing_index_insert(table, node);
+    return true;
+}
+
+// Index of name, added as an unreachable node if new; DCF_ROUTE_NONE when out of memory
+static uint32_t dcf_routing_intern_locked(DCFRoutingTable* table, const char* name) {
+    uint32_t node = dcf_routing_find(table, name);
+    if (node != DCF_ROUTE_NONE) return node;
+    if (table->node_count == table->node_cap && !dcf_routing_grow(table)) return DCF_ROUTE_NONE;
+    node = table->node_count;
+    table->names[node] = strdup(name);
+    if (!table->names[node]) return DCF_ROUTE_NONE;
+    memset(&table->out[node], 0, sizeof(DCFRouteEdges));
+    memset(&table->in[node], 0, sizeof(DCFRouteEdges));
+    table->dist[node] = DCF_ROUTE_INF;
+    table->parent[node] = DCF_ROUTE_NONE;
+    table->next_hop[node] = DCF_ROUTE_NONE;
+    table->heap.pos[node] = DCF_ROUTE_NONE;
+    table->tags[node] = DCF_ROUTE_NONE;
+    table->node_count++;
+    dcf_routing_index_insert(table, node);
+    return node;
+}
+
+DCFRoutingTable* dcf_routing_new(const char* self) {
+    if (!self) return NULL;
+    DCFRoutingTable* table = calloc(1, sizeof(DCFRoutingTable));
+    if (!table) return NULL;
+    pthread_rwlock_init(&table->lock, NULL);
+    if (!dcf_routing_grow(table) || dcf_routing_intern_locked(table, self) != DCF_ROUTE_ROOT) {
+        dcf_routing_free(table);
+        return NULL;
+    }
+    table->dist[DCF_ROUTE_ROOT] = 0;
+    return table;
+}
+
+static DCFRouteEdge* dcf_routing_edge(DCFRouteEdges* list, uint32_t node) {
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (list->edges[i].node == node) return &list->edges[i];
+    }
+    return NULL;
+}
+
+static bool dcf_routing_edge_add(DCFRouteEdges* list, uint32_t node, uint32_t weight_us) {
+    if (list->count == list->cap) {
+        uint32_t cap = list->cap ? list->cap * 2 : 4;
+        DCFRouteEdge* edges = realloc(list->edges, cap * sizeof(DCFRouteEdge));
+        if (!edges) return false;
+        list->edges = edges;
+        list->cap = cap;
+    }
+    list->edges[list->count++] = (DCFRouteEdge){ node, weight_us };
+    return true;
+}
+
+static void dcf_routing_edge_remove(DCFRouteEdges* list, uint32_t node) {
+    DCFRouteEdge* edge = dcf_routing_edge(list, node);
+    if (edge) *edge = list->edges[--list->count];
+}
+
+static void dcf_routing_heap_place(DCFRouteHeap* heap, uint32_t pos, uint32_t node) {
+    heap->nodes[pos] = node;
+    heap->pos[node] = pos;
+}
+
+static void dcf_routing_heap_up(DCFRouteHeap* heap, uint32_t pos) {
+    uint32_t node = heap->nodes[pos];
+    while (pos > 0) {
+        uint32_t up = (pos - 1) / 2;
+        if (heap->dist[heap->nodes[up]] <= heap->dist[node]) break;
+        dcf_routing_heap_place(heap, pos, heap->nodes[up]);
+        pos = up;
+    }
+    dcf_routing_heap_place(heap, pos, node);
+}
+
+static void dcf_routing_heap_push(DCFRouteHeap* heap, uint32_t node) {
+    if (heap->pos[node] == DCF_ROUTE_NONE) heap->pos[node] = heap->size++;
+    heap->nodes[heap->pos[node]] = node;
+    dcf_routing_heap_up(heap, heap->pos[node]);
+}
+
+static uint32_t dcf_routing_heap_pop(DCFRouteHeap* heap) {
+    uint32_t top = heap->nodes[0];
+    heap->pos[top] = DCF_ROUTE_NONE;
+    uint32_t last = heap->nodes[--heap->size];
+    if (heap->size == 0) return top;
+    uint32_t pos = 0;
+    for (;;) {
+        uint32_t child = pos * 2 + 1;
+        if (child >= heap->size) break;
+        if (child + 1 < heap->size && heap->dist[heap->nodes[child + 1]] < heap->dist[heap->nodes[child]]) child++;
+        if (heap->dist[heap->nodes[child]] >= heap->dist[last]) break;
+        dcf_routing_heap_place(heap, pos, heap->nodes[child]);
+        pos = child;
+    }
+    dcf_routing_heap_place(heap, pos, last);
+    return top;
+}
+
+// Gives node a shorter path through parent and queues it
+static void dcf_routing_improve(DCFRoutingTable* table, uint32_t node, uint32_t parent, uint64_t dist) {
+    table->dist[node] = dist;
+    table->parent[node] = parent;
+    table->next_hop[node] = parent == DCF_ROUTE_ROOT ? node : table->next_hop[parent];
+    dcf_routing_heap_push(&table->heap, node);
+}
+
+// Dijkstra from whatever is queued; settled nodes' dists are already final
+static void dcf_routing_relax(DCFRoutingTable* table) {
+    while (table->heap.size) {
+        uint32_t u = dcf_routing_heap_pop(&table->heap);
+        DCFRouteEdges* out = &table->out[u];
+        for (uint32_t i = 0; i < out->count; i++) {
+            uint32_t v = out->edges[i].node;
+            uint64_t dist = table->dist[u] + out->edges[i].weight_us;
+            if (dist < table->dist[v]) dcf_routing_improve(table, v, u, dist);
+        }
+    }
+}
+
+// The link parent -> child got longer or went away: every node whose path ran
+// through it loses its distance, then each takes the best remaining in-edge
+// from outside the orphaned subtree and Dijkstra settles the rest
+static void dcf_routing_reroute_subtree(DCFRoutingTable* table, uint32_t child) {
+    uint32_t* orphans = malloc(table->node_count * sizeof(uint32_t));
+    if (!orphans) return;
+    // Walk the tree down from child; each node has one parent, so none is listed twice
+    uint32_t count = 0;
+    orphans[count++] = child;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t u = orphans[i];
+        DCFRouteEdges* out = &table->out[u];
+        for (uint32_t e = 0; e < out->count; e++) {
+            if (table->parent[out->edges[e].node] == u) orphans[count++] = out->edges[e].node;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        table->dist[orphans[i]] = DCF_ROUTE_INF;
+        table->parent[orphans[i]] = DCF_ROUTE_NONE;
+        table->next_hop[orphans[i]] = DCF_ROUTE_NONE;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t v = orphans[i];
+        DCFRouteEdges* in = &table->in[v];
+        uint64_t best = DCF_ROUTE_INF;
+        uint32_t best_parent = DCF_ROUTE_NONE;
+        for (uint32_t e = 0; e < in->count; e++) {
+            uint32_t u = in->edges[e].node;
+            if (table->dist[u] == DCF_ROUTE_INF) continue;
+            uint64_t dist = table->dist[u] + in->edges[e].weight_us;
+            if (dist < best) {
+                best = dist;
+                best_parent = u;
+            }
+        }
+        if (best_parent != DCF_ROUTE_NONE) dcf_routing_improve(table, v, best_parent, best);
+    }
+    free(orphans);
+    dcf_routing_relax(table);
+}
+
+DCFRouteNode dcf_routing_node(DCFRoutingTable* table, const char* node) {
+    if (!table || !node) return DCF_ROUTE_NODE_NONE;
+    pthread_rwlock_wrlock(&table->lock);
+    uint32_t index = dcf_routing_intern_locked(table, node);
+    pthread_rwlock_unlock(&table->lock);
+    return index;
+}
+
+// The caller holds the write lock and has checked u and v
+static DCFError dcf_routing_update_link(DCFRoutingTable* table, uint32_t u, uint32_t v, uint32_t weight_us) {
+    DCFRouteEdge* out = dcf_routing_edge(&table->out[u], v);
+    uint32_t old = out ? out->weight_us : DCF_ROUTE_NO_LINK;
+    if (weight_us == old) return DCF_SUCCESS;
+    if (weight_us == DCF_ROUTE_NO_LINK) {
+        dcf_routing_edge_remove(&table->out[u], v);
+        dcf_routing_edge_remove(&table->in[v], u);
+    } else if (out) {
+        out->weight_us = weight_us;
+        dcf_routing_edge(&table->in[v], u)->weight_us = weight_us;
+    } else if (!dcf_routing_edge_add(&table->out[u], v, weight_us)) {
+        return DCF_ERR_MALLOC_FAIL;
+    } else if (!dcf_routing_edge_add(&table->in[v], u, weight_us)) {
+        dcf_routing_edge_remove(&table->out[u], v);
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    if (weight_us < old) {
+        // A shorter link can only pull v, and what hangs below it, closer
+        if (table->dist[u] != DCF_ROUTE_INF && table->dist[u] + weight_us < table->dist[v]) {
+            dcf_routing_improve(table, v, u, table->dist[u] + weight_us);
+            dcf_routing_relax(table);
+        }
+    } else if (table->parent[v] == u) {
+        // A longer link matters only when the tree uses it
+        dcf_routing_reroute_subtree(table, v);
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_routing_set_link(DCFRoutingTable* table, const char* from, const char* to, uint32_t weight_us) {
+    if (!table || !from || !to) return DCF_ERR_NULL_PTR;
+    if (strcmp(from, to) == 0) return DCF_ERR_INVALID_ARG;
+    pthread_rwlock_wrlock(&table->lock);
+    uint32_t u = dcf_routing_intern_locked(table, from);
+    uint32_t v = u == DCF_ROUTE_NONE ? DCF_ROUTE_NONE : dcf_routing_intern_locked(table, to);
+    DCFError err = v == DCF_ROUTE_NONE ? DCF_ERR_MALLOC_FAIL : dcf_routing_update_link(table, u, v, weight_us);
+    pthread_rwlock_unlock(&table->lock);
+    return err;
+}
+
+DCFError dcf_routing_set_link_nodes(DCFRoutingTable* table, DCFRouteNode from, DCFRouteNode to, uint32_t weight_us) {
+    if (!table) return DCF_ERR_NULL_PTR;
+    if (from == to) return DCF_ERR_INVALID_ARG;
+    pthread_rwlock_wrlock(&table->lock);
+    DCFError err = from < table->node_count && to < table->node_count ? dcf_routing_update_link(table, from, to, weight_us) : DCF_ERR_INVALID_ARG;
+    pthread_rwlock_unlock(&table->lock);
+    return err;
+}
+
+DCFError dcf_routing_next_hop(DCFRoutingTable* table, const char* destination, char** hop_out) {
+    if (!table || !destination || !hop_out) return DCF_ERR_NULL_PTR;
+    pthread_rwlock_rdlock(&table->lock);
+    uint32_t node = dcf_routing_find(table, destination);
+    uint32_t hop = node == DCF_ROUTE_NONE ? DCF_ROUTE_NONE : table->next_hop[node];
+    *hop_out = hop == DCF_ROUTE_NONE ? NULL : strdup(table->names[hop]);
+    pthread_rwlock_unlock(&table->lock);
+    if (hop == DCF_ROUTE_NONE) return DCF_ERR_ROUTE_NOT_FOUND;
+    return *hop_out ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+}
+
+DCFError dcf_routing_next_hop_node(DCFRoutingTable* table, DCFRouteNode destination, DCFRouteNode* hop_out) {
+    if (!table || !hop_out) return DCF_ERR_NULL_PTR;
+    pthread_rwlock_rdlock(&table->lock);
+    *hop_out = destination < table->node_count ? table->next_hop[destination] : DCF_ROUTE_NONE;
+    pthread_rwlock_unlock(&table->lock);
+    return *hop_out == DCF_ROUTE_NONE ? DCF_ERR_ROUTE_NOT_FOUND : DCF_SUCCESS;
+}
+
+// Shortest distance from every node to destination over in-edges, keeping off
+// the root and removed nodes; toward[u] is u's next step on that path
+static void dcf_routing_reverse_paths(const DCFRoutingTable* table, uint32_t destination, const bool* removed, uint64_t* dist, uint32_t* toward, DCFRouteHeap* heap) {
+    for (uint32_t node = 0; node < table->node_count; node++) {
+        dist[node] = DCF_ROUTE_INF;
+        toward[node] = DCF_ROUTE_NONE;
+    }
+    dist[destination] = 0;
+    dcf_routing_heap_push(heap, destination);
+    while (heap->size) {
+        uint32_t v = dcf_routing_heap_pop(heap);
+        const DCFRouteEdges* in = &table->in[v];
+        for (uint32_t e = 0; e < in->count; e++) {
+            uint32_t u = in->edges[e].node;
+            if (u == DCF_ROUTE_ROOT || removed[u]) continue;
+            uint64_t d = dist[v] + in->edges[e].weight_us;
+            if (d < dist[u]) {
+                dist[u] = d;
+                toward[u] = v;
+                dcf_routing_heap_push(heap, u);
+            }
+        }
+    }
+}
+
+// "hop,...,destination" along toward[], marking the nodes before destination removed
+static char* dcf_routing_path_string(const DCFRoutingTable* table, uint32_t hop, uint32_t destination, const uint32_t* toward, bool* removed) {
+    size_t len = 0;
+    for (uint32_t node = hop; node != DCF_ROUTE_NONE; node = toward[node]) len += strlen(table->names[node]) + 1;
+    char* path = malloc(len);
+    if (!path) return NULL;
+    char* p = path;
+    for (uint32_t node = hop; node != DCF_ROUTE_NONE; node = toward[node]) {
+        size_t n = strlen(table->names[node]);
+        memcpy(p, table->names[node], n);
+        p += n;
+        *p++ = ',';
+        if (node != destination) removed[node] = true;
+    }
+    p[-1] = '\0';
+    return path;
+}
+
+DCFError dcf_routing_disjoint_routes(DCFRoutingTable* table, const char* destination, size_t k, char** routes_out, size_t* count_out) {
+    if (!table || !destination || !routes_out || !count_out) return DCF_ERR_NULL_PTR;
+    *count_out = 0;
+    pthread_rwlock_rdlock(&table->lock);
+    uint32_t n = table->node_count;
+    uint32_t target = dcf_routing_find(table, destination);
+    if (target == DCF_ROUTE_NONE || target == DCF_ROUTE_ROOT) {
+        pthread_rwlock_unlock(&table->lock);
+        return DCF_ERR_ROUTE_NOT_FOUND;
+    }
+    // Per-call scratch, so concurrent readers never share search state
+    uint64_t* dist = malloc(n * sizeof(uint64_t));
+    uint32_t* toward = malloc(n * sizeof(uint32_t));
+    uint32_t* nodes = malloc(n * sizeof(uint32_t));
+    uint32_t* pos = malloc(n * sizeof(uint32_t));
+    bool* removed = calloc(n, sizeof(bool));
+    DCFError err = dist && toward && nodes && pos && removed ? DCF_SUCCESS : DCF_ERR_MALLOC_FAIL;
+    if (pos) memset(pos, 0xff, n * sizeof(uint32_t));
+    DCFRouteHeap heap = { nodes, pos, 0, dist };
+    bool direct_used = false;
+    // Greedy: take the shortest path, remove its inner nodes, search again.
+    // Each later route is the best of what is left rather than a jointly optimal set.
+    while (err == DCF_SUCCESS && *count_out < k) {
+        dcf_routing_reverse_paths(table, target, removed, dist, toward, &heap);
+        const DCFRouteEdges* out = &table->out[DCF_ROUTE_ROOT];
+        uint64_t best = DCF_ROUTE_INF;
+        uint32_t best_hop = DCF_ROUTE_NONE;
+        for (uint32_t e = 0; e < out->count; e++) {
+            uint32_t hop = out->edges[e].node;
+            if (removed[hop] || dist[hop] == DCF_ROUTE_INF || (hop == target && direct_used)) continue;
+            if (dist[hop] + out->edges[e].weight_us < best) {
+                best = dist[hop] + out->edges[e].weight_us;
+                best_hop = hop;
+            }
+        }
+        if (best_hop == DCF_ROUTE_NONE) break;
+        if (best_hop == target) direct_used = true;
+        routes_out[*count_out] = dcf_routing_path_string(table, best_hop, target, toward, removed);
+        if (!routes_out[*count_out]) err = DCF_ERR_MALLOC_FAIL;
+        else (*count_out)++;
+    }
+    pthread_rwlock_unlock(&table->lock);
+    free(dist);
+    free(toward);
+    free(nodes);
+    free(pos);
+    free(removed);
+    if (err == DCF_SUCCESS && *count_out == 0) err = DCF_ERR_ROUTE_NOT_FOUND;
+    if (err != DCF_SUCCESS) {
+        for (size_t i = 0; i < *count_out; i++) free(routes_out[i]);
+        *count_out = 0;
+    }
+    return err;
+}
+
+DCFError dcf_routing_set_tag(DCFRoutingTable* table, DCFRouteNode node, uint32_t tag) {
+    if (!table) return DCF_ERR_NULL_PTR;
+    pthread_rwlock_wrlock(&table->lock);
+    bool valid = node < table->node_count;
+    if (valid) table->tags[node] = tag;
+    pthread_rwlock_unlock(&table->lock);
+    return valid ? DCF_SUCCESS : DCF_ERR_INVALID_ARG;
+}
+
+DCFError dcf_routing_next_hop_tag(DCFRoutingTable* table, DCFRouteNode destination, uint32_t* tag_out) {
+    if (!table || !tag_out) return DCF_ERR_NULL_PTR;
+    pthread_rwlock_rdlock(&table->lock);
+    uint32_t hop = destination < table->node_count ? table->next_hop[destination] : DCF_ROUTE_NONE;
+    *tag_out = hop == DCF_ROUTE_NONE ? DCF_ROUTE_NONE : table->tags[hop];
+    pthread_rwlock_unlock(&table->lock);
+    return hop == DCF_ROUTE_NONE ? DCF_ERR_ROUTE_NOT_FOUND : DCF_SUCCESS;
+}
+
+DCFError dcf_routing_get_distance(DCFRoutingTable* table, const char* destination, uint64_t* distance_us_out) {
+    if (!table || !destination || !distance_us_out) return DCF_ERR_NULL_PTR;
+    pthread_rwlock_rdlock(&table->lock);
+    uint32_t node = dcf_routing_find(table, destination);
+    uint64_t dist = node == DCF_ROUTE_NONE ? DCF_ROUTE_INF : table->dist[node];
+    pthread_rwlock_unlock(&table->lock);
+    if (dist == DCF_ROUTE_INF) return DCF_ERR_ROUTE_NOT_FOUND;
+    *distance_us_out = dist;
+    return DCF_SUCCESS;
+}
+
+bool dcf_routing_has_node(DCFRoutingTable* table, const char* node) {
+    if (!table || !node) return false;
+    pthread_rwlock_rdlock(&table->lock);
+    bool found = dcf_routing_find(table, node) != DCF_ROUTE_NONE;
+    pthread_rwlock_unlock(&table->lock);
+    return found;
+}
+
+void dcf_routing_free(DCFRoutingTable* table) {
+    if (!table) return;
+    for (uint32_t node = 0; node < table->node_count; node++) {
+        free(table->names[node]);
+        free(table->out[node].edges);
+        free(table->in[node].edges);
+    }
+    free(table->names);
+    free(table->out);
+    free(table->in);
+    free(table->dist);
+    free(table->parent);
+    free(table->next_hop);
+    free(table->heap.pos);
+    free(table->heap.nodes);
+    free(table->tags);
+    free(table->index);
+    pthread_rwlock_destroy(&table->lock);
+    free(table);
+}
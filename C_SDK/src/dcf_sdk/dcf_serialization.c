@@ -1,58 +1,393 @@
 #include "dcf_serialization.h"
 #include "messages.pb-c.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#define DCF_ARENA_ALIGN 16
+#define DCF_ARENA_INITIAL 4096
+#define DCF_SCRATCH_INITIAL 1024
+
+typedef struct DCFArenaOverflow {
+    struct DCFArenaOverflow* next;
+} DCFArenaOverflow;
+
+// Per-thread state of the hot paths. Views are unpacked into a bump arena that
+// each unpack resets; a message that outgrows it spills into malloc'd blocks and
+// the arena grows to the high-water mark at the next reset, so steady state
+// never touches the heap. Scratch holds the last message packed by this thread.
+typedef struct {
+    uint8_t* base;
+    size_t cap;
+    size_t used;
+    size_t wanted;  // bytes the current unpack asked for, spills included
+    DCFArenaOverflow* overflow;
+    uint8_t* scratch;
+    size_t scratch_cap;
+    bool registered;
+} DCFThreadBuffers;
+
+static __thread DCFThreadBuffers dcf_thread_buffers;
+static pthread_key_t dcf_thread_buffers_key;
+static pthread_once_t dcf_thread_buffers_once = PTHREAD_ONCE_INIT;
+
+static void dcf_arena_release_overflow(DCFThreadBuffers* tb) {
+    while (tb->overflow) {
+        DCFArenaOverflow* next = tb->overflow->next;
+        free(tb->overflow);
+        tb->overflow = next;
+    }
+}
+
+static void dcf_thread_buffers_destroy(void* arg) {
+    DCFThreadBuffers* tb = arg;
+    dcf_arena_release_overflow(tb);
+    free(tb->base);
+    free(tb->scratch);
+    memset(tb, 0, sizeof(*tb));
+}
+
+static void dcf_thread_buffers_key_create(void) {
+    pthread_key_create(&dcf_thread_buffers_key, dcf_thread_buffers_destroy);
+}
+
+static DCFThreadBuffers* dcf_thread_buffers_get(void) {
+    DCFThreadBuffers* tb = &dcf_thread_buffers;
+    if (!tb->registered) {
+        // Frees the buffers when the thread exits
+        pthread_once(&dcf_thread_buffers_once, dcf_thread_buffers_key_create);
+        pthread_setspecific(dcf_thread_buffers_key, tb);
+        tb->registered = true;
+    }
+    return tb;
+}
+
+static void* dcf_arena_alloc(void* allocator_data, size_t size) {
+    DCFThreadBuffers* tb = allocator_data;
+    // Every block is followed by a NUL, so bytes fields read as C strings
+    size_t need = (size + 1 + DCF_ARENA_ALIGN - 1) & ~(size_t)(DCF_ARENA_ALIGN - 1);
+    tb->wanted += need;
+    uint8_t* block;
+    if (tb->used + need <= tb->cap) {
+        block = tb->base + tb->used;
+        tb->used += need;
+    } else {
+        DCFArenaOverflow* spill = malloc(DCF_ARENA_ALIGN + need);
+        if (!spill) return NULL;
+        spill->next = tb->overflow;
+        tb->overflow = spill;
+        block = (uint8_t*)spill + DCF_ARENA_ALIGN;
+    }
+    block[size] = '\0';
+    return block;
+}
+
+static void dcf_arena_free(void* allocator_data, void* pointer) {
+    // Blocks are released together by the next reset
+    (void)allocator_data;
+    (void)pointer;
+}
+
+static void dcf_arena_reset(DCFThreadBuffers* tb) {
+    dcf_arena_release_overflow(tb);
+    if (tb->wanted > tb->cap) {
+        size_t cap = tb->cap ? tb->cap : DCF_ARENA_INITIAL;
+        while (cap < tb->wanted) cap *= 2;
+        uint8_t* base = malloc(cap);
+        if (base) {
+            free(tb->base);
+            tb->base = base;
+            tb->cap = cap;
+        }
+    }
+    tb->used = 0;
+    tb->wanted = 0;
+}
+
+static bool dcf_scratch_reserve(DCFThreadBuffers* tb, size_t len) {
+    if (len <= tb->scratch_cap) return true;
+    size_t cap = tb->scratch_cap ? tb->scratch_cap : DCF_SCRATCH_INITIAL;
+    while (cap < len) cap *= 2;
+    uint8_t* scratch = realloc(tb->scratch, cap);
+    if (!scratch) return false;
+    tb->scratch = scratch;
+    tb->scratch_cap = cap;
+    return true;
+}
+
+// Points msg at the caller's payload and strings; packing reads them in place
+static void dcf_message_borrow(DCFMessage* msg, const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, uint64_t timestamp) {
+    DCFMessage init = DCF_MESSAGE__INIT;
+    *msg = init;
+    msg->sender = (char*)sender;
+    msg->recipient = (char*)recipient;
+    msg->data.data = (uint8_t*)payload;
+    msg->data.len = payload_len;
+    msg->timestamp = timestamp;
+    msg->has_sync = true;
+    msg->sync = false;
+    msg->has_sequence = true;
+    msg->sequence = rand() % 1000;
+}
+
+DCFError dcf_serialize_payload(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, uint8_t** serialized_out, size_t* len_out) {
+    if ((!payload && payload_len) || !sender || !recipient || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
+    DCFMessage msg;
+    dcf_message_borrow(&msg, payload, payload_len, sender, recipient, time(NULL));
+    *len_out = dcf_message__get_packed_size(&msg);
+    *serialized_out = malloc(*len_out ? *len_out : 1);
+    if (!*serialized_out) return DCF_ERR_MALLOC_FAIL;
+    dcf_message__pack(&msg, *serialized_out);
+    return DCF_SUCCESS;
+}
+
 DCFError dcf_serialize_message(const char* data, const char* sender, const char* recipient, uint8_t** serialized_out, size_t* len_out) {
-    if (!data || !sender || !recipient || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
-    DCFMessage msg = DCF_MESSAGE__INIT;
-    msg.sender = strdup(sender);
-    msg.recipient = strdup(recipient);
-    msg.data.data = (uint8_t*)strdup(data);
-    msg.data.len = strlen(data);
-    msg.timestamp = time(NULL);
-    msg.has_sync = true;
-    msg.sync = false;
-    msg.has_sequence = true;
-    msg.sequence = rand() % 1000;
+    if (!data) return DCF_ERR_NULL_PTR;
+    return dcf_serialize_payload((const uint8_t*)data, strlen(data), sender, recipient, serialized_out, len_out);
+}
+
+DCFError dcf_serialize_payload_into(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, uint8_t* buf, size_t cap, size_t* len_out) {
+    if ((!payload && payload_len) || !sender || !recipient || !len_out) return DCF_ERR_NULL_PTR;
+    DCFMessage msg;
+    dcf_message_borrow(&msg, payload, payload_len, sender, recipient, time(NULL));
     *len_out = dcf_message__get_packed_size(&msg);
-    *serialized_out = calloc(1, *len_out);
-    if (!*serialized_out) {
-        free(msg.sender);
-        free(msg.recipient);
-        free(msg.data.data);
+    if (!buf || *len_out > cap) return DCF_ERR_INVALID_ARG;
+    dcf_message__pack(&msg, buf);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_serialize_message_into(const char* data, const char* sender, const char* recipient, uint8_t* buf, size_t cap, size_t* len_out) {
+    if (!data) return DCF_ERR_NULL_PTR;
+    return dcf_serialize_payload_into((const uint8_t*)data, strlen(data), sender, recipient, buf, cap, len_out);
+}
+
+DCFError dcf_serialize_payload_scratch(const uint8_t* payload, size_t payload_len, const char* sender, const char* recipient, const uint8_t** serialized_out, size_t* len_out) {
+    if ((!payload && payload_len) || !sender || !recipient || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
+    DCFThreadBuffers* tb = dcf_thread_buffers_get();
+    DCFMessage msg;
+    dcf_message_borrow(&msg, payload, payload_len, sender, recipient, time(NULL));
+    size_t len = dcf_message__get_packed_size(&msg);
+    if (!dcf_scratch_reserve(tb, len)) return DCF_ERR_MALLOC_FAIL;
+    dcf_message__pack(&msg, tb->scratch);
+    *serialized_out = tb->scratch;
+    *len_out = len;
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_serialize_message_scratch(const char* data, const char* sender, const char* recipient, const uint8_t** serialized_out, size_t* len_out) {
+    if (!data) return DCF_ERR_NULL_PTR;
+    return dcf_serialize_payload_scratch((const uint8_t*)data, strlen(data), sender, recipient, serialized_out, len_out);
+}
+
+DCFError dcf_serialize_batch(const char* sender, const char* const* data, const size_t* data_lens, const char* const* recipients, size_t count, uint8_t** buffer_out, size_t* lens_out) {
+    if (!sender || !data || !recipients || !buffer_out || !lens_out) return DCF_ERR_NULL_PTR;
+    DCFMessage* msgs = calloc(count ? count : 1, sizeof(DCFMessage));
+    if (!msgs) return DCF_ERR_MALLOC_FAIL;
+    // Every message shares the timestamp and borrows its strings; nothing is copied before packing
+    uint64_t now = time(NULL);
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!data[i] || !recipients[i]) {
+            free(msgs);
+            return DCF_ERR_NULL_PTR;
+        }
+        size_t data_len = data_lens ? data_lens[i] : strlen(data[i]);
+        dcf_message_borrow(&msgs[i], (const uint8_t*)data[i], data_len, sender, recipients[i], now);
+        lens_out[i] = dcf_message__get_packed_size(&msgs[i]);
+        total += lens_out[i];
+    }
+    uint8_t* buffer = malloc(total ? total : 1);
+    if (!buffer) {
+        free(msgs);
         return DCF_ERR_MALLOC_FAIL;
     }
-    dcf_message__pack(&msg, *serialized_out);
-    free(msg.sender);
-    free(msg.recipient);
-    free(msg.data.data);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) offset += dcf_message__pack(&msgs[i], buffer + offset);
+    free(msgs);
+    *buffer_out = buffer;
+    return DCF_SUCCESS;
+}
+
+// Field keys of DCFMessage: (field number << 3) | wire type
+#define DCF_KEY_SENDER 0x0a
+#define DCF_KEY_RECIPIENT 0x12
+#define DCF_KEY_DATA 0x1a
+#define DCF_KEY_TIMESTAMP 0x20
+#define DCF_KEY_SYNC 0x28
+#define DCF_KEY_SEQUENCE 0x30
+#define DCF_KEY_REDUNDANCY_PATH 0x3a
+#define DCF_KEY_GROUP_ID 0x42
+
+// The envelope holds fields 1-2 and 7-8 already encoded; packing writes them
+// around fields 3-6, so the output keeps protobuf-c's field order.
+struct DCFEnvelope {
+    uint8_t* prefix;  // sender, recipient
+    size_t prefix_len;
+    uint8_t* suffix;  // redundancy_path, group_id
+    size_t suffix_len;
+};
+
+static size_t dcf_varint_size(uint64_t value) {
+    size_t n = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint8_t* dcf_put_varint(uint8_t* p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+// Strings are omitted when NULL, as protobuf-c does
+static size_t dcf_string_field_size(const char* s) {
+    if (!s) return 0;
+    size_t len = strlen(s);
+    return 1 + dcf_varint_size(len) + len;
+}
+
+static uint8_t* dcf_put_string_field(uint8_t* p, uint8_t key, const char* s) {
+    if (!s) return p;
+    size_t len = strlen(s);
+    *p++ = key;
+    p = dcf_put_varint(p, len);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+DCFEnvelope* dcf_envelope_new(const char* sender, const char* recipient, const char* redundancy_path, const char* group_id) {
+    if (!sender || !recipient) return NULL;
+    size_t prefix_len = dcf_string_field_size(sender) + dcf_string_field_size(recipient);
+    size_t suffix_len = dcf_string_field_size(redundancy_path) + dcf_string_field_size(group_id);
+    DCFEnvelope* env = calloc(1, sizeof(DCFEnvelope) + prefix_len + suffix_len);
+    if (!env) return NULL;
+    env->prefix = (uint8_t*)(env + 1);
+    env->prefix_len = prefix_len;
+    env->suffix = env->prefix + prefix_len;
+    env->suffix_len = suffix_len;
+    uint8_t* p = dcf_put_string_field(env->prefix, DCF_KEY_SENDER, sender);
+    dcf_put_string_field(p, DCF_KEY_RECIPIENT, recipient);
+    p = dcf_put_string_field(env->suffix, DCF_KEY_REDUNDANCY_PATH, redundancy_path);
+    dcf_put_string_field(p, DCF_KEY_GROUP_ID, group_id);
+    return env;
+}
+
+// Same presence rules as dcf_serialize_payload: empty data and a zero timestamp
+// are omitted, sync (false) and sequence always go out
+size_t dcf_envelope_packed_size(const DCFEnvelope* env, size_t payload_len, int64_t timestamp, uint32_t sequence) {
+    if (!env) return 0;
+    size_t len = env->prefix_len + env->suffix_len + 2 + 1 + dcf_varint_size(sequence);
+    if (payload_len) len += 1 + dcf_varint_size(payload_len) + payload_len;
+    if (timestamp) len += 1 + dcf_varint_size((uint64_t)timestamp);
+    return len;
+}
+
+DCFError dcf_envelope_pack(const DCFEnvelope* env, const uint8_t* payload, size_t payload_len, int64_t timestamp, uint32_t sequence, uint8_t* buf, size_t cap, size_t* len_out) {
+    if (!env || (!payload && payload_len) || !len_out) return DCF_ERR_NULL_PTR;
+    *len_out = dcf_envelope_packed_size(env, payload_len, timestamp, sequence);
+    if (!buf || *len_out > cap) return DCF_ERR_INVALID_ARG;
+    memcpy(buf, env->prefix, env->prefix_len);
+    uint8_t* p = buf + env->prefix_len;
+    if (payload_len) {
+        *p++ = DCF_KEY_DATA;
+        p = dcf_put_varint(p, payload_len);
+        memcpy(p, payload, payload_len);
+        p += payload_len;
+    }
+    if (timestamp) {
+        *p++ = DCF_KEY_TIMESTAMP;
+        p = dcf_put_varint(p, (uint64_t)timestamp);
+    }
+    *p++ = DCF_KEY_SYNC;
+    *p++ = 0;
+    *p++ = DCF_KEY_SEQUENCE;
+    p = dcf_put_varint(p, sequence);
+    memcpy(p, env->suffix, env->suffix_len);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_envelope_pack_scratch(const DCFEnvelope* env, const uint8_t* payload, size_t payload_len, int64_t timestamp, uint32_t sequence, const uint8_t** serialized_out, size_t* len_out) {
+    if (!env || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
+    DCFThreadBuffers* tb = dcf_thread_buffers_get();
+    if (!dcf_scratch_reserve(tb, dcf_envelope_packed_size(env, payload_len, timestamp, sequence))) return DCF_ERR_MALLOC_FAIL;
+    DCFError err = dcf_envelope_pack(env, payload, payload_len, timestamp, sequence, tb->scratch, tb->scratch_cap, len_out);
+    if (err == DCF_SUCCESS) *serialized_out = tb->scratch;
+    return err;
+}
+
+void dcf_envelope_free(DCFEnvelope* env) {
+    free(env);
+}
+
+DCFError dcf_serialize_rerouted_scratch(const uint8_t* data, size_t len, const uint8_t* path, size_t path_len, const uint8_t** serialized_out, size_t* len_out) {
+    if (!data || (!path && path_len) || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
+    DCFThreadBuffers* tb = dcf_thread_buffers_get();
+    size_t total = len + 1 + dcf_varint_size(path_len) + path_len;
+    // A message packed into scratch is extended where it lies; growing keeps its bytes
+    bool in_place = data == tb->scratch;
+    if (!dcf_scratch_reserve(tb, total)) return DCF_ERR_MALLOC_FAIL;
+    // A later occurrence of a field overrides earlier ones, so the old path can stay
+    if (!in_place) memcpy(tb->scratch, data, len);
+    uint8_t* p = tb->scratch + len;
+    *p++ = DCF_KEY_REDUNDANCY_PATH;
+    p = dcf_put_varint(p, path_len);
+    memcpy(p, path, path_len);
+    *serialized_out = tb->scratch;
+    *len_out = total;
     return DCF_SUCCESS;
 }
 
 DCFError dcf_serialize_health_request(const char* peer, uint8_t** serialized_out, size_t* len_out) {
     if (!peer || !serialized_out || !len_out) return DCF_ERR_NULL_PTR;
-    HealthRequest req = HEALTH_REQUEST__INIT;
-    req.peer = strdup(peer);
-    *len_out = health_request__get_packed_size(&req);
-    *serialized_out = calloc(1, *len_out);
-    if (!*serialized_out) {
-        free(req.peer);
-        return DCF_ERR_MALLOC_FAIL;
-    }
-    health_request__pack(&req, *serialized_out);
-    free(req.peer);
+    // A DCFMessage rather than a HealthRequest, so every receive path can tell it by group_id
+    DCFMessage msg = DCF_MESSAGE__INIT;
+    msg.recipient = (char*)peer;
+    msg.group_id = (char*)DCF_GROUP_HEALTH;
+    *len_out = dcf_message__get_packed_size(&msg);
+    *serialized_out = calloc(1, *len_out ? *len_out : 1);
+    if (!*serialized_out) return DCF_ERR_MALLOC_FAIL;
+    dcf_message__pack(&msg, *serialized_out);
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_deserialize_payload_view(const uint8_t* data, size_t len, const uint8_t** payload_out, size_t* payload_len_out, const char** sender_out) {
+    if (!data || !payload_out || !payload_len_out || !sender_out || len == 0) return DCF_ERR_NULL_PTR;
+    DCFThreadBuffers* tb = dcf_thread_buffers_get();
+    dcf_arena_reset(tb);
+    ProtobufCAllocator allocator = { dcf_arena_alloc, dcf_arena_free, tb };
+    DCFMessage* msg = dcf_message__unpack(&allocator, len, data);
+    if (!msg) return DCF_ERR_DESERIALIZATION_FAIL;
+    // An empty payload still points at a NUL, so it reads as "" through the string API
+    *payload_out = msg->data.data ? msg->data.data : (const uint8_t*)"";
+    *payload_len_out = msg->data.data ? msg->data.len : 0;
+    *sender_out = msg->sender ? msg->sender : "";
     return DCF_SUCCESS;
 }
 
+DCFError dcf_deserialize_message_view(const uint8_t* data, size_t len, const char** message_out, const char** sender_out) {
+    if (!message_out) return DCF_ERR_NULL_PTR;
+    const uint8_t* payload;
+    size_t payload_len;
+    DCFError err = dcf_deserialize_payload_view(data, len, &payload, &payload_len, sender_out);
+    if (err == DCF_SUCCESS) *message_out = (const char*)payload;
+    return err;
+}
+
 DCFError dcf_deserialize_message(const uint8_t* data, size_t len, char** message_out, char** sender_out) {
     if (!data || !message_out || !sender_out || len == 0) return DCF_ERR_NULL_PTR;
-    DCFMessage* msg = dcf_message__unpack(NULL, len, data);
-    if (!msg) return DCF_ERR_DESERIALIZATION_FAIL;
-    *message_out = strdup((char*)msg->data.data);
-    *sender_out = strdup(msg->sender);
-    dcf_message__free_unpacked(msg, NULL);
+    const char* message;
+    const char* sender;
+    DCFError err = dcf_deserialize_message_view(data, len, &message, &sender);
+    if (err != DCF_SUCCESS) return err;
+    *message_out = strdup(message);
+    *sender_out = strdup(sender);
     if (!*message_out || !*sender_out) {
         free(*message_out);
         free(*sender_out);
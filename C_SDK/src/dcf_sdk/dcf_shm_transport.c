@@ -0,0 +1,413 @@
+#define _GNU_SOURCE
+#include "dcf_shm_transport.h"
+#include "dcf_address.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DCF_SHM_MAGIC 0x44434652u
+#define DCF_SHM_PEER_CACHE 64
+#define DCF_SHM_ADDR_MAX 128
+// How long a local recipient without a ring is remembered before looking again
+#define DCF_SHM_RECHECK_MS 1000
+// Initial slots of the host locality table, which doubles at half full
+#define DCF_SHM_HOSTS_INITIAL 64
+// Polls of an empty ring before the receiver sleeps on the futex
+#define DCF_SHM_SPIN 2000
+// Yields a sender makes on a full ring before giving up
+#define DCF_SHM_FULL_RETRIES 1000
+
+// What a consumer with an empty ring is waiting on
+enum { DCF_SHM_AWAKE, DCF_SHM_WAIT_FUTEX, DCF_SHM_WAIT_FD };
+
+typedef struct {
+    uint64_t seq;
+    uint32_t len;
+    uint32_t reserved;
+    uint8_t data[DCF_SHM_MAX_MESSAGE];
+} DCFShmSlot;
+
+// Bounded MPSC queue (Vyukov): a slot is free for position p when seq == p and
+// holds a message when seq == p + 1. Producer and consumer state sit on
+// separate cache lines.
+typedef struct {
+    uint32_t magic;
+    uint32_t closed;
+    int32_t owner;
+    uint8_t pad0[52];
+    uint64_t enqueue_pos;
+    uint8_t pad1[56];
+    uint64_t dequeue_pos;
+    uint32_t wake_seq;  // futex word, bumped by producers that find the consumer asleep
+    uint32_t sleeping;  // DCF_SHM_AWAKE or how to wake the consumer
+    uint8_t pad2[48];
+    DCFShmSlot slots[DCF_SHM_SLOTS];
+} DCFShmRing;
+
+typedef struct {
+    char* host;  // NULL for an empty slot
+    bool local;
+} DCFShmHost;
+
+typedef struct {
+    char key[DCF_SHM_ADDR_MAX];
+    DCFShmRing* ring;  // NULL when the recipient has no ring
+    int port;
+    uint64_t checked_ms;
+    bool valid;
+} DCFShmPeer;
+
+struct DCFShmTransport {
+    int port;
+    char name[32];
+    DCFShmRing* ring;
+    bool holding;  // the slot at dequeue_pos is lent to the caller
+    int doorbell_fd;  // pollable wake-up socket bound to the ring's name
+    int bell_fd;      // unbound socket for ringing peers' doorbells
+    // Guards peers and bell_fd: a lookup may unmap a ring another sender is filling
+    pthread_mutex_t peers_mutex;
+    DCFShmPeer peers[DCF_SHM_PEER_CACHE];
+    // Whether each host seen is this machine, resolved once and kept for good
+    pthread_mutex_t hosts_mutex;
+    DCFShmHost* hosts;
+    size_t hosts_cap;
+    size_t hosts_count;
+};
+
+static uint64_t dcf_shm_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static long dcf_shm_futex(uint32_t* addr, int op, uint32_t val, const struct timespec* timeout) {
+    return syscall(SYS_futex, addr, op, val, timeout, NULL, 0);
+}
+
+// Doorbells live in the abstract socket namespace under the ring's name
+static socklen_t dcf_shm_doorbell_addr(struct sockaddr_un* addr, int port) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    int len = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, "dcf-shm-%d", port);
+    return offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+static void dcf_shm_ring_doorbell(DCFShmTransport* shm, int port) {
+    if (shm->bell_fd < 0) shm->bell_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (shm->bell_fd < 0) return;
+    struct sockaddr_un addr;
+    socklen_t addr_len = dcf_shm_doorbell_addr(&addr, port);
+    uint8_t bell = 1;
+    // A full doorbell already has a wake-up pending, so a failed send loses nothing
+    sendto(shm->bell_fd, &bell, 1, MSG_DONTWAIT, (struct sockaddr*)&addr, addr_len);
+}
+
+static DCFShmRing* dcf_shm_map(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void* ring = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(DCFShmRing)) {
+        ring = mmap(NULL, sizeof(DCFShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return ring == MAP_FAILED ? NULL : ring;
+}
+
+static DCFShmRing* dcf_shm_open_peer(int port) {
+    char name[32];
+    snprintf(name, sizeof(name), "/dcf-shm-%d", port);
+    DCFShmRing* ring = dcf_shm_map(name);
+    if (ring && (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != DCF_SHM_MAGIC || __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE))) {
+        munmap(ring, sizeof(DCFShmRing));
+        return NULL;
+    }
+    return ring;
+}
+
+// A segment left behind by an owner that exited without cleaning up
+static bool dcf_shm_is_stale(const char* name) {
+    DCFShmRing* ring = dcf_shm_map(name);
+    if (!ring) return true;
+    int32_t owner = __atomic_load_n(&ring->owner, __ATOMIC_ACQUIRE);
+    bool stale = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) || owner <= 0 || (kill(owner, 0) != 0 && errno == ESRCH);
+    munmap(ring, sizeof(DCFShmRing));
+    return stale;
+}
+
+static uint32_t dcf_shm_hash(const char* s) {
+    uint32_t hash = 2166136261u;
+    for (; *s; s++) hash = (hash ^ (uint8_t)*s) * 16777619u;
+    return hash;
+}
+
+// Slot holding host, or the empty slot it would go in; hosts_mutex held
+static DCFShmHost* dcf_shm_host_slot(DCFShmHost* hosts, size_t cap, const char* host) {
+    size_t mask = cap - 1;
+    for (size_t i = dcf_shm_hash(host) & mask;; i = (i + 1) & mask) {
+        if (!hosts[i].host || strcmp(hosts[i].host, host) == 0) return &hosts[i];
+    }
+}
+
+static bool dcf_shm_host_insert(DCFShmTransport* shm, const char* host, bool local) {
+    if ((shm->hosts_count + 1) * 2 > shm->hosts_cap) {
+        size_t cap = shm->hosts_cap ? shm->hosts_cap * 2 : DCF_SHM_HOSTS_INITIAL;
+        DCFShmHost* hosts = calloc(cap, sizeof(DCFShmHost));
+        if (!hosts) return false;
+        for (size_t i = 0; i < shm->hosts_cap; i++) {
+            if (shm->hosts[i].host) *dcf_shm_host_slot(hosts, cap, shm->hosts[i].host) = shm->hosts[i];
+        }
+        free(shm->hosts);
+        shm->hosts = hosts;
+        shm->hosts_cap = cap;
+    }
+    DCFShmHost* slot = dcf_shm_host_slot(shm->hosts, shm->hosts_cap, host);
+    if (slot->host) return true;
+    slot->host = strdup(host);
+    if (!slot->host) return false;
+    slot->local = local;
+    shm->hosts_count++;
+    return true;
+}
+
+// Whether host is this machine. The first lookup of a host resolves it with no
+// lock held, since that can mean DNS; every later one is a table probe.
+static bool dcf_shm_host_is_local(DCFShmTransport* shm, const char* host) {
+    pthread_mutex_lock(&shm->hosts_mutex);
+    DCFShmHost* slot = shm->hosts ? dcf_shm_host_slot(shm->hosts, shm->hosts_cap, host) : NULL;
+    bool known = slot && slot->host;
+    bool local = known && slot->local;
+    pthread_mutex_unlock(&shm->hosts_mutex);
+    if (known) return local;
+    local = dcf_address_is_local(host);
+    pthread_mutex_lock(&shm->hosts_mutex);
+    // Unremembered on allocation failure, so the host is resolved again next time
+    dcf_shm_host_insert(shm, host, local);
+    pthread_mutex_unlock(&shm->hosts_mutex);
+    return local;
+}
+
+// Port of a recipient on this machine, or 0 for a remote or unparsable one
+static int dcf_shm_local_port(DCFShmTransport* shm, const char* recipient) {
+    char host[256], port[16];
+    if (!dcf_address_split(recipient, host, sizeof(host), port, sizeof(port)) || atoi(port) <= 0) return 0;
+    return dcf_shm_host_is_local(shm, host) ? atoi(port) : 0;
+}
+
+// The cached ring of a local recipient; peers_mutex held
+static DCFShmPeer* dcf_shm_peer(DCFShmTransport* shm, const char* recipient, int port) {
+    size_t key_len = strlen(recipient);
+    if (key_len >= DCF_SHM_ADDR_MAX) return NULL;
+    DCFShmPeer* peer = &shm->peers[dcf_shm_hash(recipient) % DCF_SHM_PEER_CACHE];
+    uint64_t now = dcf_shm_now_ms();
+    if (peer->valid && strcmp(peer->key, recipient) == 0) {
+        if (peer->ring && !__atomic_load_n(&peer->ring->closed, __ATOMIC_ACQUIRE)) return peer;
+        if (!peer->ring && now - peer->checked_ms < DCF_SHM_RECHECK_MS) return peer;
+    }
+    if (peer->ring) munmap(peer->ring, sizeof(DCFShmRing));
+    peer->ring = NULL;
+    memcpy(peer->key, recipient, key_len + 1);
+    peer->checked_ms = now;
+    peer->valid = true;
+    peer->port = port;
+    peer->ring = dcf_shm_open_peer(port);
+    return peer;
+}
+
+static DCFShmSlot* dcf_shm_peek(DCFShmRing* ring) {
+    uint64_t pos = ring->dequeue_pos;
+    DCFShmSlot* slot = &ring->slots[pos % DCF_SHM_SLOTS];
+    return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1 ? slot : NULL;
+}
+
+static void dcf_shm_release(DCFShmRing* ring) {
+    uint64_t pos = ring->dequeue_pos;
+    __atomic_store_n(&ring->slots[pos % DCF_SHM_SLOTS].seq, pos + DCF_SHM_SLOTS, __ATOMIC_RELEASE);
+    ring->dequeue_pos = pos + 1;
+}
+
+static bool dcf_shm_enqueue(DCFShmTransport* shm, DCFShmPeer* peer, const uint8_t* data, size_t len) {
+    DCFShmRing* ring = peer->ring;
+    uint64_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    DCFShmSlot* slot;
+    while (true) {
+        slot = &ring->slots[pos % DCF_SHM_SLOTS];
+        int64_t diff = (int64_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(slot->data, data, len);
+    slot->len = len;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    // Pairs with the fence in receive: either the consumer sees the message or we see it sleeping
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint32_t sleeping = __atomic_load_n(&ring->sleeping, __ATOMIC_RELAXED);
+    if (sleeping == DCF_SHM_WAIT_FUTEX) {
+        __atomic_add_fetch(&ring->wake_seq, 1, __ATOMIC_SEQ_CST);
+        dcf_shm_futex(&ring->wake_seq, FUTEX_WAKE, 1, NULL);
+    } else if (sleeping == DCF_SHM_WAIT_FD) {
+        // Only the producer that disarms the doorbell rings it
+        if (__atomic_compare_exchange_n(&ring->sleeping, &sleeping, DCF_SHM_AWAKE, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            dcf_shm_ring_doorbell(shm, peer->port);
+        }
+    }
+    return true;
+}
+
+DCFShmTransport* dcf_shm_transport_new(void) {
+    DCFShmTransport* shm = calloc(1, sizeof(DCFShmTransport));
+    if (!shm) return NULL;
+    shm->doorbell_fd = -1;
+    shm->bell_fd = -1;
+    pthread_mutex_init(&shm->peers_mutex, NULL);
+    pthread_mutex_init(&shm->hosts_mutex, NULL);
+    return shm;
+}
+
+DCFError dcf_shm_transport_initialize(DCFShmTransport* shm, int port) {
+    if (!shm) return DCF_ERR_NULL_PTR;
+    if (shm->ring) return DCF_ERR_INVALID_STATE;
+    shm->port = port;
+    if (port <= 0) return DCF_SUCCESS;
+    snprintf(shm->name, sizeof(shm->name), "/dcf-shm-%d", port);
+    int fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST && dcf_shm_is_stale(shm->name)) {
+        shm_unlink(shm->name);
+        fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) return errno == EEXIST ? DCF_ERR_INVALID_STATE : DCF_ERR_NETWORK_FAIL;
+    void* ring = MAP_FAILED;
+    if (ftruncate(fd, sizeof(DCFShmRing)) == 0) {
+        ring = mmap(NULL, sizeof(DCFShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (ring == MAP_FAILED) {
+        shm_unlink(shm->name);
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    shm->ring = ring;
+    struct sockaddr_un addr;
+    socklen_t addr_len = dcf_shm_doorbell_addr(&addr, port);
+    shm->doorbell_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (shm->doorbell_fd >= 0 && bind(shm->doorbell_fd, (struct sockaddr*)&addr, addr_len) != 0) {
+        close(shm->doorbell_fd);
+        shm->doorbell_fd = -1;
+    }
+    __atomic_store_n(&shm->ring->owner, (int32_t)getpid(), __ATOMIC_RELEASE);
+    for (uint64_t i = 0; i < DCF_SHM_SLOTS; i++) shm->ring->slots[i].seq = i;
+    __atomic_store_n(&shm->ring->magic, DCF_SHM_MAGIC, __ATOMIC_RELEASE);
+    return DCF_SUCCESS;
+}
+
+bool dcf_shm_transport_reaches(DCFShmTransport* shm, const char* recipient) {
+    if (!shm || !recipient) return false;
+    int port = dcf_shm_local_port(shm, recipient);
+    if (!port) return false;
+    pthread_mutex_lock(&shm->peers_mutex);
+    DCFShmPeer* peer = dcf_shm_peer(shm, recipient, port);
+    bool reaches = peer && peer->ring;
+    pthread_mutex_unlock(&shm->peers_mutex);
+    return reaches;
+}
+
+DCFError dcf_shm_transport_send(DCFShmTransport* shm, const uint8_t* data, size_t len, const char* recipient) {
+    if (!shm || !data || !recipient) return DCF_ERR_NULL_PTR;
+    if (len > DCF_SHM_MAX_MESSAGE) return DCF_ERR_INVALID_ARG;
+    int port = dcf_shm_local_port(shm, recipient);
+    if (!port) return DCF_ERR_ROUTE_NOT_FOUND;
+    pthread_mutex_lock(&shm->peers_mutex);
+    DCFShmPeer* peer = dcf_shm_peer(shm, recipient, port);
+    DCFError err = peer && peer->ring ? DCF_SUCCESS : DCF_ERR_ROUTE_NOT_FOUND;
+    for (int attempt = 0; err == DCF_SUCCESS && !dcf_shm_enqueue(shm, peer, data, len); attempt++) {
+        if (attempt >= DCF_SHM_FULL_RETRIES) err = DCF_ERR_TIMEOUT;
+        else sched_yield();
+    }
+    pthread_mutex_unlock(&shm->peers_mutex);
+    return err;
+}
+
+DCFError dcf_shm_transport_receive(DCFShmTransport* shm, int timeout_ms, const uint8_t** data_out, size_t* len_out) {
+    if (!shm || !data_out || !len_out) return DCF_ERR_NULL_PTR;
+    if (!shm->ring) return DCF_ERR_INVALID_STATE;
+    DCFShmRing* ring = shm->ring;
+    if (shm->holding) {
+        dcf_shm_release(ring);
+        shm->holding = false;
+    }
+    DCFShmSlot* slot = dcf_shm_peek(ring);
+    if (!slot && timeout_ms == 0 && shm->doorbell_fd >= 0) {
+        // Leave the doorbell armed so the fd turns readable on the next send
+        uint8_t bells[64];
+        while (recv(shm->doorbell_fd, bells, sizeof(bells), MSG_DONTWAIT) > 0) {}
+        __atomic_store_n(&ring->sleeping, DCF_SHM_WAIT_FD, __ATOMIC_SEQ_CST);
+        slot = dcf_shm_peek(ring);
+        if (slot) __atomic_store_n(&ring->sleeping, DCF_SHM_AWAKE, __ATOMIC_RELAXED);
+    }
+    for (int i = 0; !slot && timeout_ms != 0 && i < DCF_SHM_SPIN; i++) slot = dcf_shm_peek(ring);
+    uint64_t deadline = dcf_shm_now_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    while (!slot && timeout_ms != 0) {
+        struct timespec ts;
+        if (timeout_ms > 0) {
+            uint64_t now = dcf_shm_now_ms();
+            if (now >= deadline) break;
+            ts.tv_sec = (deadline - now) / 1000;
+            ts.tv_nsec = ((deadline - now) % 1000) * 1000000L;
+        }
+        __atomic_store_n(&ring->sleeping, DCF_SHM_WAIT_FUTEX, __ATOMIC_SEQ_CST);
+        uint32_t seq = __atomic_load_n(&ring->wake_seq, __ATOMIC_SEQ_CST);
+        slot = dcf_shm_peek(ring);
+        if (!slot) {
+            dcf_shm_futex(&ring->wake_seq, FUTEX_WAIT, seq, timeout_ms > 0 ? &ts : NULL);
+            slot = dcf_shm_peek(ring);
+        }
+        __atomic_store_n(&ring->sleeping, DCF_SHM_AWAKE, __ATOMIC_RELAXED);
+    }
+    if (!slot) return DCF_ERR_TIMEOUT;
+    shm->holding = true;
+    *data_out = slot->data;
+    *len_out = slot->len;
+    return DCF_SUCCESS;
+}
+
+int dcf_shm_transport_get_fd(DCFShmTransport* shm) {
+    if (!shm) return -1;
+    return shm->doorbell_fd;
+}
+
+void dcf_shm_transport_free(DCFShmTransport* shm) {
+    if (!shm) return;
+    if (shm->doorbell_fd >= 0) close(shm->doorbell_fd);
+    if (shm->bell_fd >= 0) close(shm->bell_fd);
+    for (size_t i = 0; i < DCF_SHM_PEER_CACHE; i++) {
+        if (shm->peers[i].ring) munmap(shm->peers[i].ring, sizeof(DCFShmRing));
+    }
+    if (shm->ring) {
+        __atomic_store_n(&shm->ring->closed, 1, __ATOMIC_RELEASE);
+        munmap(shm->ring, sizeof(DCFShmRing));
+        shm_unlink(shm->name);
+    }
+    for (size_t i = 0; i < shm->hosts_cap; i++) free(shm->hosts[i].host);
+    free(shm->hosts);
+    pthread_mutex_destroy(&shm->peers_mutex);
+    pthread_mutex_destroy(&shm->hosts_mutex);
+    free(shm);
+}
@@ -0,0 +1,461 @@
+#define _GNU_SOURCE
+#include "dcf_tcp_transport.h"
+#include "dcf_address.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DCF_TCP_RX_INITIAL 65536
+#define DCF_TCP_EPOLL_EVENTS 64
+
+typedef struct {
+    int fd;
+    char* peer;  // "host:port" for connections we dialed, NULL for accepted ones
+    // Reusable receive buffer: unread bytes live in [rx_start, rx_end). The
+    // unread tail is moved to the front instead of wrapping, so every frame
+    // stays contiguous and can be handed out without a copy.
+    uint8_t* rx;
+    size_t rx_cap;
+    size_t rx_start;
+    size_t rx_end;
+    bool closed;
+    bool ready;
+    int writers;  // senders holding the connection outside the table lock
+    // Keeps one sender's frames contiguous; other connections are not held up
+    pthread_mutex_t write_mutex;
+} DCFTcpConn;
+
+struct DCFTcpTransport {
+    int listen_fd;
+    int epoll_fd;
+    int rcvbuf;
+    int sndbuf;
+    DCFTcpConn** conns;
+    size_t conn_count;
+    size_t conn_cap;
+    // Connections with unread bytes, drained in order before waiting again
+    DCFTcpConn** ready;
+    size_t ready_pos;
+    size_t ready_count;
+    // Guards the tables and the per-connection flags. The receiver drops it
+    // only while in epoll_wait; in_wait tells senders that events it has not
+    // looked at yet may still point at closed connections.
+    pthread_mutex_t mutex;
+    bool in_wait;
+};
+
+static uint64_t dcf_tcp_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Milliseconds left until deadline, for poll; 0 once it has passed
+static int dcf_tcp_remaining_ms(uint64_t deadline) {
+    uint64_t now = dcf_tcp_now_ms();
+    return now < deadline ? (int)(deadline - now) : 0;
+}
+
+static void dcf_tcp_tune_socket(DCFTcpTransport* tcp, int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (tcp->rcvbuf > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &tcp->rcvbuf, sizeof(tcp->rcvbuf));
+    if (tcp->sndbuf > 0) setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &tcp->sndbuf, sizeof(tcp->sndbuf));
+}
+
+static DCFTcpConn* dcf_tcp_conn_add(DCFTcpTransport* tcp, int fd, const char* peer) {
+    if (tcp->conn_count == tcp->conn_cap) {
+        size_t cap = tcp->conn_cap ? tcp->conn_cap * 2 : 16;
+        DCFTcpConn** conns = realloc(tcp->conns, cap * sizeof(DCFTcpConn*));
+        if (!conns) return NULL;
+        tcp->conns = conns;
+        DCFTcpConn** ready = realloc(tcp->ready, cap * sizeof(DCFTcpConn*));
+        if (!ready) return NULL;
+        tcp->ready = ready;
+        tcp->conn_cap = cap;
+    }
+    DCFTcpConn* conn = calloc(1, sizeof(DCFTcpConn));
+    if (!conn) return NULL;
+    conn->fd = fd;
+    conn->rx = malloc(DCF_TCP_RX_INITIAL);
+    conn->rx_cap = DCF_TCP_RX_INITIAL;
+    conn->peer = peer ? strdup(peer) : NULL;
+    if (!conn->rx || (peer && !conn->peer)) {
+        free(conn->rx);
+        free(conn->peer);
+        free(conn);
+        return NULL;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = conn };
+    if (epoll_ctl(tcp->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        free(conn->rx);
+        free(conn->peer);
+        free(conn);
+        return NULL;
+    }
+    pthread_mutex_init(&conn->write_mutex, NULL);
+    tcp->conns[tcp->conn_count++] = conn;
+    return conn;
+}
+
+// The fd stays open until the connection is removed, so a sender still
+// writing to it gets an error rather than someone else's socket
+static void dcf_tcp_conn_close(DCFTcpTransport* tcp, DCFTcpConn* conn) {
+    if (conn->closed) return;
+    epoll_ctl(tcp->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    shutdown(conn->fd, SHUT_RDWR);
+    conn->closed = true;
+}
+
+// Whether nothing can still reach a closed connection
+static bool dcf_tcp_conn_reapable(DCFTcpTransport* tcp, DCFTcpConn* conn) {
+    return conn->closed && !conn->ready && conn->writers == 0 && !tcp->in_wait;
+}
+
+static void dcf_tcp_conn_remove(DCFTcpTransport* tcp, DCFTcpConn* conn) {
+    dcf_tcp_conn_close(tcp, conn);
+    close(conn->fd);
+    for (size_t i = 0; i < tcp->conn_count; i++) {
+        if (tcp->conns[i] == conn) {
+            tcp->conns[i] = tcp->conns[--tcp->conn_count];
+            break;
+        }
+    }
+    pthread_mutex_destroy(&conn->write_mutex);
+    free(conn->rx);
+    free(conn->peer);
+    free(conn);
+}
+
+// Connects without blocking past deadline, then hands back a blocking socket;
+// sends still never block, they pass MSG_DONTWAIT
+static int dcf_tcp_dial(DCFTcpTransport* tcp, const char* recipient, uint64_t deadline) {
+    struct addrinfo* res;
+    if (!dcf_address_resolve(recipient, AF_UNSPEC, SOCK_STREAM, &res)) return -1;
+    int fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) { freeaddrinfo(res); return -1; }
+    dcf_tcp_tune_socket(tcp, fd);
+    int rc = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc != 0 && errno == EINPROGRESS) {
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+        do {
+            rc = poll(&pfd, 1, dcf_tcp_remaining_ms(deadline));
+        } while (rc < 0 && errno == EINTR);
+        int so_error = 0;
+        socklen_t so_len = sizeof(so_error);
+        rc = rc == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &so_len) == 0 && so_error == 0 ? 0 : -1;
+    }
+    if (rc != 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// The recipient's open connection, counted as held by one more writer; the
+// caller holds tcp->mutex
+static DCFTcpConn* dcf_tcp_find(DCFTcpTransport* tcp, const char* recipient) {
+    for (size_t i = 0; i < tcp->conn_count; i++) {
+        DCFTcpConn* conn = tcp->conns[i];
+        if (!conn->peer || strcmp(conn->peer, recipient) != 0) continue;
+        if (!conn->closed) {
+            conn->writers++;
+            return conn;
+        }
+        // A dead connection nobody is draining; reconnect in its place
+        if (dcf_tcp_conn_reapable(tcp, conn)) {
+            dcf_tcp_conn_remove(tcp, conn);
+            i--;
+        }
+    }
+    return NULL;
+}
+
+// Finds or dials the recipient's connection and holds it for writing. Dialing
+// happens without the table lock, so a slow peer only delays its own senders.
+static DCFTcpConn* dcf_tcp_connect(DCFTcpTransport* tcp, const char* recipient, uint64_t deadline) {
+    pthread_mutex_lock(&tcp->mutex);
+    DCFTcpConn* conn = dcf_tcp_find(tcp, recipient);
+    pthread_mutex_unlock(&tcp->mutex);
+    if (conn) return conn;
+    int fd = dcf_tcp_dial(tcp, recipient, deadline);
+    if (fd < 0) return NULL;
+    pthread_mutex_lock(&tcp->mutex);
+    // Another sender may have connected meanwhile; keep its connection
+    conn = dcf_tcp_find(tcp, recipient);
+    if (!conn) {
+        conn = dcf_tcp_conn_add(tcp, fd, recipient);
+        if (conn) conn->writers++;
+    }
+    pthread_mutex_unlock(&tcp->mutex);
+    if (!conn || conn->fd != fd) close(fd);
+    return conn;
+}
+
+static bool dcf_tcp_send_all(int fd, struct iovec* iov, int count, uint64_t deadline) {
+    while (count > 0) {
+        // MSG_NOSIGNAL: a peer that went away fails the send instead of raising SIGPIPE
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = count };
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            // A peer that stops reading fills the socket buffer; wait for room until the deadline
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            int timeout = dcf_tcp_remaining_ms(deadline);
+            if (timeout == 0 || (poll(&pfd, 1, timeout) < 0 && errno != EINTR)) return false;
+            continue;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+static DCFError dcf_tcp_send_frames(DCFTcpTransport* tcp, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, int timeout_ms) {
+    if (!tcp || !data || !lens || !recipient) return DCF_ERR_NULL_PTR;
+    if (tcp->listen_fd < 0) return DCF_ERR_INVALID_STATE;
+    for (size_t i = 0; i < count; i++) {
+        if (lens[i] > DCF_TCP_MAX_FRAME) return DCF_ERR_INVALID_ARG;
+    }
+    uint64_t deadline = dcf_tcp_now_ms() + (timeout_ms > 0 ? timeout_ms : DCF_TCP_SEND_TIMEOUT_MS);
+    DCFTcpConn* conn = dcf_tcp_connect(tcp, recipient, deadline);
+    if (!conn) return DCF_ERR_NETWORK_FAIL;
+    pthread_mutex_lock(&conn->write_mutex);
+    uint32_t headers[DCF_TCP_WRITE_BATCH];
+    struct iovec iov[2 * DCF_TCP_WRITE_BATCH];
+    bool ok = true;
+    for (size_t done = 0; ok && done < count;) {
+        int iov_count = 0;
+        size_t chunk = count - done;
+        if (chunk > DCF_TCP_WRITE_BATCH) chunk = DCF_TCP_WRITE_BATCH;
+        for (size_t i = 0; i < chunk; i++) {
+            size_t len = lens[done + i];
+            headers[i] = htonl((uint32_t)len);
+            iov[iov_count].iov_base = &headers[i];
+            iov[iov_count++].iov_len = DCF_TCP_FRAME_HEADER;
+            iov[iov_count].iov_base = (void*)data[done + i];
+            iov[iov_count++].iov_len = len;
+        }
+        ok = dcf_tcp_send_all(conn->fd, iov, iov_count, deadline);
+        done += chunk;
+    }
+    pthread_mutex_unlock(&conn->write_mutex);
+    pthread_mutex_lock(&tcp->mutex);
+    conn->writers--;
+    // A frame cut short leaves the stream unparseable, so the connection goes
+    if (!ok) dcf_tcp_conn_close(tcp, conn);
+    pthread_mutex_unlock(&tcp->mutex);
+    return ok ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+}
+
+// Pops one complete frame from the connection's buffer, if there is one
+static bool dcf_tcp_next_frame(DCFTcpTransport* tcp, DCFTcpConn* conn, const uint8_t** frame_out, size_t* len_out) {
+    size_t avail = conn->rx_end - conn->rx_start;
+    if (avail < DCF_TCP_FRAME_HEADER) return false;
+    uint32_t be_len;
+    memcpy(&be_len, conn->rx + conn->rx_start, DCF_TCP_FRAME_HEADER);
+    size_t len = ntohl(be_len);
+    if (len > DCF_TCP_MAX_FRAME) {
+        // Not a DCF peer or a corrupt stream; drop whatever is buffered
+        dcf_tcp_conn_close(tcp, conn);
+        conn->rx_start = conn->rx_end = 0;
+        return false;
+    }
+    if (avail < DCF_TCP_FRAME_HEADER + len) return false;
+    *frame_out = conn->rx + conn->rx_start + DCF_TCP_FRAME_HEADER;
+    *len_out = len;
+    conn->rx_start += DCF_TCP_FRAME_HEADER + len;
+    return true;
+}
+
+// Reads whatever the socket has into the free space after rx_end
+static void dcf_tcp_fill(DCFTcpTransport* tcp, DCFTcpConn* conn) {
+    if (conn->rx_start == conn->rx_end) {
+        conn->rx_start = conn->rx_end = 0;
+    }
+    size_t avail = conn->rx_end - conn->rx_start;
+    size_t needed = DCF_TCP_RX_INITIAL;
+    if (avail >= DCF_TCP_FRAME_HEADER) {
+        uint32_t be_len;
+        memcpy(&be_len, conn->rx + conn->rx_start, DCF_TCP_FRAME_HEADER);
+        size_t frame = DCF_TCP_FRAME_HEADER + ntohl(be_len);
+        if (frame > needed) needed = frame;
+    }
+    if (conn->rx_cap - conn->rx_start < needed || conn->rx_cap - conn->rx_end < conn->rx_cap / 4) {
+        memmove(conn->rx, conn->rx + conn->rx_start, avail);
+        conn->rx_start = 0;
+        conn->rx_end = avail;
+    }
+    if (conn->rx_cap < needed && needed <= DCF_TCP_FRAME_HEADER + DCF_TCP_MAX_FRAME) {
+        uint8_t* rx = realloc(conn->rx, needed);
+        if (!rx) {
+            dcf_tcp_conn_close(tcp, conn);
+            return;
+        }
+        conn->rx = rx;
+        conn->rx_cap = needed;
+    }
+    ssize_t n;
+    do {
+        n = read(conn->fd, conn->rx + conn->rx_end, conn->rx_cap - conn->rx_end);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        dcf_tcp_conn_close(tcp, conn);
+        return;
+    }
+    conn->rx_end += n;
+}
+
+DCFTcpTransport* dcf_tcp_transport_new(void) {
+    DCFTcpTransport* tcp = calloc(1, sizeof(DCFTcpTransport));
+    if (!tcp) return NULL;
+    tcp->listen_fd = -1;
+    tcp->epoll_fd = -1;
+    pthread_mutex_init(&tcp->mutex, NULL);
+    return tcp;
+}
+
+DCFError dcf_tcp_transport_initialize(DCFTcpTransport* tcp, const char* host, int port, int rcvbuf, int sndbuf) {
+    if (!tcp || !host) return DCF_ERR_NULL_PTR;
+    if (tcp->listen_fd >= 0) return DCF_ERR_INVALID_STATE;
+    tcp->rcvbuf = rcvbuf;
+    tcp->sndbuf = sndbuf;
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    struct addrinfo hints = {0}, *res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return DCF_ERR_NETWORK_FAIL;
+    tcp->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    tcp->listen_fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (tcp->epoll_fd < 0 || tcp->listen_fd < 0 ||
+        setsockopt(tcp->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(tcp->listen_fd, res->ai_addr, res->ai_addrlen) != 0 ||
+        listen(tcp->listen_fd, SOMAXCONN) != 0) {
+        freeaddrinfo(res);
+        if (tcp->listen_fd >= 0) close(tcp->listen_fd);
+        if (tcp->epoll_fd >= 0) close(tcp->epoll_fd);
+        tcp->listen_fd = tcp->epoll_fd = -1;
+        return DCF_ERR_NETWORK_FAIL;
+    }
+    freeaddrinfo(res);
+    dcf_tcp_tune_socket(tcp, tcp->listen_fd);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epoll_ctl(tcp->epoll_fd, EPOLL_CTL_ADD, tcp->listen_fd, &ev) != 0) {
+        close(tcp->listen_fd);
+        close(tcp->epoll_fd);
+        tcp->listen_fd = tcp->epoll_fd = -1;
+        return DCF_ERR_NETWORK_FAIL;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_tcp_transport_send(DCFTcpTransport* tcp, const uint8_t* data, size_t len, const char* recipient) {
+    return dcf_tcp_transport_send_timeout(tcp, data, len, recipient, 0);
+}
+
+DCFError dcf_tcp_transport_send_timeout(DCFTcpTransport* tcp, const uint8_t* data, size_t len, const char* recipient, int timeout_ms) {
+    return dcf_tcp_send_frames(tcp, &data, &len, 1, recipient, timeout_ms);
+}
+
+DCFError dcf_tcp_transport_send_batch(DCFTcpTransport* tcp, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient) {
+    return dcf_tcp_send_frames(tcp, data, lens, count, recipient, 0);
+}
+
+static DCFError dcf_tcp_receive(DCFTcpTransport* tcp, int timeout_ms, const uint8_t** frame_out, size_t* len_out) {
+    if (!tcp || !frame_out || !len_out) return DCF_ERR_NULL_PTR;
+    if (tcp->listen_fd < 0) return DCF_ERR_INVALID_STATE;
+    struct epoll_event events[DCF_TCP_EPOLL_EVENTS];
+    pthread_mutex_lock(&tcp->mutex);
+    while (true) {
+        while (tcp->ready_pos < tcp->ready_count) {
+            DCFTcpConn* conn = tcp->ready[tcp->ready_pos];
+            if (dcf_tcp_next_frame(tcp, conn, frame_out, len_out)) {
+                pthread_mutex_unlock(&tcp->mutex);
+                return DCF_SUCCESS;
+            }
+            conn->ready = false;
+            tcp->ready_pos++;
+            if (dcf_tcp_conn_reapable(tcp, conn)) dcf_tcp_conn_remove(tcp, conn);
+        }
+        tcp->ready_pos = tcp->ready_count = 0;
+        // Connections a sender was still writing to when they closed
+        for (size_t i = tcp->conn_count; i-- > 0;) {
+            if (dcf_tcp_conn_reapable(tcp, tcp->conns[i])) dcf_tcp_conn_remove(tcp, tcp->conns[i]);
+        }
+        tcp->in_wait = true;
+        pthread_mutex_unlock(&tcp->mutex);
+        int n = epoll_wait(tcp->epoll_fd, events, DCF_TCP_EPOLL_EVENTS, timeout_ms);
+        pthread_mutex_lock(&tcp->mutex);
+        if (n <= 0) {
+            tcp->in_wait = false;
+            if (n < 0 && errno == EINTR) continue;
+            pthread_mutex_unlock(&tcp->mutex);
+            return n == 0 ? DCF_ERR_TIMEOUT : DCF_ERR_NETWORK_FAIL;
+        }
+        for (int i = 0; i < n; i++) {
+            DCFTcpConn* conn = events[i].data.ptr;
+            if (!conn) {
+                int fd = accept4(tcp->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+                if (fd < 0) continue;
+                dcf_tcp_tune_socket(tcp, fd);
+                if (!dcf_tcp_conn_add(tcp, fd, NULL)) close(fd);
+                continue;
+            }
+            if (conn->closed) continue;
+            dcf_tcp_fill(tcp, conn);
+            if (!conn->ready) {
+                conn->ready = true;
+                tcp->ready[tcp->ready_count++] = conn;
+            }
+        }
+        tcp->in_wait = false;
+    }
+}
+
+DCFError dcf_tcp_transport_receive(DCFTcpTransport* tcp, const uint8_t** frame_out, size_t* len_out) {
+    return dcf_tcp_receive(tcp, -1, frame_out, len_out);
+}
+
+DCFError dcf_tcp_transport_try_receive(DCFTcpTransport* tcp, const uint8_t** frame_out, size_t* len_out) {
+    return dcf_tcp_receive(tcp, 0, frame_out, len_out);
+}
+
+int dcf_tcp_transport_get_fd(DCFTcpTransport* tcp) {
+    if (!tcp) return -1;
+    return tcp->epoll_fd;
+}
+
+void dcf_tcp_transport_free(DCFTcpTransport* tcp) {
+    if (!tcp) return;
+    while (tcp->conn_count > 0) dcf_tcp_conn_remove(tcp, tcp->conns[tcp->conn_count - 1]);
+    free(tcp->conns);
+    free(tcp->ready);
+    if (tcp->listen_fd >= 0) close(tcp->listen_fd);
+    if (tcp->epoll_fd >= 0) close(tcp->epoll_fd);
+    pthread_mutex_destroy(&tcp->mutex);
+    free(tcp);
+}
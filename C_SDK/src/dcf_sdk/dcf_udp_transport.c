@@ -0,0 +1,233 @@
+#define _GNU_SOURCE
+#include "dcf_udp_transport.h"
+#include "dcf_address.h"
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define DCF_UDP_ADDR_CACHE 64
+#define DCF_UDP_ADDR_MAX 128
+
+typedef struct {
+    char key[DCF_UDP_ADDR_MAX];
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    bool valid;
+} DCFUdpAddr;
+
+struct DCFUdpTransport {
+    int fd;
+    int family;
+    uint8_t* rx_buffers;
+    struct mmsghdr rx_msgs[DCF_UDP_BATCH];
+    struct iovec rx_iov[DCF_UDP_BATCH];
+    size_t rx_count;
+    size_t rx_next;
+    pthread_mutex_t addr_mutex;  // senders on several threads share addr_cache
+    DCFUdpAddr addr_cache[DCF_UDP_ADDR_CACHE];
+    DCFIoBackend* io;  // NULL uses sendmmsg/recvmmsg directly
+};
+
+// Copies the recipient's address into dest; the cache slot may be replaced
+// by another sender as soon as the lock is dropped
+static bool dcf_udp_resolve(DCFUdpTransport* udp, const char* recipient, DCFUdpAddr* dest) {
+    size_t key_len = strlen(recipient);
+    if (key_len >= DCF_UDP_ADDR_MAX) return false;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < key_len; i++) hash = (hash ^ (uint8_t)recipient[i]) * 16777619u;
+    DCFUdpAddr* slot = &udp->addr_cache[hash % DCF_UDP_ADDR_CACHE];
+    pthread_mutex_lock(&udp->addr_mutex);
+    bool hit = slot->valid && strcmp(slot->key, recipient) == 0;
+    if (hit) *dest = *slot;
+    pthread_mutex_unlock(&udp->addr_mutex);
+    if (hit) return true;
+    // Resolve outside the lock so a slow lookup does not stall other senders
+    struct addrinfo* res;
+    if (!dcf_address_resolve(recipient, udp->family, SOCK_DGRAM, &res)) return false;
+    memcpy(&dest->addr, res->ai_addr, res->ai_addrlen);
+    dest->addr_len = res->ai_addrlen;
+    memcpy(dest->key, recipient, key_len + 1);
+    dest->valid = true;
+    freeaddrinfo(res);
+    pthread_mutex_lock(&udp->addr_mutex);
+    *slot = *dest;
+    pthread_mutex_unlock(&udp->addr_mutex);
+    return true;
+}
+
+DCFUdpTransport* dcf_udp_transport_new(void) {
+    DCFUdpTransport* udp = calloc(1, sizeof(DCFUdpTransport));
+    if (!udp) return NULL;
+    udp->fd = -1;
+    pthread_mutex_init(&udp->addr_mutex, NULL);
+    return udp;
+}
+
+DCFError dcf_udp_transport_initialize(DCFUdpTransport* udp, const char* host, int port, int rcvbuf, int sndbuf) {
+    if (!udp || !host) return DCF_ERR_NULL_PTR;
+    if (udp->fd >= 0) return DCF_ERR_INVALID_STATE;
+    char port_str[16];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    struct addrinfo hints = {0}, *res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return DCF_ERR_NETWORK_FAIL;
+    udp->fd = socket(res->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (udp->fd < 0) { freeaddrinfo(res); return DCF_ERR_NETWORK_FAIL; }
+    udp->family = res->ai_family;
+    if (rcvbuf > 0) setsockopt(udp->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (sndbuf > 0) setsockopt(udp->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    if (bind(udp->fd, res->ai_addr, res->ai_addrlen) != 0) {
+        freeaddrinfo(res);
+        close(udp->fd);
+        udp->fd = -1;
+        return DCF_ERR_NETWORK_FAIL;
+    }
+    freeaddrinfo(res);
+    udp->rx_buffers = malloc((size_t)DCF_UDP_BATCH * DCF_UDP_MAX_DATAGRAM);
+    if (!udp->rx_buffers) {
+        close(udp->fd);
+        udp->fd = -1;
+        return DCF_ERR_MALLOC_FAIL;
+    }
+    for (size_t i = 0; i < DCF_UDP_BATCH; i++) {
+        udp->rx_iov[i].iov_base = udp->rx_buffers + i * DCF_UDP_MAX_DATAGRAM;
+        udp->rx_iov[i].iov_len = DCF_UDP_MAX_DATAGRAM;
+    }
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_udp_transport_set_io_backend(DCFUdpTransport* udp, DCFIoBackendType type) {
+    if (!udp) return DCF_ERR_NULL_PTR;
+    if (udp->fd < 0 || udp->io) return DCF_ERR_INVALID_STATE;
+    DCFIoBackend* io = dcf_io_backend_new(type);
+    if (!io) return DCF_ERR_MALLOC_FAIL;
+    DCFError err = dcf_io_backend_watch(io, udp->fd);
+    if (err != DCF_SUCCESS) {
+        dcf_io_backend_free(io);
+        return err;
+    }
+    udp->io = io;
+    return DCF_SUCCESS;
+}
+
+DCFIoBackendType dcf_udp_transport_get_io_backend(DCFUdpTransport* udp) {
+    if (!udp || !udp->io) return DCF_IO_BACKEND_EPOLL;
+    return dcf_io_backend_get_type(udp->io);
+}
+
+DCFError dcf_udp_transport_send(DCFUdpTransport* udp, const uint8_t* data, size_t len, const char* recipient) {
+    size_t sent;
+    DCFError err = dcf_udp_transport_send_batch(udp, &data, &len, 1, recipient, NULL, &sent);
+    if (err != DCF_SUCCESS) return err;
+    return sent == 1 ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+}
+
+DCFError dcf_udp_transport_send_batch(DCFUdpTransport* udp, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, DCFError* results_out, size_t* sent_out) {
+    if (!udp || !data || !lens || !recipient || !sent_out) return DCF_ERR_NULL_PTR;
+    *sent_out = 0;
+    if (results_out) for (size_t i = 0; i < count; i++) results_out[i] = DCF_ERR_NETWORK_FAIL;
+    if (udp->fd < 0) return DCF_ERR_INVALID_STATE;
+    DCFUdpAddr dest;
+    if (!dcf_udp_resolve(udp, recipient, &dest)) return DCF_ERR_INVALID_ARG;
+    struct mmsghdr msgs[DCF_UDP_BATCH];
+    struct iovec iov[DCF_UDP_BATCH];
+    // Every message up to done has been tried; on io_uring some may have failed
+    for (size_t done = 0; done < count;) {
+        size_t chunk = count - done;
+        if (chunk > DCF_UDP_BATCH) chunk = DCF_UDP_BATCH;
+        memset(msgs, 0, chunk * sizeof(struct mmsghdr));
+        for (size_t i = 0; i < chunk; i++) {
+            size_t idx = done + i;
+            if (lens[idx] > DCF_UDP_MAX_DATAGRAM) {
+                if (results_out) results_out[idx] = DCF_ERR_INVALID_ARG;
+                return DCF_ERR_INVALID_ARG;
+            }
+            iov[i].iov_base = (void*)data[idx];
+            iov[i].iov_len = lens[idx];
+            msgs[i].msg_hdr.msg_name = &dest.addr;
+            msgs[i].msg_hdr.msg_namelen = dest.addr_len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        if (udp->io) {
+            struct msghdr hdrs[DCF_UDP_BATCH];
+            for (size_t i = 0; i < chunk; i++) hdrs[i] = msgs[i].msg_hdr;
+            size_t sent = 0;
+            DCFError err = dcf_io_backend_send_batch(udp->io, udp->fd, hdrs, chunk, results_out ? results_out + done : NULL, &sent);
+            *sent_out += sent;
+            // io_uring tried the whole chunk, whatever failed; sendmmsg stopped at the first failure
+            if (err != DCF_SUCCESS && dcf_io_backend_get_type(udp->io) != DCF_IO_BACKEND_IO_URING) return err;
+            done += chunk;
+            continue;
+        }
+        int n = sendmmsg(udp->fd, msgs, chunk, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return DCF_ERR_NETWORK_FAIL;
+        }
+        if (results_out) for (int i = 0; i < n; i++) results_out[done + i] = DCF_SUCCESS;
+        *sent_out += n;
+        done += n;
+    }
+    return *sent_out == count ? DCF_SUCCESS : DCF_ERR_NETWORK_FAIL;
+}
+
+static DCFError dcf_udp_receive(DCFUdpTransport* udp, bool block, const uint8_t** data_out, size_t* len_out) {
+    if (!udp || !data_out || !len_out) return DCF_ERR_NULL_PTR;
+    if (udp->fd < 0) return DCF_ERR_INVALID_STATE;
+    if (udp->io) {
+        int fd;
+        return dcf_io_backend_receive(udp->io, block ? -1 : 0, &fd, data_out, len_out);
+    }
+    while (udp->rx_next >= udp->rx_count) {
+        memset(udp->rx_msgs, 0, sizeof(udp->rx_msgs));
+        for (size_t i = 0; i < DCF_UDP_BATCH; i++) {
+            udp->rx_msgs[i].msg_hdr.msg_iov = &udp->rx_iov[i];
+            udp->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        // Block for the first datagram, then take whatever else is already queued
+        int n = recvmmsg(udp->fd, udp->rx_msgs, DCF_UDP_BATCH, block ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return DCF_ERR_TIMEOUT;
+            return DCF_ERR_NETWORK_FAIL;
+        }
+        udp->rx_count = n;
+        udp->rx_next = 0;
+    }
+    size_t idx = udp->rx_next++;
+    *data_out = udp->rx_iov[idx].iov_base;
+    *len_out = udp->rx_msgs[idx].msg_len;
+    return DCF_SUCCESS;
+}
+
+DCFError dcf_udp_transport_receive(DCFUdpTransport* udp, const uint8_t** data_out, size_t* len_out) {
+    return dcf_udp_receive(udp, true, data_out, len_out);
+}
+
+DCFError dcf_udp_transport_try_receive(DCFUdpTransport* udp, const uint8_t** data_out, size_t* len_out) {
+    return dcf_udp_receive(udp, false, data_out, len_out);
+}
+
+int dcf_udp_transport_get_fd(DCFUdpTransport* udp) {
+    if (!udp) return -1;
+    if (udp->io) return dcf_io_backend_get_fd(udp->io);
+    return udp->fd;
+}
+
+void dcf_udp_transport_free(DCFUdpTransport* udp) {
+    if (!udp) return;
+    dcf_io_backend_free(udp->io);
+    if (udp->fd >= 0) close(udp->fd);
+    free(udp->rx_buffers);
+    pthread_mutex_destroy(&udp->addr_mutex);
+    free(udp);
+}
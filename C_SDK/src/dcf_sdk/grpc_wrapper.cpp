@@ -1,65 +1,603 @@
 #include <grpcpp/grpcpp.h>
+#include <grpcpp/alarm.h>
+#include <grpcpp/generic/generic_stub.h>
 #include "messages.grpc.pb.h"
 #include "services.grpc.pb.h"
+#include "grpc_wrapper.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
 #include <string>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+extern "C" {
+#include "dcf_message_view.h"
+#include "dcf_serialization.h"
+}
+
+// Messages travel as the DCFMessage the C layer already packed: clients send
+// those bytes through a generic stub and the server takes them as a raw
+// ByteBuffer, so nothing is encoded twice or wrapped in a second DCFMessage.
+static const char kSendMessageMethod[] = "/DCFService/SendMessage";
+// The long-lived stream carries packed DCFMessages as raw ByteBuffers the same way
+static const char kMessageStreamMethod[] = "/DCFService/MessageStream";
+
+// Hands packed to gRPC without copying it; the slice frees it once written
+static grpc::ByteBuffer PackedBuffer(std::string packed) {
+    std::string* owned = new std::string(std::move(packed));
+    grpc::Slice slice(&(*owned)[0], owned->size(), [](void* p) { delete static_cast<std::string*>(p); }, owned);
+    return grpc::ByteBuffer(&slice, 1);
+}
+
+static void FlattenBuffer(const grpc::ByteBuffer& buffer, std::string* out) {
+    std::vector<grpc::Slice> slices;
+    out->clear();
+    if (!buffer.Dump(&slices).ok()) return;
+    for (const grpc::Slice& slice : slices) out->append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+}
+
+// Per-peer channels keyed by "host:port". Channels are created on first use,
+// each peer gets channels_per_peer of them (each with its own subchannel pool,
+// so they map to separate HTTP/2 connections) and the least recently used
+// peers are dropped once more than max_peers are held. In-flight calls keep
+// their stub alive, so eviction never tears down an outstanding RPC.
+class ChannelPool {
+public:
+    ChannelPool() : channels_per_peer_(1), max_peers_(256) {}
+
+    void Configure(size_t channels_per_peer, size_t max_peers) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channels_per_peer_ = std::max<size_t>(channels_per_peer, 1);
+        max_peers_ = std::max<size_t>(max_peers, 1);
+        EvictLocked();
+    }
+
+    std::shared_ptr<grpc::GenericStub> Acquire(const std::string& address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = TouchLocked(address);
+        std::shared_ptr<grpc::GenericStub> stub = entry.stubs[entry.next];
+        entry.next = (entry.next + 1) % entry.stubs.size();
+        return stub;
+    }
+
+    void WarmUp(const std::string& address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = TouchLocked(address);
+        // GetState(true) starts connecting without blocking the caller
+        for (auto& channel : entry.channels) channel->GetState(true);
+    }
+
+private:
+    struct Entry {
+        std::vector<std::shared_ptr<grpc::Channel>> channels;
+        std::vector<std::shared_ptr<grpc::GenericStub>> stubs;
+        size_t next;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    Entry& TouchLocked(const std::string& address) {
+        auto it = entries_.find(address);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+            return it->second;
+        }
+        Entry& entry = entries_[address];
+        entry.next = 0;
+        for (size_t i = 0; i < channels_per_peer_; i++) {
+            grpc::ChannelArguments args;
+            args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+            args.SetInt("dcf.channel_index", (int)i);
+            std::shared_ptr<grpc::Channel> channel = grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args);
+            entry.stubs.push_back(std::make_shared<grpc::GenericStub>(channel));
+            entry.channels.push_back(std::move(channel));
+        }
+        lru_.push_front(address);
+        entry.lru_pos = lru_.begin();
+        EvictLocked();
+        return entry;
+    }
+
+    void EvictLocked() {
+        // The entry just touched sits at the front, so it is never the one evicted
+        while (entries_.size() > max_peers_) {
+            entries_.erase(lru_.back());
+            lru_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    size_t channels_per_peer_;
+    size_t max_peers_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;
+};
 
 class GrpcWrapper {
 public:
-    GrpcWrapper(const std::string& host, int port) : server_running_(false) {
-        channel_ = grpc::CreateChannel(host + ":" + std::to_string(port), grpc::InsecureChannelCredentials());
-        stub_ = DCFService::NewStub(channel_);
+    GrpcWrapper(const std::string& host, int port)
+        : address_(host + ":" + std::to_string(port)), server_threads_(0), server_running_(false), inflight_(0), stream_running_(false) {
+        service_.owner_ = this;
+        channel_ = grpc::CreateChannel(address_, grpc::InsecureChannelCredentials());
+        generic_stub_ = std::make_shared<grpc::GenericStub>(channel_);
+        ack_ = PackAck(nullptr, 0);
+        probe_ack_ = ack_;
+        recv_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        poller_ = std::thread(&GrpcWrapper::PollCompletions, this);
     }
 
+    ~GrpcWrapper() {
+        if (server_running_) StopServer();
+        if (stream_running_) StopStream();
+        // Shutdown drains every pending tag through the poller, so outstanding callbacks still fire
+        cq_.Shutdown();
+        poller_.join();
+        if (recv_event_fd_ >= 0) close(recv_event_fd_);
+    }
+
+    void ConfigureServer(size_t threads) {
+        server_threads_ = threads;
+    }
+
+    // Serves SendMessage on the async API with one completion queue and
+    // handler thread per core (or server_threads when configured), listening
+    // on the configured host:port.
     bool StartServer() {
         if (server_running_) return false;
+        size_t threads = server_threads_ ? server_threads_ : std::max(1u, std::thread::hardware_concurrency());
         grpc::ServerBuilder builder;
-        builder.AddListeningPort("0.0.0.0:50051", grpc::InsecureServerCredentials());
+        builder.AddListeningPort(address_, grpc::InsecureServerCredentials());
         builder.RegisterService(&service_);
+        for (size_t i = 0; i < threads; i++) server_cqs_.push_back(builder.AddCompletionQueue());
         server_ = builder.BuildAndStart();
-        if (!server_) return false;
-        server_running_ = true;
+        if (!server_) {
+            server_cqs_.clear();
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(recv_mutex_);
+            server_running_ = true;
+        }
+        for (auto& cq : server_cqs_) {
+            grpc::ServerCompletionQueue* queue = cq.get();
+            for (size_t i = 0; i < kPendingCallsPerQueue; i++) new SendMessageCall(this, queue);
+            new MessageStreamCall(this, queue);
+            server_handlers_.emplace_back([queue] {
+                void* tag;
+                bool ok;
+                while (queue->Next(&tag, &ok)) static_cast<ServerTag*>(tag)->Proceed(ok);
+            });
+        }
         return true;
     }
 
     bool StopServer() {
         if (!server_running_) return false;
+        // Open streams never end on their own, so they are closed for Shutdown to finish
+        CloseStreams();
         server_->Shutdown();
-        server_running_ = false;
+        for (auto& cq : server_cqs_) cq->Shutdown();
+        for (auto& handler : server_handlers_) handler.join();
+        server_handlers_.clear();
+        server_cqs_.clear();
+        {
+            std::lock_guard<std::mutex> lock(recv_mutex_);
+            server_running_ = false;
+            SignalLocked();
+        }
+        recv_not_empty_.notify_all();
         return true;
     }
 
-    bool Send(const uint8_t* data, size_t len, const std::string& recipient, std::string* response) {
-        DCFMessage request;
-        request.set_data(std::string((char*)data, len));
-        request.set_recipient(recipient);
-        grpc::ClientContext context;
-        DCFMessage reply;
-        grpc::Status status = stub_->SendMessage(&context, request, &reply);
-        if (!status.ok()) return false;
-        *response = reply.data();
+    // Blocks until the recipient acknowledges the message, at most timeout_ms
+    // when it is positive, and hands back the packed reply when reply is set
+    bool Send(const uint8_t* data, size_t len, const std::string& recipient, int timeout_ms, std::string* reply) {
+        struct SendState {
+            std::mutex mutex;
+            std::condition_variable done;
+            bool finished;
+            bool ok;
+            std::string* reply;
+        };
+        SendState state;
+        state.finished = false;
+        state.ok = false;
+        state.reply = reply;
+        grpc_wrapper_send_cb complete = [](void* user_data, bool ok, const uint8_t* response, size_t response_len) {
+            SendState* state = static_cast<SendState*>(user_data);
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->ok = ok;
+            if (ok && state->reply) state->reply->assign(reinterpret_cast<const char*>(response), response_len);
+            state->finished = true;
+            state->done.notify_one();
+        };
+        SendAsync(data, len, recipient, timeout_ms, complete, &state, true);
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.done.wait(lock, [&state] { return state.finished; });
+        return state.ok;
+    }
+
+    // Once kMaxInflight calls are outstanding, waits for one to complete when
+    // wait is set and otherwise returns false without sending or calling cb
+    bool SendAsync(const uint8_t* data, size_t len, const std::string& recipient, int timeout_ms, grpc_wrapper_send_cb cb, void* user_data, bool wait) {
+        {
+            std::unique_lock<std::mutex> lock(inflight_mutex_);
+            if (!wait && inflight_ >= kMaxInflight) return false;
+            inflight_cv_.wait(lock, [this] { return inflight_ < kMaxInflight; });
+            inflight_++;
+        }
+        AsyncSendCall* call = new AsyncSendCall();
+        call->stub = StubFor(recipient);
+        call->cb = cb;
+        call->user_data = user_data;
+        // The one copy: the caller's buffer may be gone before the call is written
+        grpc::Slice slice(data, len);
+        grpc::ByteBuffer request(&slice, 1);
+        if (timeout_ms > 0) {
+            call->context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(timeout_ms));
+        }
+        call->reader = call->stub->PrepareUnaryCall(&call->context, kSendMessageMethod, request, &cq_);
+        call->reader->StartCall();
+        call->reader->Finish(&call->reply, &call->status, call);
         return true;
     }
 
-    bool Receive(uint8_t** data_out, size_t* len_out, std::string* sender_out) {
-        grpc::ClientContext context;
-        std::unique_ptr<grpc::ClientReader<DCFMessage>> reader = stub_->ReceiveStream(&context);
-        DCFMessage reply;
-        if (!reader->Read(&reply)) return false;
-        *len_out = reply.data().size();
-        *data_out = (uint8_t*)calloc(1, *len_out + 1);
-        if (!*data_out) return false;
-        memcpy(*data_out, reply.data().c_str(), *len_out);
-        *sender_out = reply.sender();
+    // Pipelines every message as a SendMessage call on the recipient's channel,
+    // so HTTP/2 coalesces them into shared writes, and waits for all of them.
+    void SendBatch(const uint8_t* const* data, const size_t* lens, size_t count, const std::string& recipient, bool* ok_out) {
+        struct BatchState {
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t remaining;
+            bool* ok;
+        };
+        struct BatchSlot {
+            BatchState* state;
+            size_t index;
+        };
+        BatchState state;
+        state.remaining = count;
+        state.ok = ok_out;
+        std::vector<BatchSlot> slots(count);
+        grpc_wrapper_send_cb complete = [](void* user_data, bool ok, const uint8_t*, size_t) {
+            BatchSlot* slot = static_cast<BatchSlot*>(user_data);
+            std::lock_guard<std::mutex> lock(slot->state->mutex);
+            slot->state->ok[slot->index] = ok;
+            if (--slot->state->remaining == 0) slot->state->done.notify_one();
+        };
+        for (size_t i = 0; i < count; i++) {
+            slots[i] = BatchSlot{&state, i};
+            SendAsync(data[i], lens[i], recipient, 0, complete, &slots[i], true);
+        }
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.done.wait(lock, [&state] { return state.remaining == 0; });
+    }
+
+    // Rebuilds the shared health probe ack; calls already replying keep the buffer they copied
+    void SetAckData(const uint8_t* data, size_t len) {
+        grpc::ByteBuffer buffer = PackAck(data, len);
+        std::lock_guard<std::mutex> lock(ack_mutex_);
+        probe_ack_ = buffer;
+    }
+
+    grpc::ByteBuffer ProbeAck() {
+        std::lock_guard<std::mutex> lock(ack_mutex_);
+        return probe_ack_;
+    }
+
+    void ConfigurePool(size_t channels_per_peer, size_t max_peers) {
+        pool_.Configure(channels_per_peer, max_peers);
+    }
+
+    bool WarmUp(const std::string& peer) {
+        if (!IsPeerAddress(peer)) return false;
+        pool_.WarmUp(peer);
+        return true;
+    }
+
+    // Opens the MessageStream under node_id, which the server routes messages for this node to
+    bool StartStream(const std::string& node_id) {
+        {
+            std::lock_guard<std::mutex> lock(recv_mutex_);
+            if (stream_running_) return false;
+            stream_running_ = true;
+            stream_node_id_ = node_id;
+        }
+        stream_reader_ = std::thread(&GrpcWrapper::ReadStream, this);
+        return true;
+    }
+
+    bool StopStream() {
+        {
+            std::lock_guard<std::mutex> lock(recv_mutex_);
+            if (!stream_running_) return false;
+            stream_running_ = false;
+            if (stream_context_) stream_context_->TryCancel();
+            SignalLocked();
+        }
+        recv_not_full_.notify_all();
+        recv_not_empty_.notify_all();
+        stream_reader_.join();
         return true;
     }
 
+    // Returns 1 with a message, 0 when block is false and the queue is empty,
+    // -1 once the queue is drained and neither the stream nor the server runs.
+    int Receive(bool block, uint8_t** data_out, size_t* len_out) {
+        std::unique_lock<std::mutex> lock(recv_mutex_);
+        if (block) recv_not_empty_.wait(lock, [this] { return !recv_queue_.empty() || !(stream_running_ || server_running_); });
+        if (recv_queue_.empty()) {
+            if (!(stream_running_ || server_running_)) return -1;
+            // Nothing queued: clear the eventfd so it only turns readable on the next push
+            uint64_t count;
+            if (recv_event_fd_ >= 0) while (read(recv_event_fd_, &count, sizeof(count)) > 0) {}
+            return 0;
+        }
+        std::string packed = std::move(recv_queue_.front());
+        recv_queue_.pop_front();
+        lock.unlock();
+        recv_not_full_.notify_one();
+        *len_out = packed.size();
+        *data_out = (uint8_t*)malloc(*len_out ? *len_out : 1);
+        if (!*data_out) return -1;
+        memcpy(*data_out, packed.data(), *len_out);
+        return 1;
+    }
+
+    int GetFd() const {
+        return recv_event_fd_;
+    }
+
 private:
-    class DCFServiceImpl : public DCFService::Service {
-        grpc::Status SendMessage(grpc::ServerContext* context, const DCFMessage* request, DCFMessage* response) override {
-            response->set_data("Echo: " + request->data());
-            response->set_sender("server");
-            return grpc::Status::OK;
+    // Upper bound on RPCs in flight, past which SendAsync reports busy or waits
+    static constexpr size_t kMaxInflight = 1024;
+    // Inbound messages buffered between the stream reader or server handlers and Receive
+    static constexpr size_t kRecvQueueCapacity = 4096;
+    // SendMessage requests kept posted on each server completion queue
+    static constexpr size_t kPendingCallsPerQueue = 16;
+    static constexpr int kStreamBackoffMinMs = 100;
+    static constexpr int kStreamBackoffMaxMs = 5000;
+    // Messages buffered for one open MessageStream before SendMessage to it is refused
+    static constexpr size_t kStreamQueueCapacity = 1024;
+
+    static grpc::ByteBuffer PackAck(const uint8_t* data, size_t len) {
+        DCFMessage ack;
+        ack.set_sender("server");
+        if (len) ack.set_data(std::string(reinterpret_cast<const char*>(data), len));
+        std::string packed = ack.SerializeAsString();
+        grpc::Slice slice(packed);
+        return grpc::ByteBuffer(&slice, 1);
+    }
+
+    static bool IsHealthProbe(const std::string& packed) {
+        DCFMessageView view;
+        return dcf_message_view_parse(reinterpret_cast<const uint8_t*>(packed.data()), packed.size(), DCF_VIEW_GROUP_ID, &view) == DCF_SUCCESS &&
+               dcf_slice_equals(view.group_id, DCF_GROUP_HEALTH);
+    }
+
+    // Wakes pollers of the eventfd; the caller holds recv_mutex_
+    void SignalLocked() {
+        uint64_t one = 1;
+        if (recv_event_fd_ >= 0 && write(recv_event_fd_, &one, sizeof(one)) < 0) {}
+    }
+
+    // Recipients given as "host:port" get their own pooled channels; anything
+    // else (e.g. a node UUID) is relayed through the configured endpoint.
+    static bool IsPeerAddress(const std::string& recipient) {
+        return recipient.find(':') != std::string::npos;
+    }
+
+    std::shared_ptr<grpc::GenericStub> StubFor(const std::string& recipient) {
+        if (IsPeerAddress(recipient)) return pool_.Acquire(recipient);
+        return generic_stub_;
+    }
+
+    struct AsyncSendCall {
+        std::shared_ptr<grpc::GenericStub> stub;
+        grpc::ClientContext context;
+        grpc::ByteBuffer reply;
+        grpc::Status status;
+        std::unique_ptr<grpc::ClientAsyncResponseReader<grpc::ByteBuffer>> reader;
+        grpc_wrapper_send_cb cb;
+        void* user_data;
+    };
+
+    void PollCompletions() {
+        void* tag;
+        bool ok;
+        while (cq_.Next(&tag, &ok)) {
+            AsyncSendCall* call = static_cast<AsyncSendCall*>(tag);
+            bool success = ok && call->status.ok();
+            if (call->cb) {
+                std::string reply;
+                if (success) FlattenBuffer(call->reply, &reply);
+                call->cb(call->user_data, success, success ? (const uint8_t*)reply.data() : nullptr, reply.size());
+            }
+            delete call;
+            {
+                std::lock_guard<std::mutex> lock(inflight_mutex_);
+                inflight_--;
+            }
+            inflight_cv_.notify_one();
+        }
+    }
+
+    // Waits for the one operation outstanding on a client stream's own queue
+    static bool Await(grpc::CompletionQueue* cq) {
+        void* tag;
+        bool ok;
+        return cq->Next(&tag, &ok) && ok;
+    }
+
+    // Keeps one MessageStream open for the wrapper's lifetime, reopening it with
+    // backoff if the peer drops it, and feeds inbound messages to recv_queue_.
+    // Messages arrive as packed bytes and are queued without being decoded.
+    void ReadStream() {
+        int backoff_ms = kStreamBackoffMinMs;
+        while (true) {
+            grpc::CompletionQueue cq;
+            std::unique_ptr<grpc::GenericClientAsyncReaderWriter> stream;
+            {
+                std::lock_guard<std::mutex> lock(recv_mutex_);
+                if (!stream_running_) break;
+                stream_context_.reset(new grpc::ClientContext());
+                stream = generic_stub_->PrepareCall(stream_context_.get(), kMessageStreamMethod, &cq);
+            }
+            stream->StartCall(nullptr);
+            bool open = Await(&cq);
+            // The first message names this node; the server then forwards whatever is sent to it.
+            // A stream that won't take it is finished and reopened after the backoff.
+            if (open) {
+                DCFMessage hello;
+                hello.set_sender(stream_node_id_);
+                stream->Write(PackedBuffer(hello.SerializeAsString()), nullptr);
+                open = Await(&cq);
+            }
+            grpc::ByteBuffer buffer;
+            while (open) {
+                stream->Read(&buffer, nullptr);
+                if (!Await(&cq)) break;
+                backoff_ms = kStreamBackoffMinMs;
+                std::string packed;
+                FlattenBuffer(buffer, &packed);
+                std::unique_lock<std::mutex> lock(recv_mutex_);
+                // Waiting here stops reading, which lets HTTP/2 flow control push back on the sender
+                recv_not_full_.wait(lock, [this] { return recv_queue_.size() < kRecvQueueCapacity || !stream_running_; });
+                if (!stream_running_) break;
+                recv_queue_.push_back(std::move(packed));
+                SignalLocked();
+                lock.unlock();
+                recv_not_empty_.notify_one();
+            }
+            if (open) {
+                stream->WritesDone(nullptr);
+                Await(&cq);
+            }
+            grpc::Status status;
+            stream->Finish(&status, nullptr);
+            Await(&cq);
+            stream.reset();
+            cq.Shutdown();
+            void* tag;
+            bool ok;
+            while (cq.Next(&tag, &ok)) {}
+            std::unique_lock<std::mutex> lock(recv_mutex_);
+            if (!stream_running_) break;
+            recv_not_full_.wait_for(lock, std::chrono::milliseconds(backoff_ms), [this] { return !stream_running_; });
+            backoff_ms = std::min(backoff_ms * 2, kStreamBackoffMaxMs);
+        }
+        std::lock_guard<std::mutex> lock(recv_mutex_);
+        stream_context_.reset();
+    }
+
+    class MessageStreamCall;
+
+    // Outbound side of one client's MessageStream, fed by DeliverPacked
+    struct OpenStream {
+        std::mutex mutex;
+        std::deque<std::string> queue;  // packed DCFMessages
+        bool closed = false;
+        bool busy = false;  // a write or wake-up of the call is outstanding
+        MessageStreamCall* call = nullptr;
+    };
+
+    // Queues a packed message received by the server, or hands it to the open
+    // MessageStream of its next hop: the head of its redundancy_path when it has
+    // one, else its recipient. Never blocks a handler thread.
+    bool DeliverPacked(std::string packed) {
+        std::shared_ptr<OpenStream> open;
+        // Parsed in place before streams_mutex_ is taken, so the lock covers only the lookup
+        DCFMessageView view;
+        if (dcf_message_view_parse(reinterpret_cast<const uint8_t*>(packed.data()), packed.size(), DCF_VIEW_RECIPIENT | DCF_VIEW_REDUNDANCY_PATH, &view) == DCF_SUCCESS) {
+            DCFSlice hop = view.redundancy_path.len ? view.redundancy_path : view.recipient;
+            const void* comma = view.redundancy_path.len ? memchr(hop.data, ',', hop.len) : nullptr;
+            if (comma) hop.len = static_cast<const uint8_t*>(comma) - hop.data;
+            std::string node_id(reinterpret_cast<const char*>(hop.data), hop.len);
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            auto it = streams_.find(node_id);
+            if (it != streams_.end()) open = it->second;
+        }
+        if (open) {
+            std::lock_guard<std::mutex> lock(open->mutex);
+            if (open->closed || open->queue.size() >= kStreamQueueCapacity) return false;
+            open->queue.push_back(std::move(packed));
+            WakeLocked(*open);
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(recv_mutex_);
+            if (recv_queue_.size() >= kRecvQueueCapacity) return false;
+            recv_queue_.push_back(std::move(packed));
+            SignalLocked();
         }
+        recv_not_empty_.notify_one();
+        return true;
+    }
+
+    // Registers a client's stream under its node id, replacing any older stream it left open
+    void RegisterStream(const std::string& node_id, const std::shared_ptr<OpenStream>& open) {
+        std::shared_ptr<OpenStream> replaced;
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            std::shared_ptr<OpenStream>& slot = streams_[node_id];
+            replaced = slot;
+            slot = open;
+        }
+        if (replaced) CloseStream(*replaced);
+    }
+
+    void UnregisterStream(const std::string& node_id, const std::shared_ptr<OpenStream>& open) {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto it = streams_.find(node_id);
+        if (it != streams_.end() && it->second == open) streams_.erase(it);
+    }
+
+    void CloseStreams() {
+        std::unordered_map<std::string, std::shared_ptr<OpenStream>> streams;
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            streams.swap(streams_);
+        }
+        for (auto& entry : streams) CloseStream(*entry.second);
+    }
+
+    // Closes the stream from any thread; its call finishes it on its own queue
+    static void CloseStream(OpenStream& open) {
+        std::lock_guard<std::mutex> lock(open.mutex);
+        if (open.closed) return;
+        open.closed = true;
+        WakeLocked(open);
+    }
+
+    // Has the stream's call look at its queue unless a write or wake-up already
+    // will; the caller holds the stream's mutex
+    static void WakeLocked(OpenStream& open) {
+        if (open.busy) return;
+        open.busy = true;
+        open.call->Wake();
+    }
+
+    // Tag of every operation on a server completion queue
+    class ServerTag {
+    public:
+        virtual ~ServerTag() {}
+        virtual void Proceed(bool ok) = 0;
+    };
+
+    // Streaming RPCs other than MessageStream stay on the synchronous API
+    class DCFServiceImpl : public DCFService::Service {
+    public:
+        GrpcWrapper* owner_ = nullptr;
+
+    private:
         grpc::Status ReceiveStream(grpc::ServerContext* context, const Empty* request, grpc::ServerWriter<DCFMessage>* writer) override {
             DCFMessage msg;
             msg.set_data("Streamed response");
@@ -69,11 +607,230 @@ private:
         }
     };
 
+    // One MessageStream on a server completion queue. The client's first message
+    // carries its node id in sender. Messages sent to that id are written to the
+    // stream; anything the client writes after the hello is taken in like a
+    // SendMessage. A read and a write are outstanding at once, and a message
+    // queued while no write is in flight wakes the call through an alarm, so the
+    // stream needs no thread of its own.
+    class MessageStreamCall {
+    public:
+        MessageStreamCall(GrpcWrapper* owner, grpc::ServerCompletionQueue* cq)
+            : owner_(owner), cq_(cq), stream_(&context_), pending_(1), hello_(true), finishing_(false),
+              accepted_(this, &MessageStreamCall::OnAccepted), read_(this, &MessageStreamCall::OnRead),
+              written_(this, &MessageStreamCall::OnWritten), woken_(this, &MessageStreamCall::OnWritten),
+              finished_(this, &MessageStreamCall::OnFinished), done_(this, &MessageStreamCall::OnDone) {
+            context_.AsyncNotifyWhenDone(&done_);
+            owner_->service_.RequestMessageStream(&context_, &stream_, cq_, cq_, &accepted_);
+        }
+
+        // Delivers woken_ on the call's queue; the caller holds the stream's mutex
+        // and has set busy, so one wake-up at most is outstanding
+        void Wake() {
+            pending_++;
+            alarm_.Set(cq_, gpr_now(GPR_CLOCK_MONOTONIC), &woken_);
+        }
+
+    private:
+        class Op : public ServerTag {
+        public:
+            Op(MessageStreamCall* call, void (MessageStreamCall::*handler)(bool)) : call_(call), handler_(handler) {}
+            void Proceed(bool ok) override {
+                MessageStreamCall* call = call_;
+                (call->*handler_)(ok);
+                // Every handler runs on the call's one queue, so only wake-ups race with this
+                if (--call->pending_ == 0) delete call;
+            }
+
+        private:
+            MessageStreamCall* call_;
+            void (MessageStreamCall::*handler_)(bool);
+        };
+
+        void OnAccepted(bool ok) {
+            if (!ok) return;
+            new MessageStreamCall(owner_, cq_);
+            // done_ is only delivered for calls that started
+            pending_++;
+            Read();
+        }
+
+        void Read() {
+            pending_++;
+            stream_.Read(&msg_, &read_);
+        }
+
+        void OnRead(bool ok) {
+            // The client half-closed or went away
+            if (!ok) {
+                Close();
+                return;
+            }
+            std::string packed;
+            FlattenBuffer(msg_, &packed);
+            if (!hello_) {
+                owner_->DeliverPacked(std::move(packed));
+                Read();
+                return;
+            }
+            hello_ = false;
+            DCFMessageView hello;
+            if (dcf_message_view_parse(reinterpret_cast<const uint8_t*>(packed.data()), packed.size(), DCF_VIEW_SENDER, &hello) == DCF_SUCCESS) {
+                node_id_.assign(reinterpret_cast<const char*>(hello.sender.data), hello.sender.len);
+            }
+            if (node_id_.empty()) {
+                Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "stream hello names no node"));
+                return;
+            }
+            open_ = std::make_shared<OpenStream>();
+            open_->call = this;
+            owner_->RegisterStream(node_id_, open_);
+            Read();
+        }
+
+        // Writes the next queued message, or finishes once the stream is closed;
+        // runs after each write and wake-up
+        void OnWritten(bool ok) {
+            std::unique_lock<std::mutex> lock(open_->mutex);
+            if (!ok) open_->closed = true;
+            if (open_->closed || open_->queue.empty()) {
+                open_->busy = false;
+                bool closed = open_->closed;
+                lock.unlock();
+                if (closed) Close();
+                return;
+            }
+            // Queued still packed, and written as it is
+            grpc::ByteBuffer buffer = PackedBuffer(std::move(open_->queue.front()));
+            open_->queue.pop_front();
+            lock.unlock();
+            pending_++;
+            stream_.Write(buffer, &written_);
+        }
+
+        // Unregisters the stream and finishes the call once no write is in flight;
+        // the pending read then fails
+        void Close() {
+            if (finishing_) return;
+            if (open_) {
+                std::lock_guard<std::mutex> lock(open_->mutex);
+                open_->closed = true;
+                if (open_->busy) return;
+            }
+            if (open_) owner_->UnregisterStream(node_id_, open_);
+            Finish(grpc::Status::OK);
+        }
+
+        void Finish(const grpc::Status& status) {
+            finishing_ = true;
+            pending_++;
+            stream_.Finish(status, &finished_);
+        }
+
+        void OnFinished(bool) {
+            // Fails the read that is still pending on a client that never half-closed
+            context_.TryCancel();
+        }
+
+        // The call ended, possibly cancelled by the client
+        void OnDone(bool) {
+            Close();
+        }
+
+        GrpcWrapper* owner_;
+        grpc::ServerCompletionQueue* cq_;
+        grpc::ServerContext context_;
+        grpc::ServerAsyncReaderWriter<grpc::ByteBuffer, grpc::ByteBuffer> stream_;
+        grpc::ByteBuffer msg_;
+        std::string node_id_;
+        std::shared_ptr<OpenStream> open_;
+        grpc::Alarm alarm_;
+        std::atomic<int> pending_;  // tags outstanding; the last one to come back deletes the call
+        bool hello_;
+        bool finishing_;
+        Op accepted_;
+        Op read_;
+        Op written_;
+        Op woken_;
+        Op finished_;
+        Op done_;
+    };
+
+    using AsyncServiceImpl = DCFService::WithRawMethod_SendMessage<DCFService::WithRawMethod_MessageStream<DCFServiceImpl>>;
+
+    // One outstanding SendMessage on a server completion queue. Each instance
+    // posts its successor before handling its request, so every queue always
+    // has calls waiting.
+    class SendMessageCall : public ServerTag {
+    public:
+        SendMessageCall(GrpcWrapper* owner, grpc::ServerCompletionQueue* cq)
+            : owner_(owner), cq_(cq), responder_(&context_), finished_(false) {
+            owner_->service_.RequestSendMessage(&context_, &request_, &responder_, cq_, cq_, this);
+        }
+
+        void Proceed(bool ok) override {
+            if (finished_ || !ok) {
+                delete this;
+                return;
+            }
+            new SendMessageCall(owner_, cq_);
+            finished_ = true;
+            std::string packed;
+            FlattenBuffer(request_, &packed);
+            // Health probes are answered here with the probe ack and never queued
+            if (IsHealthProbe(packed)) {
+                reply_ = owner_->ProbeAck();
+                responder_.Finish(reply_, grpc::Status::OK, this);
+                return;
+            }
+            if (!owner_->DeliverPacked(std::move(packed))) {
+                responder_.FinishWithError(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "receive queue full"), this);
+                return;
+            }
+            // The request is queued still packed; every call gets the same prebuilt ack
+            reply_ = owner_->ack_;
+            responder_.Finish(reply_, grpc::Status::OK, this);
+        }
+
+    private:
+        GrpcWrapper* owner_;
+        grpc::ServerCompletionQueue* cq_;
+        grpc::ServerContext context_;
+        grpc::ByteBuffer request_;
+        grpc::ByteBuffer reply_;
+        grpc::ServerAsyncResponseWriter<grpc::ByteBuffer> responder_;
+        bool finished_;
+    };
+
+    std::string address_;
     std::shared_ptr<grpc::Channel> channel_;
-    std::unique_ptr<DCFService::Stub> stub_;
+    std::shared_ptr<grpc::GenericStub> generic_stub_;  // also opens the MessageStream to the configured endpoint
+    std::mutex ack_mutex_;
+    grpc::ByteBuffer ack_;        // packed DCFMessage every served SendMessage replies with, set once
+    grpc::ByteBuffer probe_ack_;  // reply to health probes, carrying the ack data
+    ChannelPool pool_;
     std::unique_ptr<grpc::Server> server_;
-    DCFServiceImpl service_;
+    AsyncServiceImpl service_;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> server_cqs_;
+    std::vector<std::thread> server_handlers_;
+    size_t server_threads_;
     bool server_running_;
+    grpc::CompletionQueue cq_;
+    std::thread poller_;
+    std::mutex inflight_mutex_;
+    std::condition_variable inflight_cv_;
+    size_t inflight_;
+    std::thread stream_reader_;
+    std::unique_ptr<grpc::ClientContext> stream_context_;
+    std::string stream_node_id_;
+    std::mutex streams_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<OpenStream>> streams_;  // server side, by client node id
+    std::mutex recv_mutex_;
+    std::condition_variable recv_not_empty_;
+    std::condition_variable recv_not_full_;
+    std::deque<std::string> recv_queue_;  // packed DCFMessages
+    int recv_event_fd_;  // readable while recv_queue_ may be non-empty
+    bool stream_running_;
 };
 
 extern "C" {
@@ -88,19 +845,61 @@ bool grpc_wrapper_stop_server(void* wrapper) {
     if (!wrapper) return false;
     return static_cast<GrpcWrapper*>(wrapper)->StopServer();
 }
-bool grpc_wrapper_send(void* wrapper, const uint8_t* data, size_t len, const char* recipient, char** response_out) {
-    if (!wrapper || !data || !recipient || !response_out) return false;
-    std::string response;
-    bool success = static_cast<GrpcWrapper*>(wrapper)->Send(data, len, recipient, &response);
-    if (success) *response_out = strdup(response.c_str());
-    return success;
-}
-bool grpc_wrapper_receive(void* wrapper, uint8_t** data_out, size_t* len_out, char** sender_out) {
-    if (!wrapper || !data_out || !len_out || !sender_out) return false;
-    std::string sender;
-    bool success = static_cast<GrpcWrapper*>(wrapper)->Receive(data_out, len_out, &sender);
-    if (success) *sender_out = strdup(sender.c_str());
-    return success;
+bool grpc_wrapper_send(void* wrapper, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, uint8_t** reply_out, size_t* reply_len_out) {
+    if (!wrapper || !data || !recipient || (reply_out && !reply_len_out)) return false;
+    std::string reply;
+    if (!static_cast<GrpcWrapper*>(wrapper)->Send(data, len, recipient, timeout_ms, reply_out ? &reply : nullptr)) return false;
+    if (!reply_out) return true;
+    *reply_len_out = reply.size();
+    *reply_out = (uint8_t*)malloc(reply.size() ? reply.size() : 1);
+    if (!*reply_out) return false;
+    memcpy(*reply_out, reply.data(), reply.size());
+    return true;
+}
+int grpc_wrapper_send_async(void* wrapper, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, grpc_wrapper_send_cb cb, void* user_data) {
+    if (!wrapper || !data || !recipient) return -1;
+    return static_cast<GrpcWrapper*>(wrapper)->SendAsync(data, len, recipient, timeout_ms, cb, user_data, false) ? 1 : 0;
+}
+void grpc_wrapper_configure_server(void* wrapper, int threads) {
+    if (!wrapper || threads < 0) return;
+    static_cast<GrpcWrapper*>(wrapper)->ConfigureServer(threads);
+}
+void grpc_wrapper_set_ack_data(void* wrapper, const uint8_t* data, size_t len) {
+    if (!wrapper || (!data && len)) return;
+    static_cast<GrpcWrapper*>(wrapper)->SetAckData(data, len);
+}
+void grpc_wrapper_configure_pool(void* wrapper, int channels_per_peer, int max_peers) {
+    if (!wrapper || channels_per_peer <= 0 || max_peers <= 0) return;
+    static_cast<GrpcWrapper*>(wrapper)->ConfigurePool(channels_per_peer, max_peers);
+}
+bool grpc_wrapper_warm_up(void* wrapper, const char* peer) {
+    if (!wrapper || !peer) return false;
+    return static_cast<GrpcWrapper*>(wrapper)->WarmUp(peer);
+}
+bool grpc_wrapper_send_batch(void* wrapper, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, bool* ok_out) {
+    if (!wrapper || !data || !lens || !recipient || !ok_out) return false;
+    static_cast<GrpcWrapper*>(wrapper)->SendBatch(data, lens, count, recipient, ok_out);
+    return true;
+}
+bool grpc_wrapper_start_stream(void* wrapper, const char* node_id) {
+    if (!wrapper || !node_id) return false;
+    return static_cast<GrpcWrapper*>(wrapper)->StartStream(node_id);
+}
+bool grpc_wrapper_stop_stream(void* wrapper) {
+    if (!wrapper) return false;
+    return static_cast<GrpcWrapper*>(wrapper)->StopStream();
+}
+bool grpc_wrapper_receive(void* wrapper, uint8_t** data_out, size_t* len_out) {
+    if (!wrapper || !data_out || !len_out) return false;
+    return static_cast<GrpcWrapper*>(wrapper)->Receive(true, data_out, len_out) > 0;
+}
+int grpc_wrapper_get_fd(void* wrapper) {
+    if (!wrapper) return -1;
+    return static_cast<GrpcWrapper*>(wrapper)->GetFd();
+}
+int grpc_wrapper_try_receive(void* wrapper, uint8_t** data_out, size_t* len_out) {
+    if (!wrapper || !data_out || !len_out) return -1;
+    return static_cast<GrpcWrapper*>(wrapper)->Receive(false, data_out, len_out);
 }
 void grpc_wrapper_free(void* wrapper) {
     if (wrapper) delete static_cast<GrpcWrapper*>(wrapper);
@@ -0,0 +1,55 @@
+#ifndef GRPC_WRAPPER_H
+#define GRPC_WRAPPER_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Messages cross this API as packed DCFMessages and go on the wire as they are.
+//
+// Invoked on the wrapper's poller thread once an async send completes. The
+// response is the peer's packed DCFMessage reply, only valid for the duration
+// of the callback.
+typedef void (*grpc_wrapper_send_cb)(void* user_data, bool ok, const uint8_t* response, size_t response_len);
+
+void* grpc_wrapper_new(const char* host, int port);
+// Server handler threads, one completion queue each; 0 uses one per core
+void grpc_wrapper_configure_server(void* wrapper, int threads);
+// Data the server's ack to health probes carries from now on, e.g. this node's
+// coordinate; probes are acked without being queued for receive
+void grpc_wrapper_set_ack_data(void* wrapper, const uint8_t* data, size_t len);
+void grpc_wrapper_configure_pool(void* wrapper, int channels_per_peer, int max_peers);
+// Opens the pooled channels for a "host:port" peer ahead of its first send
+bool grpc_wrapper_warm_up(void* wrapper, const char* peer);
+bool grpc_wrapper_start_server(void* wrapper);
+bool grpc_wrapper_stop_server(void* wrapper);
+// Sends and waits for the recipient's acknowledgement, at most timeout_ms when
+// positive. With reply_out set, the packed DCFMessage reply is returned there
+// and the caller frees it.
+bool grpc_wrapper_send(void* wrapper, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, uint8_t** reply_out, size_t* reply_len_out);
+// Starts a send without waiting: 1 once started, 0 when 1024 calls are already
+// in flight, so nothing was sent and cb will not run, -1 on bad arguments.
+// grpc_wrapper_send and grpc_wrapper_send_batch wait for room instead.
+int grpc_wrapper_send_async(void* wrapper, const uint8_t* data, size_t len, const char* recipient, int timeout_ms, grpc_wrapper_send_cb cb, void* user_data);
+// Sends every message to one recipient over pipelined calls and waits for all; ok_out[i] reports message i
+bool grpc_wrapper_send_batch(void* wrapper, const uint8_t* const* data, const size_t* lens, size_t count, const char* recipient, bool* ok_out);
+// Opens the long-lived MessageStream to the configured server under node_id;
+// the server forwards every message addressed to node_id down that stream
+bool grpc_wrapper_start_stream(void* wrapper, const char* node_id);
+bool grpc_wrapper_stop_stream(void* wrapper);
+// Pops the next packed message delivered to the server or over the long-lived
+// MessageStream, blocking until one arrives. The caller frees data_out.
+bool grpc_wrapper_receive(void* wrapper, uint8_t** data_out, size_t* len_out);
+// Non-blocking receive: 1 with a message, 0 when none is queued, -1 once receiving has stopped
+int grpc_wrapper_try_receive(void* wrapper, uint8_t** data_out, size_t* len_out);
+// eventfd that turns readable once a message is queued after try_receive found none
+int grpc_wrapper_get_fd(void* wrapper);
+void grpc_wrapper_free(void* wrapper);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
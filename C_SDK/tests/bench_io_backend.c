@@ -0,0 +1,97 @@
+#define _GNU_SOURCE
+#include "dcf_io_backend.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MESSAGES 200000
+#define BENCH_BATCH 32
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_sec(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static int bind_loopback(struct sockaddr_in* addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    int buf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf));
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(*addr);
+    if (bind(fd, (struct sockaddr*)addr, len) != 0) return -1;
+    getsockname(fd, (struct sockaddr*)addr, &len);
+    return fd;
+}
+
+// Sends a batch, then drains it on the receiving socket, so loopback never drops
+static void bench(DCFIoBackendType preferred, size_t size) {
+    DCFIoBackend* backend = dcf_io_backend_new(preferred);
+    if (!backend) { printf("backend allocation failed\n"); exit(1); }
+    if (dcf_io_backend_get_type(backend) != preferred) {
+        printf("%-8s %6zu bytes: unavailable\n", dcf_io_backend_name(preferred), size);
+        dcf_io_backend_free(backend);
+        return;
+    }
+    struct sockaddr_in rx_addr, tx_addr;
+    int rx = bind_loopback(&rx_addr);
+    int tx = bind_loopback(&tx_addr);
+    if (rx < 0 || tx < 0 || dcf_io_backend_watch(backend, rx) != DCF_SUCCESS) { printf("socket setup failed\n"); exit(1); }
+    uint8_t* payload = calloc(1, size);
+    struct iovec iov[BENCH_BATCH];
+    struct msghdr msgs[BENCH_BATCH];
+    for (size_t i = 0; i < BENCH_BATCH; i++) {
+        iov[i].iov_base = payload;
+        iov[i].iov_len = size;
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        msgs[i].msg_name = &rx_addr;
+        msgs[i].msg_namelen = sizeof(rx_addr);
+        msgs[i].msg_iov = &iov[i];
+        msgs[i].msg_iovlen = 1;
+    }
+    double start = now_sec(), cpu_start = cpu_sec();
+    size_t received = 0;
+    for (size_t sent_total = 0; sent_total < BENCH_MESSAGES; sent_total += BENCH_BATCH) {
+        size_t sent;
+        if (dcf_io_backend_send_batch(backend, tx, msgs, BENCH_BATCH, NULL, &sent) != DCF_SUCCESS) { printf("send failed\n"); exit(1); }
+        for (size_t i = 0; i < sent; i++) {
+            int fd;
+            const uint8_t* data;
+            size_t len;
+            if (dcf_io_backend_receive(backend, 1000, &fd, &data, &len) != DCF_SUCCESS) break;
+            if (len == size) received++;
+        }
+    }
+    double elapsed = now_sec() - start, cpu = cpu_sec() - cpu_start;
+    printf("%-8s %6zu bytes: %10.0f msgs/s, %6.2f us CPU/msg, %zu/%d received\n",
+           dcf_io_backend_name(preferred), size, received / elapsed, cpu * 1e6 / BENCH_MESSAGES, received, BENCH_MESSAGES);
+    free(payload);
+    close(rx);
+    close(tx);
+    dcf_io_backend_free(backend);
+}
+
+int main() {
+    const size_t sizes[] = {64, 256, 1024, 4096};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench(DCF_IO_BACKEND_EPOLL, sizes[i]);
+        bench(DCF_IO_BACKEND_IO_URING, sizes[i]);
+    }
+    printf("io backend benchmark finished\n");
+    return 0;
+}
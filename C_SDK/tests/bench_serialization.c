@@ -0,0 +1,110 @@
+#include "dcf_serialization.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MESSAGES 1000000
+#define BENCH_WARMUP 1000
+
+// Counts every heap call the process makes by wrapping glibc's allocator
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static size_t allocations;
+
+void* malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int round_trip_copying(const char* payload) {
+    uint8_t* data;
+    size_t len;
+    char* message;
+    char* sender;
+    if (dcf_serialize_message(payload, "bench-sender", "127.0.0.1:50051", &data, &len) != DCF_SUCCESS) return 1;
+    DCFError err = dcf_deserialize_message(data, len, &message, &sender);
+    free(data);
+    if (err != DCF_SUCCESS) return 1;
+    int failed = strcmp(message, payload) != 0;
+    free(message);
+    free(sender);
+    return failed;
+}
+
+static int round_trip_into(const char* payload) {
+    uint8_t buf[16384];
+    size_t len;
+    const char* message;
+    const char* sender;
+    if (dcf_serialize_message_into(payload, "bench-sender", "127.0.0.1:50051", buf, sizeof(buf), &len) != DCF_SUCCESS) return 1;
+    if (dcf_deserialize_message_view(buf, len, &message, &sender) != DCF_SUCCESS) return 1;
+    return strcmp(message, payload) != 0;
+}
+
+static int round_trip_scratch(const char* payload) {
+    const uint8_t* data;
+    size_t len;
+    const char* message;
+    const char* sender;
+    if (dcf_serialize_message_scratch(payload, "bench-sender", "127.0.0.1:50051", &data, &len) != DCF_SUCCESS) return 1;
+    if (dcf_deserialize_message_view(data, len, &message, &sender) != DCF_SUCCESS) return 1;
+    return strcmp(message, payload) != 0;
+}
+
+// Returns heap calls per message once warmed up
+static double bench(const char* name, int (*round_trip)(const char*), const char* payload, int* failures) {
+    for (int i = 0; i < BENCH_WARMUP; i++) *failures += round_trip(payload);
+    size_t before = allocations;
+    double start = now_ns();
+    for (int i = 0; i < BENCH_MESSAGES; i++) *failures += round_trip(payload);
+    double per_msg = (now_ns() - start) / BENCH_MESSAGES;
+    double allocs = (double)(allocations - before) / BENCH_MESSAGES;
+    printf("%-9s %5zu bytes: %7.1f ns/msg, %.2f allocs/msg\n", name, strlen(payload), per_msg, allocs);
+    return allocs;
+}
+
+int main() {
+    static const size_t sizes[] = {16, 256, 4096};
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        char* payload = malloc(sizes[i] + 1);
+        memset(payload, 'x', sizes[i]);
+        payload[sizes[i]] = '\0';
+        bench("copying", round_trip_copying, payload, &failures);
+        // The zero-allocation paths must not touch the heap in steady state
+        if (bench("into", round_trip_into, payload, &failures) != 0) failures++;
+        if (bench("scratch", round_trip_scratch, payload, &failures) != 0) failures++;
+        free(payload);
+    }
+    if (failures) {
+        printf("serialization benchmark failed: %d\n", failures);
+        return 1;
+    }
+    printf("All serialization benchmarks passed\n");
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "dcf_networking.h"
+#include "dcf_serialization.h"
+#include "messages.pb-c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define BENCH_MESSAGES 200000
+#define GRPC_MESSAGES 20000
+#define SERVER_PORT 50095
+#define CLIENT_PORT 50096
+#define RECIPIENT "127.0.0.1:50095"
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double cpu_ns(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e9 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e3;
+}
+
+// The old gRPC path: the packed message became the data field of a second
+// DCFMessage. This emulates only the second encode; the C++ string copies
+// it also made are not counted, so the nested figures are a lower bound.
+static size_t encode_nested(const uint8_t* payload, size_t payload_len, uint8_t* buf, size_t cap) {
+    uint8_t inner[16384];
+    size_t inner_len;
+    if (dcf_serialize_payload_into(payload, payload_len, "bench-sender", RECIPIENT, inner, sizeof(inner), &inner_len) != DCF_SUCCESS) return 0;
+    DCFMessage outer = DCF_MESSAGE__INIT;
+    outer.recipient = RECIPIENT;
+    outer.data.data = inner;
+    outer.data.len = inner_len;
+    size_t len = dcf_message__get_packed_size(&outer);
+    if (len > cap) return 0;
+    return dcf_message__pack(&outer, buf);
+}
+
+static size_t encode_single(const uint8_t* payload, size_t payload_len, uint8_t* buf, size_t cap) {
+    size_t len;
+    if (dcf_serialize_payload_into(payload, payload_len, "bench-sender", RECIPIENT, buf, cap, &len) != DCF_SUCCESS) return 0;
+    return len;
+}
+
+static void bench_encoding(const char* name, size_t (*encode)(const uint8_t*, size_t, uint8_t*, size_t), size_t size) {
+    uint8_t* payload = calloc(1, size);
+    uint8_t buf[16384];
+    size_t wire = 0;
+    double start = now_ns();
+    for (int i = 0; i < BENCH_MESSAGES; i++) wire = encode(payload, size, buf, sizeof(buf));
+    printf("%-6s %5zu bytes: %6.1f ns/msg, %5zu bytes on the wire\n", name, size, (now_ns() - start) / BENCH_MESSAGES, wire);
+    free(payload);
+}
+
+static DCFNetworking* start_node(const char* path, int port, const char* mode, DCFMode start_mode) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return NULL;
+    fprintf(fp, "{\"transport\": \"gRPC\", \"host\": \"127.0.0.1\", \"port\": %d, \"mode\": \"%s\", \"node_id\": \"node-%d\", \"peers\": [], \"server_threads\": 1, \"shared_memory\": false}", port, mode, port);
+    fclose(fp);
+    DCFConfig* config = dcf_config_load(path);
+    remove(path);
+    DCFNetworking* net = dcf_networking_new();
+    if (!config || !net || dcf_networking_initialize(net, config) != DCF_SUCCESS || dcf_networking_start(net, start_mode) != DCF_SUCCESS) {
+        dcf_networking_free(net);
+        net = NULL;
+    }
+    dcf_config_free(config);
+    return net;
+}
+
+// Unary sends over loopback gRPC, each acknowledged and drained by the server node
+static int bench_grpc(size_t size) {
+    DCFNetworking* server = start_node("bench_wire_server.json", SERVER_PORT, "server", SERVER_MODE);
+    DCFNetworking* client = start_node("bench_wire_client.json", CLIENT_PORT, "client", CLIENT_MODE);
+    int failures = 0;
+    if (!server || !client) {
+        printf("gRPC setup failed\n");
+        failures++;
+        goto done;
+    }
+    uint8_t* payload = calloc(1, size);
+    uint8_t* packed;
+    size_t packed_len;
+    if (dcf_serialize_payload(payload, size, "bench-sender", RECIPIENT, &packed, &packed_len) != DCF_SUCCESS) {
+        free(payload);
+        failures++;
+        goto done;
+    }
+    double start = now_ns();
+    double cpu_start = cpu_ns();
+    for (int i = 0; i < GRPC_MESSAGES && !failures; i++) {
+        const uint8_t* received;
+        size_t received_len;
+        const char* sender;
+        if (dcf_networking_send(client, packed, packed_len, RECIPIENT) != DCF_SUCCESS ||
+            dcf_networking_receive_payload(server, &received, &received_len, &sender) != DCF_SUCCESS ||
+            received_len != size) failures++;
+    }
+    printf("gRPC   %5zu bytes: %6.1f us/msg, %6.1f us CPU/msg, %5zu bytes per message body\n", size,
+           (now_ns() - start) / GRPC_MESSAGES / 1e3, (cpu_ns() - cpu_start) / GRPC_MESSAGES / 1e3, packed_len);
+    free(packed);
+    free(payload);
+done:
+    if (client) dcf_networking_stop(client);
+    if (server) dcf_networking_stop(server);
+    dcf_networking_free(client);
+    dcf_networking_free(server);
+    return failures;
+}
+
+int main() {
+    static const size_t sizes[] = {16, 256, 4096};
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_encoding("nested", encode_nested, sizes[i]);
+        bench_encoding("single", encode_single, sizes[i]);
+        failures += bench_grpc(sizes[i]);
+    }
+    if (failures) {
+        printf("wire encoding benchmark failed: %d\n", failures);
+        return 1;
+    }
+    printf("All wire encoding benchmarks passed\n");
+    return 0;
+}
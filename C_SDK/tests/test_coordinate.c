@@ -0,0 +1,76 @@
+#include "dcf_coordinate.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NODES 200
+#define NEIGHBORS 8
+#define ROUNDS 1000
+
+// Ground truth: nodes scattered over a plane 100 ms across, each behind an access link
+static float pos[NODES][2];
+static float access_us[NODES];
+
+static uint32_t true_rtt(int a, int b) {
+    float dx = pos[a][0] - pos[b][0], dy = pos[a][1] - pos[b][1];
+    return (uint32_t)(sqrtf(dx * dx + dy * dy) + access_us[a] + access_us[b]);
+}
+
+static int compare(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return x < y ? -1 : x > y;
+}
+
+int main() {
+    srand(42);
+    unsigned int seed = 7;
+    static DCFCoordinate coords[NODES];
+    static int neighbors[NODES][NEIGHBORS];
+    int failures = 0;
+    for (int i = 0; i < NODES; i++) {
+        pos[i][0] = (float)(rand() % 100000);
+        pos[i][1] = (float)(rand() % 100000);
+        access_us[i] = (float)(100 + rand() % 2000);
+        dcf_coordinate_init(&coords[i]);
+        for (int k = 0; k < NEIGHBORS; k++) {
+            do neighbors[i][k] = rand() % NODES; while (neighbors[i][k] == i);
+        }
+    }
+    // Each node only ever probes its fixed few neighbors, as with a probe budget
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < NODES; i++) {
+            int j = neighbors[i][rand() % NEIGHBORS];
+            dcf_coordinate_update(&coords[i], &coords[j], true_rtt(i, j), &seed);
+        }
+    }
+    // Yet every pair, probed or not, should be estimated well
+    static float errors[NODES * (NODES - 1) / 2];
+    size_t count = 0;
+    for (int i = 0; i < NODES; i++) {
+        for (int j = i + 1; j < NODES; j++) {
+            float rtt = (float)true_rtt(i, j);
+            errors[count++] = fabsf((float)dcf_coordinate_distance_us(&coords[i], &coords[j]) - rtt) / rtt;
+        }
+    }
+    qsort(errors, count, sizeof(float), compare);
+    float median = errors[count / 2];
+    if (!(median < 0.15f)) {
+        printf("median relative error %.3f\n", median);
+        failures++;
+    }
+    uint8_t wire[DCF_COORDINATE_WIRE_SIZE];
+    DCFCoordinate decoded;
+    dcf_coordinate_encode(&coords[0], wire);
+    if (dcf_coordinate_decode(wire, sizeof(wire), &decoded) != DCF_SUCCESS || dcf_coordinate_distance_us(&decoded, &coords[1]) != dcf_coordinate_distance_us(&coords[0], &coords[1])) failures++;
+    if (dcf_coordinate_decode(wire, sizeof(wire) - 1, &decoded) != DCF_ERR_DESERIALIZATION_FAIL) failures++;
+    // Garbage from a peer is rejected rather than folded in
+    wire[4 + 3] = 0x7f;
+    wire[4 + 2] = 0xc0;
+    if (dcf_coordinate_decode(wire, sizeof(wire), &decoded) != DCF_ERR_DESERIALIZATION_FAIL) failures++;
+    if (failures) {
+        printf("coordinate tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All coordinate tests passed\n");
+    return 0;
+}
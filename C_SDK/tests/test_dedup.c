@@ -0,0 +1,43 @@
+#include "dcf_dedup.h"
+#include <stdio.h>
+#include <string.h>
+
+static int first_copy(DCFDedup* dedup, const char* sender, uint32_t sequence) {
+    return dcf_dedup_accept(dedup, (const uint8_t*)sender, strlen(sender), sequence);
+}
+
+int main() {
+    DCFDedup* dedup = dcf_dedup_new();
+    if (!dedup) {
+        printf("dedup setup failed\n");
+        return 1;
+    }
+    int failures = 0;
+    // First copy wins, later copies are dropped, other senders are independent
+    if (!first_copy(dedup, "a", 10) || first_copy(dedup, "a", 10)) failures++;
+    if (!first_copy(dedup, "b", 10) || first_copy(dedup, "b", 10)) failures++;
+    // Out of order inside the window, including numbers below the first one seen
+    if (!first_copy(dedup, "a", 12) || !first_copy(dedup, "a", 11) || first_copy(dedup, "a", 11)) failures++;
+    if (!first_copy(dedup, "a", 9) || first_copy(dedup, "a", 9)) failures++;
+    // Sliding forward forgets old bits without losing recent ones
+    uint32_t top = 12 + DCF_DEDUP_WINDOW - 1;
+    if (!first_copy(dedup, "a", top) || first_copy(dedup, "a", 12) || first_copy(dedup, "a", top)) failures++;
+    // Far below the window reads as a restart and is let through
+    if (!first_copy(dedup, "a", 1) || first_copy(dedup, "a", 1)) failures++;
+    // The 32-bit counter wraps
+    if (!first_copy(dedup, "c", UINT32_MAX - 1) || !first_copy(dedup, "c", 2) || first_copy(dedup, "c", UINT32_MAX - 1) || first_copy(dedup, "c", 2)) failures++;
+    if (!first_copy(dedup, "c", UINT32_MAX) || first_copy(dedup, "c", UINT32_MAX)) failures++;
+    // Far more senders than slots: each still dedupes its own recent copies
+    char name[32];
+    for (int i = 0; i < DCF_DEDUP_SENDERS * 4; i++) {
+        snprintf(name, sizeof(name), "node-%d", i);
+        if (!first_copy(dedup, name, 7) || first_copy(dedup, name, 7)) failures++;
+    }
+    dcf_dedup_free(dedup);
+    if (failures) {
+        printf("dedup tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All dedup tests passed\n");
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "dcf_histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SAMPLES 200000
+
+static int compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Latencies spread over several decades, from 1 us to about 1 s in ns
+static uint64_t random_latency(void) {
+    int decade = rand() % 6;
+    uint64_t scale = 1000;
+    while (decade--) scale *= 10;
+    return scale + (uint64_t)rand() % (scale * 9);
+}
+
+int main() {
+    srand(42);
+    static const double percentiles[] = {0, 50, 90, 99, 99.9, 100};
+    uint64_t* values = malloc(SAMPLES * sizeof(uint64_t));
+    DCFHistogram* whole = dcf_histogram_new();
+    DCFHistogram* halves[2] = { dcf_histogram_new(), dcf_histogram_new() };
+    int failures = 0;
+    if (!values || !whole || !halves[0] || !halves[1]) {
+        printf("histogram setup failed\n");
+        return 1;
+    }
+    for (int i = 0; i < SAMPLES; i++) {
+        values[i] = random_latency();
+        dcf_histogram_record(whole, values[i]);
+        dcf_histogram_record(halves[i % 2], values[i]);
+    }
+    dcf_histogram_merge(halves[0], halves[1]);
+    qsort(values, SAMPLES, sizeof(uint64_t), compare);
+    if (dcf_histogram_count(whole) != SAMPLES || dcf_histogram_min(whole) != values[0] || dcf_histogram_max(whole) != values[SAMPLES - 1]) failures++;
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        double exact_rank = percentiles[i] / 100 * SAMPLES;
+        size_t rank = (size_t)exact_rank;
+        if (rank < exact_rank || rank < 1) rank++;
+        uint64_t exact = values[rank - 1];
+        uint64_t got = dcf_histogram_percentile(whole, percentiles[i]);
+        // Three significant digits
+        if (got < exact || got - exact > exact / 1000) failures++;
+        if (dcf_histogram_percentile(halves[0], percentiles[i]) != got) failures++;
+    }
+    // Values past the range are clamped rather than lost
+    dcf_histogram_reset(whole);
+    dcf_histogram_record(whole, UINT64_MAX);
+    if (dcf_histogram_count(whole) != 1 || dcf_histogram_percentile(whole, 50) != DCF_HISTOGRAM_MAX_VALUE) failures++;
+    dcf_histogram_free(whole);
+    dcf_histogram_free(halves[0]);
+    dcf_histogram_free(halves[1]);
+    free(values);
+    if (failures) {
+        printf("histogram tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All histogram tests passed\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "dcf_membership.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NODES 64
+#define PERIOD_MS 100
+#define QUEUE 65536
+#define DEAD_TIMEOUT_MS 30000
+
+// Simulated network: messages land 1-5 ms after sending unless dropped
+typedef struct {
+    int to;
+    uint64_t at_us;
+    uint8_t* data;
+    size_t len;
+} Packet;
+
+static Packet queue[QUEUE];
+static size_t queued;
+static uint64_t now_us;
+static int loss_percent;
+static bool down[NODES];
+static DCFMembership* nodes[NODES];
+static uint64_t next_tick[NODES];
+static uint64_t sent;
+static int removed;
+
+static void node_name(int node, char* buf) {
+    snprintf(buf, 32, "10.0.0.%d:50051", node);
+}
+
+static void on_send(void* user_data, const char* address, const uint8_t* data, size_t len) {
+    (void)user_data;
+    sent++;
+    if (rand() % 100 < loss_percent || queued == QUEUE) return;
+    int to = atoi(strrchr(address, '.') + 1);
+    Packet* p = &queue[queued++];
+    p->to = to;
+    p->at_us = now_us + 1000 + (uint64_t)(rand() % 4000);
+    p->data = malloc(len);
+    memcpy(p->data, data, len);
+    p->len = len;
+}
+
+static void on_removed(void* user_data, const char* address) {
+    (void)user_data;
+    (void)address;
+    removed++;
+}
+
+static DCFMembership* start_node(int node) {
+    static const DCFMembershipOptions options = { PERIOD_MS, 30, 3, 4, 3, DEAD_TIMEOUT_MS };
+    DCFMembershipCallbacks callbacks = { on_send, NULL, on_removed, NULL };
+    char name[32];
+    node_name(node, name);
+    DCFMembership* m = dcf_membership_new(name, &options, &callbacks);
+    // Everyone knows only node 0 to begin with
+    node_name(0, name);
+    if (node != 0) dcf_membership_join(m, name);
+    next_tick[node] = now_us;
+    return m;
+}
+
+static void run(uint64_t duration_ms) {
+    uint64_t end = now_us + duration_ms * 1000;
+    for (; now_us < end; now_us += 1000) {
+        for (size_t i = 0; i < queued;) {
+            if (queue[i].at_us > now_us) {
+                i++;
+                continue;
+            }
+            Packet p = queue[i];
+            queue[i] = queue[--queued];
+            if (!down[p.to]) dcf_membership_handle(nodes[p.to], p.data, p.len, now_us);
+            free(p.data);
+        }
+        for (int n = 0; n < NODES; n++) {
+            if (!down[n] && next_tick[n] <= now_us) next_tick[n] = dcf_membership_tick(nodes[n], now_us);
+        }
+    }
+}
+
+// Nodes that are up and see member in state
+static int count_seeing(int member, DCFMemberState state) {
+    char name[32];
+    node_name(member, name);
+    int count = 0;
+    for (int n = 0; n < NODES; n++) {
+        DCFMemberState s;
+        if (n != member && !down[n] && dcf_membership_get_state(nodes[n], name, &s, NULL) == DCF_SUCCESS && s == state) count++;
+    }
+    return count;
+}
+
+int main() {
+    srand(7);
+    int failures = 0;
+    for (int n = 0; n < NODES; n++) nodes[n] = start_node(n);
+    // Joining through one seed spreads to everyone
+    run(10000);
+    for (int n = 0; n < NODES; n++) {
+        if (count_seeing(n, DCF_MEMBER_ALIVE) != NODES - 1) failures++;
+    }
+    // Load per node stays at a ping and an ack per period, plus the odd indirect probe
+    sent = 0;
+    run(5000);
+    double per_period = (double)sent / NODES / (5000 / PERIOD_MS);
+    if (per_period > 3) failures++;
+    // Under 5% loss, indirect probes and refutation keep live members from being declared dead
+    loss_percent = 5;
+    run(20000);
+    for (int n = 0; n < NODES; n++) {
+        if (count_seeing(n, DCF_MEMBER_DEAD) != 0) failures++;
+    }
+    // A crashed node is suspected, then declared dead by everyone
+    int victim = NODES / 2;
+    down[victim] = true;
+    run(10000);
+    if (count_seeing(victim, DCF_MEMBER_DEAD) != NODES - 1) failures++;
+    // Restarted with a fresh incarnation, it learns of its death, refutes it and is
+    // taken back. It learns the rest as they probe it, within about a round of probes.
+    loss_percent = 0;
+    dcf_membership_free(nodes[victim]);
+    nodes[victim] = start_node(victim);
+    down[victim] = false;
+    run(NODES * PERIOD_MS * 2);
+    if (count_seeing(victim, DCF_MEMBER_ALIVE) != NODES - 1 || dcf_membership_incarnation(nodes[victim]) == 0) failures++;
+    if (dcf_membership_count(nodes[victim]) != NODES - 1) failures++;
+    // A node that stays down is forgotten by everyone once dead_timeout_ms has passed
+    int gone = NODES / 4;
+    down[gone] = true;
+    removed = 0;
+    run(DEAD_TIMEOUT_MS + 10000);
+    if (count_seeing(gone, DCF_MEMBER_DEAD) != 0 || removed != NODES - 1) failures++;
+    for (int n = 0; n < NODES; n++) {
+        if (n != gone && dcf_membership_count(nodes[n]) != NODES - 2) failures++;
+    }
+    // Garbage is rejected without touching state
+    if (dcf_membership_handle(nodes[0], (const uint8_t*)"DCFGx", 5, now_us) != DCF_ERR_DESERIALIZATION_FAIL) failures++;
+    if (dcf_membership_is_message((const uint8_t*)"hello", 5)) failures++;
+    for (int n = 0; n < NODES; n++) dcf_membership_free(nodes[n]);
+    for (size_t i = 0; i < queued; i++) free(queue[i].data);
+    if (failures) {
+        printf("membership tests failed: %d (%.2f messages per node per period)\n", failures, per_period);
+        return 1;
+    }
+    printf("All membership tests passed\n");
+    return 0;
+}
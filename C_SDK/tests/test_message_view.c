@@ -0,0 +1,176 @@
+#include "dcf_message_view.h"
+#include "dcf_serialization.h"
+#include "messages.pb-c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUND_TRIPS 10000
+#define FUZZ_CASES 200000
+#define MAX_PACKED 4096
+
+static char* random_string(size_t max_len) {
+    size_t len = rand() % (max_len + 1);
+    char* s = malloc(len + 1);
+    for (size_t i = 0; i < len; i++) s[i] = 'a' + rand() % 26;
+    s[len] = '\0';
+    return s;
+}
+
+// Random field values, each field present or left at its default
+static void random_message(DCFMessage* msg, uint8_t* data) {
+    DCFMessage init = DCF_MESSAGE__INIT;
+    *msg = init;
+    if (rand() % 4) msg->sender = random_string(24);
+    if (rand() % 4) msg->recipient = random_string(32);
+    if (rand() % 4) {
+        msg->data.len = rand() % 512;
+        for (size_t i = 0; i < msg->data.len; i++) data[i] = rand();
+        msg->data.data = data;
+    }
+    if (rand() % 2) msg->timestamp = ((int64_t)rand() << 32 | rand()) * (rand() % 2 ? 1 : -1);
+    msg->has_sync = rand() % 2;
+    msg->sync = msg->has_sync && rand() % 2;
+    msg->has_sequence = rand() % 2;
+    if (msg->has_sequence) msg->sequence = rand() % 3 ? (uint32_t)rand() : UINT32_MAX;
+    if (rand() % 4 == 0) msg->redundancy_path = random_string(16);
+    if (rand() % 4 == 0) msg->group_id = random_string(8);
+}
+
+static void free_message(DCFMessage* msg) {
+    free(msg->sender);
+    free(msg->recipient);
+    free(msg->redundancy_path);
+    free(msg->group_id);
+}
+
+static bool slice_matches(DCFSlice slice, const char* s) {
+    return s ? dcf_slice_equals(slice, s) : slice.len == 0;
+}
+
+// The view agrees with a message protobuf-c unpacked (or was packed from)
+static bool view_matches(const DCFMessageView* view, const DCFMessage* msg) {
+    return slice_matches(view->sender, msg->sender) &&
+           slice_matches(view->recipient, msg->recipient) &&
+           view->data.len == msg->data.len && (msg->data.len == 0 || memcmp(view->data.data, msg->data.data, msg->data.len) == 0) &&
+           view->timestamp == msg->timestamp &&
+           view->sync == (msg->has_sync && msg->sync) &&
+           view->sequence == (msg->has_sequence ? msg->sequence : 0) &&
+           slice_matches(view->redundancy_path, msg->redundancy_path) &&
+           slice_matches(view->group_id, msg->group_id);
+}
+
+static int test_round_trip(void) {
+    int failures = 0;
+    uint8_t data[512];
+    uint8_t packed[MAX_PACKED];
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        DCFMessage msg;
+        random_message(&msg, data);
+        size_t len = dcf_message__pack(&msg, packed);
+        DCFMessageView view;
+        if (dcf_message_view_parse(packed, len, DCF_VIEW_ALL, &view) != DCF_SUCCESS || !view_matches(&view, &msg)) failures++;
+        // Partial decoding fills only the header fields
+        DCFMessageView header;
+        if (dcf_message_view_parse(packed, len, DCF_VIEW_HEADER, &header) != DCF_SUCCESS ||
+            (header.present & ~DCF_VIEW_HEADER) || header.sender.len || header.data.len || header.timestamp ||
+            !slice_matches(header.recipient, msg.recipient) || header.sequence != view.sequence) failures++;
+        free_message(&msg);
+    }
+    return failures;
+}
+
+// Concatenated messages merge; the view must pick the same last occurrences as protobuf-c
+static int test_merge(void) {
+    int failures = 0;
+    uint8_t data[2][512];
+    uint8_t packed[2 * MAX_PACKED];
+    for (int i = 0; i < ROUND_TRIPS / 10; i++) {
+        DCFMessage a, b;
+        random_message(&a, data[0]);
+        random_message(&b, data[1]);
+        size_t len = dcf_message__pack(&a, packed);
+        len += dcf_message__pack(&b, packed + len);
+        DCFMessage* merged = dcf_message__unpack(NULL, len, packed);
+        DCFMessageView view;
+        if (!merged || dcf_message_view_parse(packed, len, DCF_VIEW_ALL, &view) != DCF_SUCCESS || !view_matches(&view, merged)) failures++;
+        dcf_message__free_unpacked(merged, NULL);
+        free_message(&a);
+        free_message(&b);
+    }
+    return failures;
+}
+
+// Corrupted input: both parsers accept or reject it alike, and agree on what they accept
+static int test_fuzz(void) {
+    int failures = 0;
+    uint8_t data[512];
+    uint8_t packed[MAX_PACKED + 64];
+    for (int i = 0; i < FUZZ_CASES; i++) {
+        DCFMessage msg;
+        random_message(&msg, data);
+        size_t len = dcf_message__pack(&msg, packed);
+        free_message(&msg);
+        int mutations = 1 + rand() % 4;
+        for (int m = 0; m < mutations && len > 0; m++) {
+            switch (rand() % 4) {
+            case 0: packed[rand() % len] ^= 1 << (rand() % 8); break;
+            case 1: packed[rand() % len] = rand(); break;
+            case 2: len = rand() % len; break;
+            default:
+                if (len < sizeof(packed)) packed[len++] = rand();
+                break;
+            }
+        }
+        DCFMessage* unpacked = dcf_message__unpack(NULL, len, packed);
+        DCFMessageView view;
+        DCFError err = dcf_message_view_parse(packed, len, DCF_VIEW_ALL, &view);
+        if ((unpacked != NULL) != (err == DCF_SUCCESS) || (unpacked && !view_matches(&view, unpacked))) failures++;
+        dcf_message__free_unpacked(unpacked, NULL);
+    }
+    return failures;
+}
+
+// Envelope packing decodes to the same message as a full protobuf-c pack
+static int test_envelope(void) {
+    int failures = 0;
+    uint8_t data[512];
+    uint8_t packed[MAX_PACKED];
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        DCFMessage msg;
+        random_message(&msg, data);
+        if (!msg.sender) msg.sender = random_string(8);
+        if (!msg.recipient) msg.recipient = random_string(8);
+        msg.has_sync = true;
+        msg.sync = false;
+        msg.has_sequence = true;
+        DCFEnvelope* env = dcf_envelope_new(msg.sender, msg.recipient, msg.redundancy_path, msg.group_id);
+        size_t len;
+        DCFMessageView view;
+        if (!env || dcf_envelope_pack(env, msg.data.data, msg.data.len, msg.timestamp, msg.sequence, packed, sizeof(packed), &len) != DCF_SUCCESS ||
+            len != dcf_message__get_packed_size(&msg) ||
+            dcf_message_view_parse(packed, len, DCF_VIEW_ALL, &view) != DCF_SUCCESS || !view_matches(&view, &msg)) failures++;
+        // Too small a buffer reports the size needed
+        size_t needed;
+        if (env && (dcf_envelope_pack(env, msg.data.data, msg.data.len, msg.timestamp, msg.sequence, packed, len - 1, &needed) != DCF_ERR_INVALID_ARG || needed != len)) failures++;
+        dcf_envelope_free(env);
+        free_message(&msg);
+    }
+    return failures;
+}
+
+int main() {
+    srand(42);
+    int failures = test_round_trip();
+    failures += test_merge();
+    failures += test_fuzz();
+    failures += test_envelope();
+    DCFMessageView view;
+    if (dcf_message_view_parse(NULL, 0, DCF_VIEW_ALL, &view) != DCF_SUCCESS || view.present != 0) failures++;
+    if (failures) {
+        printf("message view tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All message view tests passed\n");
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "dcf_client.h"
+#include "dcf_networking.h"
+#include "dcf_serialization.h"
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RECEIVER_PORT 50091
+#define SENDER_PORT 50092
+#define MESSAGES 1000
+
+static bool write_config(const char* path, int port, bool shared_memory) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    fprintf(fp, "{\"transport\": \"UDP\", \"host\": \"127.0.0.1\", \"port\": %d, \"mode\": \"p2p\", \"node_id\": \"node-%d\", \"peers\": [], \"socket_rcvbuf\": 4194304, \"shared_memory\": %s}",
+            port, port, shared_memory ? "true" : "false");
+    fclose(fp);
+    return true;
+}
+
+static void count_message(void* user_data, const char* message, const char* sender) {
+    size_t* count = user_data;
+    if (strcmp(message, "ping") == 0 && strcmp(sender, "sender") == 0) (*count)++;
+}
+
+static bool readable(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+// Delivers MESSAGES to a polling client, over shared memory or over UDP, mostly as one batch
+static int run(bool shared_memory) {
+    write_config("test_reactor.json", RECEIVER_PORT, shared_memory);
+    DCFConfig* sender_config = write_config("test_reactor_sender.json", SENDER_PORT, shared_memory) ? dcf_config_load("test_reactor_sender.json") : NULL;
+    DCFClient* client = dcf_client_new();
+    DCFNetworking* sender = dcf_networking_new();
+    int failures = 0;
+    if (!client || !sender || !sender_config ||
+        dcf_client_initialize(client, "test_reactor.json") != DCF_SUCCESS ||
+        dcf_client_start(client) != DCF_SUCCESS ||
+        dcf_networking_initialize(sender, sender_config) != DCF_SUCCESS) {
+        printf("reactor setup failed\n");
+        failures++;
+        goto done;
+    }
+    size_t count = 0;
+    dcf_client_register_handler(client, count_message, &count);
+    int fd = dcf_client_get_fd(client);
+    char* message;
+    char* sender_id;
+    // Draining an idle client leaves its fd unreadable until something arrives
+    if (fd < 0 || dcf_client_try_receive_message(client, &message, &sender_id) != DCF_ERR_TIMEOUT || readable(fd)) failures++;
+    uint8_t* data;
+    size_t len;
+    if (dcf_serialize_message("ping", "sender", "node-50091", &data, &len) != DCF_SUCCESS) {
+        failures++;
+        goto done;
+    }
+    char addr[32];
+    snprintf(addr, sizeof(addr), "127.0.0.1:%d", RECEIVER_PORT);
+    if (dcf_networking_send(sender, data, len, addr) != DCF_SUCCESS || !readable(fd)) failures++;
+    // The rest go out as one batch
+    const uint8_t* batch[MESSAGES - 1];
+    size_t lens[MESSAGES - 1];
+    DCFError results[MESSAGES - 1];
+    for (int i = 0; i < MESSAGES - 1; i++) {
+        batch[i] = data;
+        lens[i] = len;
+    }
+    if (dcf_networking_send_batch(sender, batch, lens, MESSAGES - 1, addr, results) != DCF_SUCCESS) failures++;
+    for (int i = 0; i < MESSAGES - 1; i++) {
+        if (results[i] != DCF_SUCCESS) failures++;
+    }
+    free(data);
+    for (int idle = 0; count < MESSAGES && idle < 10;) {
+        size_t dispatched;
+        if (dcf_client_poll(client, 100, &dispatched) != DCF_SUCCESS) break;
+        idle = dispatched ? 0 : idle + 1;
+    }
+    if (count != MESSAGES) failures++;
+    printf("reactor over %s: %zu/%d messages dispatched\n", shared_memory ? "shared memory" : "UDP", count, MESSAGES);
+    // Binary payloads keep their NULs end to end
+    static const uint8_t frame[] = {0x00, 0x01, 0xff, 0x00, 'x'};
+    const uint8_t* payload;
+    size_t payload_len;
+    const char* payload_sender;
+    if (dcf_serialize_payload(frame, sizeof(frame), "sender", "node-50091", &data, &len) != DCF_SUCCESS ||
+        dcf_networking_send(sender, data, len, addr) != DCF_SUCCESS) failures++;
+    free(data);
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    poll(&pfd, 1, 1000);
+    if (dcf_client_try_receive_payload(client, &payload, &payload_len, &payload_sender) != DCF_SUCCESS ||
+        payload_len != sizeof(frame) || memcmp(payload, frame, sizeof(frame)) != 0) failures++;
+    dcf_client_stop(client);
+done:
+    dcf_networking_free(sender);
+    dcf_client_free(client);
+    dcf_config_free(sender_config);
+    remove("test_reactor.json");
+    remove("test_reactor_sender.json");
+    return failures;
+}
+
+int main() {
+    int failures = run(true) + run(false);
+    if (failures) {
+        printf("reactor tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All reactor tests passed\n");
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "dcf_routing.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NODES 12
+#define UPDATES 20000
+#define INF UINT64_MAX
+// Fits "10.0.0.255:50051" with its terminator
+#define NAME_LEN 24
+
+static uint32_t weights[NODES][NODES];
+
+static void node_name(int node, char* buf) {
+    snprintf(buf, NAME_LEN, "10.0.0.%d:50051", node);
+}
+
+// All-pairs shortest paths by Floyd-Warshall, the reference the table is checked against
+static void shortest_paths(uint64_t dist[NODES][NODES]) {
+    for (int i = 0; i < NODES; i++) {
+        for (int j = 0; j < NODES; j++) dist[i][j] = i == j ? 0 : weights[i][j] == DCF_ROUTE_NO_LINK ? INF : weights[i][j];
+    }
+    for (int k = 0; k < NODES; k++) {
+        for (int i = 0; i < NODES; i++) {
+            for (int j = 0; j < NODES; j++) {
+                if (dist[i][k] != INF && dist[k][j] != INF && dist[i][k] + dist[k][j] < dist[i][j]) dist[i][j] = dist[i][k] + dist[k][j];
+            }
+        }
+    }
+}
+
+static int check(DCFRoutingTable* table) {
+    static uint64_t dist[NODES][NODES];
+    shortest_paths(dist);
+    int failures = 0;
+    char name[NAME_LEN];
+    for (int node = 1; node < NODES; node++) {
+        node_name(node, name);
+        uint64_t got;
+        char* hop;
+        DCFError err = dcf_routing_get_distance(table, name, &got);
+        DCFError hop_err = dcf_routing_next_hop(table, name, &hop);
+        if (dist[0][node] == INF) {
+            if (err != DCF_ERR_ROUTE_NOT_FOUND || hop_err != DCF_ERR_ROUTE_NOT_FOUND) failures++;
+            continue;
+        }
+        if (err != DCF_SUCCESS || got != dist[0][node] || hop_err != DCF_SUCCESS) {
+            failures++;
+            continue;
+        }
+        // The first hop must start a shortest path: a direct link, then the best path on from it
+        int h = atoi(strrchr(strtok(hop, ":"), '.') + 1);
+        if (weights[0][h] == DCF_ROUTE_NO_LINK || dist[h][node] == INF || weights[0][h] + dist[h][node] != dist[0][node]) failures++;
+        free(hop);
+    }
+    return failures;
+}
+
+// Disjoint routes must be real paths, share no inner node, start with a shortest
+// path and only get longer
+static int check_disjoint(DCFRoutingTable* table) {
+    static uint64_t dist[NODES][NODES];
+    shortest_paths(dist);
+    int failures = 0;
+    char name[NAME_LEN];
+    for (int node = 1; node < NODES; node++) {
+        node_name(node, name);
+        char* routes[3];
+        size_t count;
+        DCFError err = dcf_routing_disjoint_routes(table, name, 3, routes, &count);
+        if (dist[0][node] == INF) {
+            if (err != DCF_ERR_ROUTE_NOT_FOUND) failures++;
+            continue;
+        }
+        if (err != DCF_SUCCESS || count == 0) {
+            failures++;
+            continue;
+        }
+        bool used[NODES] = { false };
+        uint64_t last = 0;
+        for (size_t r = 0; r < count; r++) {
+            uint64_t cost = 0;
+            int prev = 0;
+            for (char* step = strtok(routes[r], ","); step; step = strtok(NULL, ",")) {
+                int n = atoi(strrchr(step, '.') + 1);
+                if (weights[prev][n] == DCF_ROUTE_NO_LINK || (n != node && used[n])) failures++;
+                else cost += weights[prev][n];
+                if (n != node) used[n] = true;
+                prev = n;
+            }
+            if (prev != node || cost < last || (r == 0 && cost != dist[0][node])) failures++;
+            last = cost;
+            free(routes[r]);
+        }
+    }
+    return failures;
+}
+
+int main() {
+    srand(42);
+    char self[NAME_LEN];
+    node_name(0, self);
+    DCFRoutingTable* table = dcf_routing_new(self);
+    if (!table) {
+        printf("routing setup failed\n");
+        return 1;
+    }
+    for (int i = 0; i < NODES; i++) {
+        for (int j = 0; j < NODES; j++) weights[i][j] = DCF_ROUTE_NO_LINK;
+    }
+    int failures = 0;
+    char* hop;
+    if (dcf_routing_next_hop(table, "10.0.0.99:50051", &hop) != DCF_ERR_ROUTE_NOT_FOUND) failures++;
+    if (dcf_routing_set_link(table, self, self, 1) != DCF_ERR_INVALID_ARG) failures++;
+    // Random adds, reweights and removals, each checked against a full recomputation
+    for (int update = 0; update < UPDATES; update++) {
+        int from = rand() % NODES, to = rand() % NODES;
+        if (from == to) continue;
+        uint32_t weight = rand() % 4 == 0 ? DCF_ROUTE_NO_LINK : 100 + (uint32_t)(rand() % 5000);
+        char from_name[NAME_LEN], to_name[NAME_LEN];
+        node_name(from, from_name);
+        node_name(to, to_name);
+        if (dcf_routing_set_link(table, from_name, to_name, weight) != DCF_SUCCESS) failures++;
+        weights[from][to] = weight;
+        if (update % 10 == 0) failures += check(table);
+        if (update % 100 == 0) failures += check_disjoint(table);
+    }
+    failures += check(table);
+    // Handles name the same nodes as addresses, on the write and lookup paths alike
+    char name[NAME_LEN];
+    node_name(NODES - 1, name);
+    DCFRouteNode far = dcf_routing_node(table, name);
+    DCFRouteNode hop_node;
+    if (far == DCF_ROUTE_NODE_NONE || dcf_routing_node(table, self) != DCF_ROUTE_SELF) failures++;
+    if (dcf_routing_set_link_nodes(table, DCF_ROUTE_SELF, far, 1) != DCF_SUCCESS) failures++;
+    weights[0][NODES - 1] = 1;
+    failures += check(table);
+    if (dcf_routing_next_hop_node(table, far, &hop_node) != DCF_SUCCESS || hop_node != far) failures++;
+    if (dcf_routing_set_link_nodes(table, DCF_ROUTE_SELF, far + 1000, 1) != DCF_ERR_INVALID_ARG) failures++;
+    // Tags follow the first hop; an untagged hop reads as none
+    uint32_t tag;
+    if (dcf_routing_next_hop_tag(table, far, &tag) != DCF_SUCCESS || tag != DCF_ROUTE_NODE_NONE) failures++;
+    if (dcf_routing_set_tag(table, far, 42) != DCF_SUCCESS || dcf_routing_next_hop_tag(table, far, &tag) != DCF_SUCCESS || tag != 42) failures++;
+    if (dcf_routing_set_tag(table, far + 1000, 1) != DCF_ERR_INVALID_ARG) failures++;
+    dcf_routing_free(table);
+    if (failures) {
+        printf("routing tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All routing tests passed\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "dcf_shm_transport.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHM_PORT_A 50081
+#define SHM_PORT_B 50082
+#define LATENCY_ROUNDS 100000
+#define PRODUCERS 4
+#define PER_PRODUCER 50000
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int test_basic(void) {
+    DCFShmTransport* shm = dcf_shm_transport_new();
+    if (!shm || dcf_shm_transport_initialize(shm, SHM_PORT_A) != DCF_SUCCESS) return 1;
+    const uint8_t* data;
+    size_t len;
+    int failures = 0;
+    if (dcf_shm_transport_receive(shm, 0, &data, &len) != DCF_ERR_TIMEOUT) failures++;
+    if (!dcf_shm_transport_reaches(shm, "127.0.0.1:50081")) failures++;
+    if (dcf_shm_transport_reaches(shm, "127.0.0.1:50089")) failures++;
+    if (dcf_shm_transport_send(shm, (const uint8_t*)"hello", 5, "127.0.0.1:50089") != DCF_ERR_ROUTE_NOT_FOUND) failures++;
+    if (dcf_shm_transport_send(shm, (const uint8_t*)"hello", 5, "localhost:50081") != DCF_SUCCESS) failures++;
+    if (dcf_shm_transport_receive(shm, 100, &data, &len) != DCF_SUCCESS || len != 5 || memcmp(data, "hello", 5) != 0) failures++;
+    // A second owner of the same port is refused while the first is alive
+    DCFShmTransport* dup = dcf_shm_transport_new();
+    if (dcf_shm_transport_initialize(dup, SHM_PORT_A) != DCF_ERR_INVALID_STATE) failures++;
+    dcf_shm_transport_free(dup);
+    dcf_shm_transport_free(shm);
+    return failures;
+}
+
+typedef struct {
+    int id;
+    int failures;
+} Producer;
+
+static void* produce(void* arg) {
+    Producer* p = arg;
+    DCFShmTransport* shm = dcf_shm_transport_new();
+    dcf_shm_transport_initialize(shm, 0);
+    for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+        uint32_t msg[2] = {(uint32_t)p->id, i};
+        if (dcf_shm_transport_send(shm, (const uint8_t*)msg, sizeof(msg), "127.0.0.1:50081") != DCF_SUCCESS) p->failures++;
+    }
+    dcf_shm_transport_free(shm);
+    return NULL;
+}
+
+// Producers racing on one ring: nothing lost, each producer's messages in order
+static int test_mpsc(void) {
+    DCFShmTransport* shm = dcf_shm_transport_new();
+    if (!shm || dcf_shm_transport_initialize(shm, SHM_PORT_A) != DCF_SUCCESS) return 1;
+    pthread_t threads[PRODUCERS];
+    Producer producers[PRODUCERS];
+    uint32_t next[PRODUCERS] = {0};
+    for (int i = 0; i < PRODUCERS; i++) {
+        producers[i].id = i;
+        producers[i].failures = 0;
+        pthread_create(&threads[i], NULL, produce, &producers[i]);
+    }
+    int failures = 0;
+    double start = now_us();
+    for (int n = 0; n < PRODUCERS * PER_PRODUCER; n++) {
+        const uint8_t* data;
+        size_t len;
+        if (dcf_shm_transport_receive(shm, 1000, &data, &len) != DCF_SUCCESS || len != 2 * sizeof(uint32_t)) {
+            failures++;
+            break;
+        }
+        uint32_t msg[2];
+        memcpy(msg, data, sizeof(msg));
+        if (msg[0] >= PRODUCERS || msg[1] != next[msg[0]]++) failures++;
+    }
+    double elapsed = now_us() - start;
+    for (int i = 0; i < PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += producers[i].failures;
+    }
+    printf("shm MPSC: %d msgs from %d producers in %.1f ms\n", PRODUCERS * PER_PRODUCER, PRODUCERS, elapsed / 1000);
+    dcf_shm_transport_free(shm);
+    return failures;
+}
+
+static int ping_pong(int own_port, const char* peer, bool initiator) {
+    DCFShmTransport* shm = dcf_shm_transport_new();
+    if (!shm || dcf_shm_transport_initialize(shm, own_port) != DCF_SUCCESS) return 1;
+    while (!dcf_shm_transport_reaches(shm, peer)) usleep(1000);
+    uint8_t msg[64] = {0};
+    const uint8_t* data;
+    size_t len;
+    int failures = 0;
+    double start = now_us();
+    for (int i = 0; i < LATENCY_ROUNDS && !failures; i++) {
+        if (initiator && dcf_shm_transport_send(shm, msg, sizeof(msg), peer) != DCF_SUCCESS) failures++;
+        if (dcf_shm_transport_receive(shm, 1000, &data, &len) != DCF_SUCCESS || len != sizeof(msg)) failures++;
+        if (!initiator && dcf_shm_transport_send(shm, data, len, peer) != DCF_SUCCESS) failures++;
+    }
+    if (initiator) printf("shm round trip: %.2f us avg over %d rounds\n", (now_us() - start) / LATENCY_ROUNDS, LATENCY_ROUNDS);
+    // Keep the ring mapped until the initiator is done with it
+    if (!initiator) usleep(100000);
+    dcf_shm_transport_free(shm);
+    return failures;
+}
+
+// Round trips between two processes, each owning one ring
+static int test_latency(void) {
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) exit(ping_pong(SHM_PORT_B, "127.0.0.1:50081", false));
+    int failures = ping_pong(SHM_PORT_A, "127.0.0.1:50082", true);
+    int status;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+    return failures;
+}
+
+int main() {
+    int failures = test_basic();
+    failures += test_mpsc();
+    failures += test_latency();
+    if (failures) {
+        printf("shm transport tests failed: %d\n", failures);
+        return 1;
+    }
+    printf("All shm transport tests passed\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "dcf_udp_transport.h"
+#include "dcf_networking.h"
+#include "dcf_client.h"
+#include "dcf_serialization.h"
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define UDP_PORT_A 50071
+#define UDP_PORT_B 50072
+#define GRPC_PORT 50073
+#define THROUGHPUT_MESSAGES 200000
+#define LATENCY_ROUNDS 10000
+#define GRPC_ROUNDS 2000
+#define RECEIVE_TIMEOUT_MS 1000
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Receives one datagram, giving up with DCF_ERR_TIMEOUT after RECEIVE_TIMEOUT_MS
+static DCFError receive_within(DCFUdpTransport* udp, const uint8_t** data_out, size_t* len_out) {
+    DCFError err = dcf_udp_transport_try_receive(udp, data_out, len_out);
+    if (err != DCF_ERR_TIMEOUT) return err;
+    struct pollfd pfd = { .fd = dcf_udp_transport_get_fd(udp), .events = POLLIN };
+    if (poll(&pfd, 1, RECEIVE_TIMEOUT_MS) <= 0) return DCF_ERR_TIMEOUT;
+    return dcf_udp_transport_try_receive(udp, data_out, len_out);
+}
+
+static DCFConfig* write_config(const char* path, const char* transport, const char* mode, int port) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return NULL;
+    fprintf(fp, "{\"transport\": \"%s\", \"host\": \"127.0.0.1\", \"port\": %d, \"mode\": \"%s\", \"node_id\": \"bench\", \"peers\": [], \"shared_memory\": false}", transport, port, mode);
+    fclose(fp);
+    return dcf_config_load(path);
+}
+
+static int test_udp(const uint8_t* msg, size_t msg_len) {
+    DCFUdpTransport* a = dcf_udp_transport_new();
+    DCFUdpTransport* b = dcf_udp_transport_new();
+    if (!a || !b || dcf_udp_transport_initialize(a, "127.0.0.1", UDP_PORT_A, 4 << 20, 4 << 20) != DCF_SUCCESS ||
+        dcf_udp_transport_initialize(b, "127.0.0.1", UDP_PORT_B, 4 << 20, 4 << 20) != DCF_SUCCESS) {
+        printf("UDP transport init failed\n");
+        dcf_udp_transport_free(a);
+        dcf_udp_transport_free(b);
+        return 1;
+    }
+    char addr_a[32], addr_b[32];
+    snprintf(addr_a, sizeof(addr_a), "127.0.0.1:%d", UDP_PORT_A);
+    snprintf(addr_b, sizeof(addr_b), "127.0.0.1:%d", UDP_PORT_B);
+    const uint8_t* batch[DCF_UDP_BATCH];
+    size_t lens[DCF_UDP_BATCH];
+    for (size_t i = 0; i < DCF_UDP_BATCH; i++) {
+        batch[i] = msg;
+        lens[i] = msg_len;
+    }
+    // Throughput: one sendmmsg of a full batch, then drain it on the other side
+    double start = now_us();
+    size_t received = 0;
+    bool drained = true;
+    for (size_t sent_total = 0; drained && sent_total < THROUGHPUT_MESSAGES; sent_total += DCF_UDP_BATCH) {
+        size_t sent;
+        if (dcf_udp_transport_send_batch(a, batch, lens, DCF_UDP_BATCH, addr_b, NULL, &sent) != DCF_SUCCESS) break;
+        for (size_t i = 0; i < sent; i++) {
+            const uint8_t* data;
+            size_t len;
+            // A dropped datagram must not stall the run, so each receive is bounded
+            if (receive_within(b, &data, &len) != DCF_SUCCESS || len != msg_len) {
+                drained = false;
+                break;
+            }
+            received++;
+        }
+    }
+    double elapsed = now_us() - start;
+    printf("UDP throughput: %zu msgs in %.1f ms (%.0f msgs/s)\n", received, elapsed / 1000, received / (elapsed / 1e6));
+    // Latency: ping-pong of single datagrams
+    int failures = 0;
+    int rounds = 0;
+    start = now_us();
+    for (; rounds < LATENCY_ROUNDS; rounds++) {
+        const uint8_t* data;
+        size_t len;
+        if (dcf_udp_transport_send(a, msg, msg_len, addr_b) != DCF_SUCCESS ||
+            receive_within(b, &data, &len) != DCF_SUCCESS ||
+            dcf_udp_transport_send(b, data, len, addr_a) != DCF_SUCCESS ||
+            receive_within(a, &data, &len) != DCF_SUCCESS ||
+            len != msg_len || memcmp(data, msg, len) != 0) {
+            failures++;
+            break;
+        }
+    }
+    elapsed = now_us() - start;
+    if (rounds > 0) printf("UDP round trip: %.2f us avg over %d rounds\n", elapsed / rounds, rounds);
+    dcf_udp_transport_free(a);
+    dcf_udp_transport_free(b);
+    return failures;
+}
+
+static void test_grpc(const uint8_t* msg, size_t msg_len) {
+    DCFConfig* server_config = write_config("test_udp_server.json", "gRPC", "server", GRPC_PORT);
+    DCFConfig* client_config = write_config("test_udp_client.json", "gRPC", "client", GRPC_PORT);
+    DCFNetworking* server = dcf_networking_new();
+    DCFNetworking* client = dcf_networking_new();
+    if (!server_config || !client_config || !server || !client ||
+        dcf_networking_initialize(server, server_config) != DCF_SUCCESS ||
+        dcf_networking_initialize(client, client_config) != DCF_SUCCESS ||
+        dcf_networking_start(server, SERVER_MODE) != DCF_SUCCESS) {
+        printf("gRPC comparison skipped: server could not start\n");
+    } else {
+        char addr[32];
+        snprintf(addr, sizeof(addr), "127.0.0.1:%d", GRPC_PORT);
+        int rounds = 0;
+        double start = now_us();
+        for (; rounds < GRPC_ROUNDS; rounds++) {
+            if (dcf_networking_send(client, msg, msg_len, addr) != DCF_SUCCESS) break;
+        }
+        double elapsed = now_us() - start;
+        if (rounds > 0) printf("gRPC round trip: %.2f us avg over %d rounds\n", elapsed / rounds, rounds);
+        else printf("gRPC comparison skipped: send failed\n");
+        dcf_networking_stop(server);
+    }
+    dcf_networking_free(client);
+    dcf_networking_free(server);
+    dcf_config_free(client_config);
+    dcf_config_free(server_config);
+    remove("test_udp_server.json");
+    remove("test_udp_client.json");
+}
+
+int main() {
+    char payload[256];
+    memset(payload, 'x', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+    uint8_t* msg;
+    size_t msg_len;
+    if (dcf_serialize_message(payload, "node-a", "node-b", &msg, &msg_len) != DCF_SUCCESS) {
+        printf("Serialization failed\n");
+        return 1;
+    }
+    if (test_udp(msg, msg_len) != 0) {
+        printf("UDP loopback failed\n");
+        free(msg);
+        return 1;
+    }
+    test_grpc(msg, msg_len);
+    free(msg);
+    printf("UDP transport tests passed\n");
+    return 0;
+}